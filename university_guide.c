@@ -2,6 +2,33 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <setjmp.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#include <direct.h>
+#define fseek64 _fseeki64
+#define ftell64 _ftelli64
+#else
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/ioctl.h>
+#define fseek64 fseeko
+#define ftell64 ftello
+#endif
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
 
 // --- CONSTANTS AND MACROS ---
 #define MAX_NAME_LENGTH 100
@@ -9,6 +36,28 @@
 #define MAX_ID_LENGTH 15
 #define HASH_SIZE 50
 #define MAX_RECORDS 100
+#define MAX_NOTICES 500
+#define MAX_CATEGORY_LENGTH 20
+#define SEMESTERS_PER_YEAR 2 // Terms YYYY-1 and YYYY-2
+#define DB_DIRECTORY "db"
+#define WATCH_POLL_INTERVAL_MS 1000
+#define VERSION_HEADER_PREFIX "#version="
+#define VERSION_HEADER_FORMAT "#version=%010d\n" // Fixed width so append-only files can bump it in place
+#define MAX_DIRTY_KEYS 32
+#define MAX_SAVE_ATTEMPTS 5
+#define INDEX_RANGE_PAGE_LIMIT 50
+#define MAX_TABLE_COLUMNS 8
+#define SLAB_OBJECTS_PER_SLAB 64
+#define SLAB_HEADER_SIZE 16 // Keeps objects after the slab header suitably aligned
+#define GRID_BUCKETS 1024
+#define GRID_CELL_METERS 25.0
+#define LEVEL_HEIGHT_METERS 4.0 // Distance one floor adds to a nearest-location search
+#define MAX_NEAREST 20
+#define PERSIST_COALESCE_MS 150 // Saves of one table within this window reach the disk as one write
+#define EPOCH_READER_SLOTS 64 // Threads that can hold table snapshots at the same time
+#define BLOOM_BITS_PER_KEY 10 // With BLOOM_HASHES probes: about 1% false positives at capacity
+#define BLOOM_HASHES 7
+#define VIEW_CACHE_SLOTS 4 // Output formats (terminal width, role, date) kept per cached page
 
 // --- GLOBAL ROLE DEFINITION ---
 typedef enum {
@@ -17,15 +66,33 @@ typedef enum {
     ROLE_ADMIN
 } UserRole;
 
+// --- PERSISTED TABLES ---
+typedef enum {
+    TABLE_STUDENTS,
+    TABLE_COURSES,
+    TABLE_FACULTY,
+    TABLE_LOCATIONS,
+    TABLE_NOTICES,
+    TABLE_PROGRAMS,   // Added last: archive segments store table numbers
+    TABLE_COUNT
+} TableID;
+
 // --- DATA STRUCTURES (Struct Definitions) ---
 
 // 1. Hash Table Node for Location Guide (using Linked List for Separate Chaining)
+typedef struct LocationPosition {
+    double x, y;                     // Campus coordinates in metres
+    int level;                       // Floor number (Ground = 0)
+} LocationPosition;
+
 typedef struct LocationNode {
     char key[MAX_ID_LENGTH];         // e.g., "c_lab" (for fast search)
     char building[MAX_NAME_LENGTH];
     char floor[MAX_ID_LENGTH];
     char room[MAX_ID_LENGTH];
     char description[MAX_NAME_LENGTH];
+    LocationPosition position;
+    int hasPosition;                 // Coordinates are optional
     struct LocationNode *next;
 } LocationNode;
 
@@ -35,49 +102,421 @@ typedef struct HistoryNode {
     struct HistoryNode *next;
 } HistoryNode;
 
-// 3. Student Record
-typedef struct Student {
-    char id[MAX_ID_LENGTH];
-    char name[MAX_NAME_LENGTH];
-    char program[MAX_NAME_LENGTH];
-    char email[MAX_NAME_LENGTH];
-} Student;
-
-// 4. Course Record
-typedef struct Course {
-    char code[MAX_ID_LENGTH];
-    char name[MAX_NAME_LENGTH];
-    int credits;
-} Course;
-
-// 5. Faculty Record
-typedef struct Faculty {
+// 3. Records of the array tables, generated from their field lists (see RECORD TABLE ENGINE).
+// X(ctx, kind, member, size, name, header, prompt): 'kind' picks the typed
+// parse, format and input routines (String, Int, or the optional Semester,
+// CourseList, OptionalInt and Gpa; a course list holds ';'-separated course codes,
+// a blank OptionalInt reads as 0 and a Gpa is kept in hundredths, GPA_NONE (-1)
+// meaning none recorded), 'name' is the column in queries, 'header' the listing column and
+// 'prompt' what "add" asks for. 'ctx' is passed through from the expansion
+// site (the record type). The first field is the key; the order is the .dat order.
+#define STUDENT_FIELDS(X, ctx) \
+    X(ctx, String,   id,       MAX_ID_LENGTH,   "id",       "Student ID", "Enter new Student ID: ") \
+    X(ctx, String,   name,     MAX_NAME_LENGTH, "name",     "Name",       "Enter Student Name: ") \
+    X(ctx, String,   program,  MAX_NAME_LENGTH, "program",  "Program",    "Enter Student Program: ") \
+    X(ctx, String,   email,    MAX_NAME_LENGTH, "email",    "Email",      "Enter Student Email: ") \
+    X(ctx, Semester, semester, MAX_ID_LENGTH,   "semester", "Semester",   "Enter Admission Semester (YYYY-T, blank if unknown): ") \
+    X(ctx, CourseList, completed, MAX_NAME_LENGTH, "completed", "Completed", "Enter Completed Course Codes (blank for none): ") \
+    X(ctx, Gpa,      gpa,      0,               "gpa",      "GPA",        "Enter Cumulative GPA out of 10 (e.g., 8.75; blank if none yet): ")
+
+#define COURSE_FIELDS(X, ctx) \
+    X(ctx, String,   code,     MAX_ID_LENGTH,   "code",     "Code",        "Enter Course Code (e.g., CS101): ") \
+    X(ctx, String,   name,     MAX_NAME_LENGTH, "name",     "Course Name", "Enter Course Name: ") \
+    X(ctx, Int,      credits,  0,               "credits",  "Credits",     "Enter Course Credits (e.g., 3): ") \
+    X(ctx, Semester, semester, MAX_ID_LENGTH,   "semester", "Semester",    "Enter Semester Offered (YYYY-T, blank if ongoing): ") \
+    X(ctx, CourseList, prerequisites, MAX_NAME_LENGTH, "prerequisites", "Prerequisites", "Enter Prerequisite Course Codes (blank for none): ") \
+    X(ctx, CourseList, corequisites,  MAX_NAME_LENGTH, "corequisites",  "Corequisites",  "Enter Corequisite Course Codes (blank for none): ") \
+    X(ctx, OptionalInt, capacity,     0,               "capacity",      "Seats",         "Enter Seat Capacity (0 for unlimited): ")
+
+#define FACULTY_FIELDS(X, ctx) \
+    X(ctx, String,   id,         MAX_ID_LENGTH,   "id",         "Faculty ID", "Enter new Faculty ID (e.g., F009): ") \
+    X(ctx, String,   name,       MAX_NAME_LENGTH, "name",       "Name",       "Enter Faculty Name: ") \
+    X(ctx, String,   department, MAX_NAME_LENGTH, "department", "Department", "Enter Faculty Department: ")
+
+// Degree requirements, keyed by the 'program' of student records
+#define PROGRAM_FIELDS(X, ctx) \
+    X(ctx, String,     name,      MAX_NAME_LENGTH, "name",      "Program Name",     "Enter Program Name (as on student records): ") \
+    X(ctx, Int,        semesters, 0,               "semesters", "Semesters",        "Enter Program Length in Semesters (e.g., 8): ") \
+    X(ctx, Int,        credits,   0,               "credits",   "Min Credits",      "Enter Minimum Credits to Graduate: ") \
+    X(ctx, CourseList, required,  MAX_NAME_LENGTH, "required",  "Required Courses", "Enter Required Course Codes (blank for none): ") \
+    X(ctx, CourseList, electives, MAX_NAME_LENGTH, "electives", "Elective Pool",    "Enter Elective Pool Course Codes (blank for none): ") \
+    X(ctx, Int,        picks,     0,               "picks",     "Electives Needed", "Enter Number of Electives Required from the Pool (0 if none): ")
+
+// Every array table: X(Type, prefix, rows, table, FIELDS, view, onAdd).
+// 'view' is the cached page built from the table (-1 for none) and 'onAdd'
+// runs after a record is added (NULL for nothing).
+#define RECORD_TABLES(X) \
+    X(Student, student, students, TABLE_STUDENTS, STUDENT_FIELDS, -1,                     createStudentLogin) \
+    X(Course,  course,  courses,  TABLE_COURSES,  COURSE_FIELDS,  VIEW_COURSE_CATALOG,    NULL) \
+    X(Faculty, faculty, faculty,  TABLE_FACULTY,  FACULTY_FIELDS, VIEW_FACULTY_DIRECTORY, NULL) \
+    X(Program, program, programs, TABLE_PROGRAMS, PROGRAM_FIELDS, -1,                     NULL)
+
+#define FIELD_CTYPE_String(member, size) char member[size];
+#define FIELD_CTYPE_Semester(member, size) char member[size];
+#define FIELD_CTYPE_CourseList(member, size) char member[size];
+#define FIELD_CTYPE_Int(member, size) int member;
+#define FIELD_CTYPE_OptionalInt(member, size) int member;
+#define FIELD_CTYPE_Gpa(member, size) int member;
+#define DECLARE_RECORD_FIELD(ctx, kind, member, size, name, header, prompt) FIELD_CTYPE_##kind(member, size)
+#define DECLARE_RECORD_STRUCT(Type, prefix, rows, table, FIELDS, view, onAdd) \
+    typedef struct Type { FIELDS(DECLARE_RECORD_FIELD, Type) } Type;
+RECORD_TABLES(DECLARE_RECORD_STRUCT)
+
+// Room for one record of any array table
+#define DECLARE_RECORD_MEMBER(Type, prefix, rows, table, FIELDS, view, onAdd) Type prefix;
+typedef union AnyRecord {
+    RECORD_TABLES(DECLARE_RECORD_MEMBER)
+} AnyRecord;
+
+// 4. Field descriptor shared by listings, the record editor and queries
+typedef enum { FIELD_STRING, FIELD_INT, FIELD_SEMESTER, FIELD_COURSE_LIST, FIELD_GPA } FieldType;
+
+typedef struct RecordField {
+    const char *name;
+    FieldType type;
+    size_t offset;
+    size_t size;                 // Buffer size of string fields
+    const char *header;
+    const char *prompt;
+} RecordField;
+
+// 5. Notice (Academic Calendar entry)
+typedef enum {
+    AUDIENCE_ALL,
+    AUDIENCE_STUDENT,
+    AUDIENCE_ADMIN
+} NoticeAudience;
+
+typedef struct Notice {
+    int id;
+    int publishDate;                   // YYYYMMDD, first day the notice is shown
+    int expiryDate;                    // YYYYMMDD, last day the notice is shown (exam date for exams)
+    NoticeAudience audience;
+    char category[MAX_CATEGORY_LENGTH]; // e.g., "general", "exam", "holiday"
+    char text[MAX_LINE_LENGTH];
+} Notice;
+
+// 6. Keys of records edited locally since a table was last written
+typedef struct DirtySet {
+    int count;
+    int overflow; // Too many edits to track individually; the next save overwrites
+    char keys[MAX_DIRTY_KEYS][MAX_ID_LENGTH];
+} DirtySet;
+
+// 7. Growable text buffer (used to pre-render and cache whole pages)
+typedef struct TextBuffer {
+    char *data;
+    size_t length;
+    size_t capacity;
+} TextBuffer;
+
+// 8. Table collected row by row and rendered once, so columns fit their widest cell
+typedef struct TableView {
+    int columns;
+    const char *headers[MAX_TABLE_COLUMNS];
+    int rightAligned[MAX_TABLE_COLUMNS];
+    int rows;
+    int capacity;       // Rows that 'cellOffsets' has room for
+    size_t *cellOffsets;
+    TextBuffer cells;
+} TableView;
+
+// 9. Fixed-size object pool backed by slabs (see SLAB ALLOCATOR)
+typedef struct Slab {
+    struct Slab *next; // Objects start SLAB_HEADER_SIZE bytes into the slab
+} Slab;
+
+typedef struct SlabPool {
+    const char *name;
+    size_t objectSize;
+    size_t objectsPerSlab;
+    Slab *first;        // Slabs in allocation order
+    Slab *last;
+    Slab *current;      // Slab new objects are carved from (NULL: start at 'first')
+    size_t currentUsed;
+    void *freeList;     // Released objects, linked through their first word
+    size_t freeListLength;
+    size_t slabCount, liveObjects, peakObjects, allocations, frees, reuses, resets;
+} SlabPool;
+
+#define SLAB_POOL_INIT(type) { #type, sizeof(type), SLAB_OBJECTS_PER_SLAB, NULL, NULL, NULL, 0, NULL, 0, 0, 0, 0, 0, 0, 0, 0 }
+
+// 10. Uniform grid over positioned locations (see SPATIAL GRID INDEX)
+typedef struct GridEntry {
+    int cellX, cellY;
+    LocationNode *node;
+} GridEntry;
+
+typedef struct GridBucket {
+    int count;
+    int capacity;
+    GridEntry *entries;
+} GridBucket;
+
+typedef struct SpatialGrid {
+    GridBucket buckets[GRID_BUCKETS]; // Cells hashed by (cellX, cellY)
+    int points;
+    int minCellX, maxCellX, minCellY, maxCellY;
+} SpatialGrid;
+
+typedef struct NearestHit {
+    LocationNode *node;
+    double distance;                 // Metres
+} NearestHit;
+
+// 11. Location hash table together with the pool its nodes come from
+typedef struct LocationTable {
+    LocationNode *buckets[HASH_SIZE];
+    SlabPool nodes;
+    SpatialGrid grid;
+} LocationTable;
+
+// 12. Page body pre-rendered for one output format (see RENDERED VIEW CACHE)
+typedef enum {
+    VIEW_COURSE_CATALOG,
+    VIEW_FACULTY_DIRECTORY,
+    VIEW_NOTICE_BOARD,
+    VIEW_COUNT
+} ViewID;
+
+typedef void (*ViewBuilder)(TextBuffer *out, int width, int variant);
+
+typedef struct CachedView {
+    TextBuffer text;
+    int valid;
+    int width;                // Terminal columns the tables were fitted to (0 = unbounded)
+    int variant;              // Per-page variation, e.g. the viewer's role
+    int stamp;                // Freshness token from the caller, e.g. today's date
+    unsigned long lastUsed;
+} CachedView;
+
+// 13. Write-behind state of one table (see WRITE-BEHIND PERSISTENCE)
+typedef enum {
+    DURABILITY_NONE,          // Leave flushing to the operating system
+    DURABILITY_BARRIER,       // fsync the tables written so far at the flush barrier (exit)
+    DURABILITY_ALWAYS         // fsync every table write before it counts as done
+} DurabilityPolicy;
+
+typedef struct PersistJob {
+    TextBuffer body;          // Newest snapshot not yet taken by the writer
+    int pending;              // 'body' is waiting to be written
+    int writing;              // The writer thread is writing a snapshot right now
+    int conflict;             // The file was newer than 'baseVersion'; the main thread must merge
+    int failed;               // The file could not be opened
+    int versionOwned;         // 'baseVersion' runs ahead of tableVersions until results are applied
+    int baseVersion;          // Version the next snapshot expects to find on disk
+    int conflictStreak;       // Merges in a row without a successful write
+    unsigned long queued;     // Snapshots handed over so far
+    unsigned long written;    // Newest snapshot known to be on disk
+    double dueAt;             // When the pending snapshot is written unless a barrier comes first
+} PersistJob;
+
+// 14. Immutable published copy of a table (see TABLE SNAPSHOTS)
+typedef struct TableSnapshot {
+    TableID table;
+    int count;                   // Rows, or locations for TABLE_LOCATIONS
+    unsigned long generation;    // Grows with every publish of any table
+    const void *rows;            // Student, Course or Faculty array
+    LocationTable *locations;    // TABLE_LOCATIONS only
+} TableSnapshot;
+
+// 15. Bloom filter over the keys of one table (see KEY FILTERS)
+typedef struct BloomFilter {
+    uint64_t *bits;
+    uint32_t bitCount;
+    int keys;                    // Keys added since the last rebuild
+    int capacity;                // Keys the bit array was sized for
+} BloomFilter;
+
+// 16. Everything the generic table engine needs to know about one array table
+typedef struct RecordSchema {
+    TableID table;
+    const char *rowsName;        // "students": the query name and the index file stem
+    size_t rowSize;
+    void *rows;
+    int *count;
+    const RecordField *fields;
+    int fieldCount;              // Field 0 is the key
+    int view;                    // ViewID built from the table, or -1
+    void (*onAdd)(const void *row);
+    // Generated per table, so loops over rows never branch on field types
+    int (*parseLine)(char *line, void *out);
+    int (*parseFile)(const char *path, void *dst, int max, int *version);
+    void (*serialize)(const void *rows, int count, TextBuffer *tb);
+} RecordSchema;
+
+// 17. Number of records per value of one field (see STATISTICS DASHBOARD)
+typedef struct HistogramBucket {
+    char value[MAX_NAME_LENGTH];
+    int count;                   // Stays in place at 0 when the last record goes
+} HistogramBucket;
+
+typedef struct Histogram {
+    HistogramBucket *buckets;    // Open addressing; capacity is a power of two
+    int capacity;
+    int used;                    // Distinct values held, including those at 0
+    int total;                   // Records counted
+} Histogram;
+
+// 18. Set of courses, one bit per row of courses[] (see PREREQUISITE GRAPH)
+#define COURSE_SET_WORDS ((MAX_RECORDS + 63) / 64)
+typedef struct CourseSet {
+    uint64_t bits[COURSE_SET_WORDS];
+} CourseSet;
+
+// 19. Outcome of checking one student against their program (see DEGREE AUDIT)
+typedef enum {
+    AUDIT_COMPLETE,
+    AUDIT_ON_TRACK,
+    AUDIT_AT_RISK,
+    AUDIT_NO_PROGRAM,            // No requirements are defined for the student's program
+    AUDIT_STATUS_COUNT
+} AuditStatus;
+
+typedef struct AuditResult {
+    AuditStatus status;
+    int credits;                 // Earned from completed catalog courses
+    int expectedCredits;         // What the program's pace calls for by now
+    int missingRequired;         // Required courses not completed
+    int electivesShort;          // Pool courses still to pick
+} AuditResult;
+
+// 20. Outcome of a registration request (see COURSE REGISTRATION)
+typedef enum {
+    REG_ENROLLED,
+    REG_WAITLISTED,
+    REG_ALREADY,                 // Already holds a seat or a waitlist place in that course
+    REG_DROPPED,
+    REG_NOT_REGISTERED,          // Nothing to drop
+    REG_UNKNOWN_COURSE,
+    REG_FAILED                   // Out of memory
+} RegistrationResult;
+
+// 21. Occupancy samples and rolling aggregates per location (see OCCUPANCY TIME SERIES)
+typedef enum {
+    OCCUPANCY_CHECK_IN,
+    OCCUPANCY_CHECK_OUT,
+    OCCUPANCY_HEADCOUNT          // A counted level that replaces the running one
+} OccupancySample;
+
+typedef struct OccupancySummary {
+    int current;
+    double hourAverage;          // Mean of the last hour's five-minute levels
+    int peak;                    // Highest level in the last 24 hours
+    time_t peakAt;               // Start of the (latest) bucket that reached it
+    int checkInsLastHour;
+} OccupancySummary;
+
+// 22. One admin edit in the change log, and a query over it (see CHANGE LOG)
+typedef enum {
+    CHANGE_ADD,
+    CHANGE_UPDATE,
+    CHANGE_DELETE,
+    CHANGE_ARCHIVE,              // Moved into a semester archive segment
+    CHANGE_ACTION_COUNT
+} ChangeAction;
+
+typedef struct ChangeRecord {    // Written to the log as is
+    int64_t at;                  // Seconds since the epoch
+    uint8_t table;               // TableID
+    uint8_t action;              // ChangeAction
+    char actor[MAX_ID_LENGTH];   // Logged-in user, or "(system)" for command-line runs
+    char key[MAX_ID_LENGTH];     // Record key, Task Key or notice number
+} ChangeRecord;
+
+typedef struct ChangeFilter {    // Empty strings, -1 and 0 match anything
+    char actor[MAX_ID_LENGTH];
+    int table;
+    char key[MAX_ID_LENGTH];
+    int64_t from, to;            // Inclusive bounds in seconds since the epoch
+} ChangeFilter;
+
+// 23. A student's standing in their program, and one line of an honours list (see CLASS RANK)
+typedef struct ClassRank {
+    int rank;                    // 1 is the best GPA; equal GPAs share a rank
+    int cohort;                  // Students of the program with a GPA recorded
+    double percentile;           // Share of the cohort with a lower GPA
+} ClassRank;
+
+typedef struct HonoursEntry {
+    int gpa;                     // Hundredths (see GPA_SCALE)
     char id[MAX_ID_LENGTH];
-    char name[MAX_NAME_LENGTH];
-    char department[MAX_NAME_LENGTH];
-} Faculty;
+} HonoursEntry;
 
 
 // --- GLOBAL VARIABLES ---
-LocationNode *hashTable[HASH_SIZE]; // The Hash Table array
+// Every data file lives in dataDirectory: db/ itself, or one campus's shard
+// (see CAMPUS SHARDS). The paths are filled in once at startup.
+static const char *tableFileNames[TABLE_COUNT] = {
+    "students.dat",
+    "courses.dat",
+    "faculty.dat",
+    "university_data.txt",
+    "notices.dat",
+    "programs.dat"
+};
+char dataDirectory[MAX_NAME_LENGTH] = DB_DIRECTORY;
+char campusName[MAX_ID_LENGTH] = "";     // Empty when working on db/ itself
+char tableFiles[TABLE_COUNT][MAX_LINE_LENGTH];
+char usersFile[MAX_LINE_LENGTH];
+char shipDirectory[MAX_LINE_LENGTH] = ""; // Set by --ship: this instance is a replication primary
+const char *tableNames[TABLE_COUNT] = { "Student", "Course", "Faculty", "Location", "Notice", "Program" };
+LocationTable hashTable = { {NULL}, SLAB_POOL_INIT(LocationNode), {{{0, 0, NULL}}, 0, 0, 0, 0, 0} }; // The Hash Table array
 HistoryNode *historyStack = NULL;  // The top of the history stack
 char loggedInUserID[MAX_ID_LENGTH] = ""; // ID of the currently logged-in user
 UserRole currentUserRole = ROLE_UNKNOWN; // Role of the currently logged-in user
 
-// Arrays to hold records (Simulating data store for Admin/Student modules)
-Student students[MAX_RECORDS];
-int studentCount = 0;
-Course courses[MAX_RECORDS];
-int courseCount = 0;
-Faculty faculty[MAX_RECORDS];
-int facultyCount = 0;
+// Arrays to hold records (Simulating data store for Admin/Student modules):
+// students[] with studentCount, courses[] with courseCount, faculty[] with facultyCount,
+// programs[] with programCount
+#define DECLARE_RECORD_ARRAY(Type, prefix, rows, table, FIELDS, view, onAdd) \
+    Type rows[MAX_RECORDS];                                                 \
+    int prefix##Count = 0;
+RECORD_TABLES(DECLARE_RECORD_ARRAY)
+
+// Academic calendar: notices plus two date-ordered indexes into the array
+Notice notices[MAX_NOTICES];
+int noticeCount = 0;
+int nextNoticeID = 1;
+int noticesByPublish[MAX_NOTICES]; // Indices into notices[], ascending publishDate
+int noticesByExpiry[MAX_NOTICES];  // Indices into notices[], ascending expiryDate
 
 // --- FUNCTION PROTOTYPES ---
+void initRenderer();
+void flushFrame();
+int terminalColumns();
 void clearScreen();
+void tvInit(TableView *tv, int columns, ...);
+void tvAlignRight(TableView *tv, int column);
+void tvInitColumns(TableView *tv, int columns, const char *const *headers);
+void tvAddRowCells(TableView *tv, const char *const *cells);
+void tvAddRow(TableView *tv, ...);
+void tvRenderText(TableView *tv, TextBuffer *text, int width);
+void tvRender(TableView *tv, FILE *out);
+const char* cachedView(ViewID view, int variant, int stamp, ViewBuilder build);
+void invalidateView(ViewID view);
 void pressEnterToContinue();
 void normalizeString(char *str);
 int getMenuChoice(int maxOption);
+double monotonicMillis();
+int startRecording(const char *path);
+void endInputSession();
+void readInputLine(const char *label, char *dest, size_t size);
+int readIntInput(const char *prompt, int *value);
+int replaySessions(char **paths, int count, double speed);
+void runApplication();
 char* getInput(const char* prompt);
+void tbAppendf(TextBuffer *tb, const char *fmt, ...);
+void tbClear(TextBuffer *tb);
+void tbAppendBytes(TextBuffer *tb, const void *bytes, size_t count);
+int lowerChar(int c);
+int containsIgnoreCase(const char *haystack, const char *needle, size_t needleLength);
+int isValidSemester(const char *str);
+void readSemesterInput(const char *prompt, char *dest);
+int todayDate();
+int addDaysToDate(int date, int days);
+int parseDate(const char *str);
+void formatDate(int date, char *out, size_t size);
 
 // Authentication & Core Menus
 void loginMenu();
@@ -85,22 +524,221 @@ void mainMenu();
 void adminMenu();
 void studentMenu();
 
+// Threading primitives
+void sleepMillis(int ms);
+int processorCount();
+
+// Concurrent access (file locks and version stamps)
+int lockFile(FILE *fp, int exclusive);
+void unlockFile(FILE *fp);
+int isHeaderLine(const char *line, int *version);
+FILE* openTableForRead(const char *path);
+void closeTable(FILE *fp);
+int writeTableFile(TableID table, const char *body, int expectedVersion);
+int appendTableLine(TableID table, const char *line, int expectedVersion);
+void markRecordDirty(TableID table, const char *key);
+int setDurabilityPolicy(const char *name);
+void syncWrittenTables();
+
 // File I/O for records
 void loadAllRecords();
-void saveStudentRecords();
-void saveCourseRecords();
-void saveFacultyRecords();
+void initLazyLoading();
+int isTableLoaded(TableID table);
+void markTableLoaded(TableID table);
+void ensureTableLoaded(TableID table);
+void startBackgroundPrefetch();
+void mergeStaleArrayTable(TableID table);
+
+// Record table engine: parseStudentLine / parseStudentFile / serializeStudents
+// and the Course and Faculty equivalents are generated from the field lists
+#define DECLARE_RECORD_CODEC(Type, prefix, rows, table, FIELDS, view, onAdd)      \
+    int parse##Type##Line(char *line, Type *out);                                 \
+    int parse##Type##File(const char *path, Type *dst, int max, int *version);    \
+    void serialize##Type##s(const Type *rows, int count, TextBuffer *tb);
+RECORD_TABLES(DECLARE_RECORD_CODEC)
+const RecordSchema* recordSchema(TableID table);
+const RecordSchema* recordSchemaNamed(const char *rowsName);
+void saveRecordTable(TableID table);
+void createStudentLogin(const void *row);
+int parseGpa(const char *text, int *out);
+void formatGpa(int gpa, char *out, size_t size);
+
+// Key filters (Bloom)
+void bloomReset(BloomFilter *filter, int expectedKeys);
+void bloomAdd(BloomFilter *filter, const char *key);
+int bloomMayContain(const BloomFilter *filter, const char *key);
+void rebuildKeyFilter(TableID table);
+void keyFilterAdd(TableID table, const char *key);
+int keyMayExist(TableID table, const char *key);
+int loginMayExist(const char *username);
+int benchmarkKeyFilter(int keys);
+
+// Statistics dashboard (incremental counters)
+void rebuildTableStats(TableID table);
+void statsRowChanged(TableID table, const void *row, int delta);
+void writeStatsJson(FILE *out);
+
+// Prerequisite graph (bitset closure)
+void rebuildRequisiteGraph(TableID table);
+void requisiteRowChanged(TableID table, int course);
+int normalizeCourseList(TableID table, const void *row, const char *input, char *list, size_t size, char *problem, size_t problemSize);
+void courseListSet(const char *list, CourseSet *out);
+int missingRequisites(const CourseSet *completed, int course, CourseSet *missing);
+int pendingCorequisites(const CourseSet *completed, int course, CourseSet *pending);
+int coursesUnlocked(const CourseSet *before, const CourseSet *after, CourseSet *unlocked);
+void formatCourseSet(const CourseSet *set, char *out, size_t size);
+
+// Degree audit (parallel batch)
+void auditStudent(const Student *student, AuditResult *result, CourseSet *missingRequired, CourseSet *electivesTaken);
+int auditStudents(const Student *rows, int count, AuditResult *results);
+Student* readStudentBody(int *count);
+void writeAuditCsv(FILE *out, const Student *rows, const AuditResult *results, int count);
+int benchmarkAudit(int rows);
+
+// Class rank (parallel sort and top-N heaps)
+void resetClassRanks();
+void rankRowChanged(const Student *student, int delta);
+int classRankOf(const Student *student, ClassRank *out);
+int honoursList(const char *program, HonoursEntry *out, int max);
+int rankedPrograms(const char **names, int max);
+int rankStudents(const Student *rows, int count, ClassRank *ranks);
+void writeRankCsv(FILE *out, const Student *rows, const ClassRank *ranks, int count);
+int benchmarkRanking(int rows);
+
+// Course registration (atomic seats and waitlists)
+void loadRegistrations();
+void syncCourseSeats(TableID table);
+RegistrationResult registerForCourse(const char *student, const char *code);
+RegistrationResult dropCourse(const char *student, const char *code);
+int registrationState(const char *student, const char *code, int *position);
+void seatCounts(const char *code, int *taken, int *capacity, int *waiting);
+FILE* beginRegistrationChange();
+void flushRegistrationJournal(FILE *lock);
+int stressRegistration(int requests, int threads);
+
+// Academic Calendar (date-indexed notices)
+void loadNotices();
+int parseNoticeFile(const char *path, Notice *dst, int max, int *nextID, int *version);
+void rebuildNoticeIndexes();
+int appendNoticeToFile(Notice *n);
+int appendRetractionToFile(int id);
+int findNoticeIndex(int id);
+int lowerBoundByExpiry(int date);
+int upperBoundByPublish(int date);
+int noticeVisibleTo(const Notice *n, UserRole role);
+const char* renderNoticeBoard(UserRole role);
+void invalidateNoticeBoard();
+const char* audienceToString(NoticeAudience audience);
+NoticeAudience audienceFromString(const char *str);
 
 // Location Hash Table Management
 void loadLocationData();
 int hashFunction(const char *key);
-void insertLocation(const char *key, const char *building, const char *floor, const char *room, const char *desc);
-void saveLocationToFile(const char *key, const char *building, const char *floor, const char *room, const char *desc);
+void insertLocation(const char *key, const char *building, const char *floor, const char *room, const char *desc, const LocationPosition *position);
+void slabInit(SlabPool *pool, const char *name, size_t objectSize);
+void* slabAlloc(SlabPool *pool);
+void slabFree(SlabPool *pool, void *object);
+void slabReset(SlabPool *pool);
+void slabDestroy(SlabPool *pool);
+void printSlabStats(const SlabPool *pool);
+void initLocationTable(LocationTable *table);
+LocationNode* insertLocationInto(LocationTable *table, const char *key, const char *building, const char *floor, const char *room, const char *desc, const LocationPosition *position);
+int floorLevel(const char *floor);
+int parsePosition(const char *text, const char *floor, LocationPosition *out);
+void formatPositionField(const LocationPosition *position, const char *floor, char *out, size_t size);
+void formatPosition(const LocationNode *node, char *out, size_t size);
+void gridInsert(SpatialGrid *grid, LocationNode *node);
+void gridRemove(SpatialGrid *grid, LocationNode *node);
+void gridClear(SpatialGrid *grid);
+void gridFree(SpatialGrid *grid);
+int gridNearest(SpatialGrid *grid, const LocationPosition *from, const char *filter, int limit, double radius, NearestHit *hits);
+int benchmarkNearest(int points);
+void freeLocationTable(LocationTable *table);
+void destroyLocationTable(LocationTable *table);
+int parseLocationFile(const char *path, LocationTable *table, int *version);
+void rewriteLocationFile();
+
+// Campus shards
+void useDataDirectory(const char *directory);
+void campusDirectory(const char *campus, char *out, size_t size);
+int isValidCampusName(const char *name);
+int loadCampusList(char campuses[][MAX_ID_LENGTH], int max);
+int selectCampus(const char *name);
+int addCampus(const char *name);
+
+// Occupancy time series (ring buffers)
+int recordOccupancy(const char *key, OccupancySample kind, int count, time_t at);
+int occupancySummary(const char *key, time_t at, OccupancySummary *out);
+int occupancyRecent(const char *key, time_t at, int *levels, int count);
+int occupancyKeys(const char **keys, int max);
+int benchmarkOccupancy(int samples);
+
+// Write-behind persistence
+void initPersistence();
+void startPersistenceThread();
+void queueTableWrite(TableID table, TextBuffer *body);
+int applyPersistResults();
+int persistInFlight(TableID table);
+void drainPersistence(int table);
+void flushPersistence();
+
+// Table snapshots (epoch-based reclamation)
+void initSnapshots();
+int epochEnter();
+void epochExit(int slot);
+void epochReclaim();
+void publishTable(TableID table);
+const TableSnapshot* currentSnapshot(TableID table);
+
+// On-disk B+tree record indexes
+int recordIndexable(TableID table);
+int buildRecordIndex(TableID table);
+int readTableFileVersion(TableID table);
+int readRecordLineAt(TableID table, int64_t offset, const char *key, char *line, int size);
+int indexLookupRecord(TableID table, const char *key, void *out);
+
+// Semester archive (compressed segments)
+int writeArchiveSegment(TableID table, void *rows, int count, const char *cutoff);
+int archiveLookup(TableID table, const char *key, void *out);
+int lastArchiveSegment(TableID table);
+int installArchiveSegment(TableID table, const char *source);
+int archiveBeforeSemester(const char *cutoff, int *archivedStudents, int *archivedCourses);
+
+// Change log (binary audit trail of admin edits)
+void logChange(TableID table, ChangeAction action, const char *key);
+void flushChangeLog();
+ChangeRecord* queryChanges(const ChangeFilter *filter, int *count, int *skipped);
+const char* changeActionName(int action);
+int benchmarkChangeLog(int events);
+
+// Replication (mutation log shipping)
+int startShipping(const char *directory);
+void shipMutation(TableID table, ChangeAction action, const char *key);
+void shipArchiveSegment(TableID table, int number);
+void flushShipLog();
+int runReplica(const char *directory, int seconds);
+
+// Filter queries (compiled predicates)
+int benchmarkQuery(const char *text, int rows);
+int runQueryToCsv(const char *text);
+int runCampusQuery(const char *text);
+void writeCsvField(FILE *out, const char *text);
+
+// Hot reload (file watcher)
+void markTableSynced(TableID table);
+void startFileWatcher();
+void applyPendingReloads();
+void stageTablePrefetch(TableID table);
+int adoptPrefetchedTable(TableID table);
+int saveLocationToFile(const char *key, const char *building, const char *floor, const char *room, const char *desc, const LocationPosition *position);
 void locationFunctionalitiesMenu();
 void searchLocation();
 void viewAllLocations();
 void addLocationMenu();
 void deleteLocationMenu();
+void viewAllocatorStats();
+void nearestLocationsMenu();
+void occupancyMenu();
 
 // Student Module Features
 void viewPersonalProfile();
@@ -108,41 +746,44 @@ void viewCourseCatalog();
 void viewFacultyDirectory();
 void viewNotices();
 void gpaCalculator();
+void courseEligibilityPlanner();
+void printAuditReport(const Student *student);
+void viewDegreeAudit();
+void courseRegistration();
 
 // Admin Module Features
-void studentCRUDMenu();
-void courseCRUDMenu();
-void facultyCRUDMenu();
-void displayStudentRecords();
-void displayCourseRecords();
-void displayFacultyRecords();
-void addStudentRecord();
-void deleteStudentRecord();
-void updateStudentRecord();
-void addCourseRecord();
-void deleteCourseRecord();
-void updateCourseRecord();
-void addFacultyRecord();
-void deleteFacultyRecord();
-void updateFacultyRecord();
+void recordCRUDMenu(TableID table);
+void displayRecords(const RecordSchema *schema);
+void addRecord(const RecordSchema *schema);
+void deleteRecord(const RecordSchema *schema);
+void updateRecord(const RecordSchema *schema);
 void editNotices();
+void postNotice();
+void retractNotice();
+void viewFullCalendar();
+void recordIndexMenu();
+void rebuildIndexTool(TableID table);
+void indexLookupTool(TableID table);
+void indexRangeTool(TableID table);
+void archiveMenu();
+void archiveRecordsTool();
+void archiveLookupTool(TableID table);
+void listArchiveSegments();
+void queryRecordsTool();
+void statisticsDashboard();
+void degreeAuditMenu();
+void auditOneStudentTool();
+void auditAllStudentsTool();
+void changeLogTool();
+void classRankingsTool();
 
 // --- CORE UTILITY FUNCTIONS ---
 
-// Clears the console screen for cleaner UI
-void clearScreen() {
-    #ifdef _WIN32
-        system("cls");
-    #else
-        system("clear");
-    #endif
-}
-
 // Pauses execution until user hits enter
 void pressEnterToContinue() {
+    char line[MAX_LINE_LENGTH];
     printf("\n\nPress ENTER to continue...");
-    while (getchar() != '\n'); // Consume remaining newlines if any
-    getchar(); // Wait for a new enter key press
+    readInputLine("continue", line, sizeof(line));
 }
 
 // Cleans input string by removing trailing whitespace/newline
@@ -158,365 +799,7914 @@ void normalizeString(char *str) {
 char* getInput(const char* prompt) {
     static char buffer[MAX_NAME_LENGTH];
     printf("%s", prompt);
-    // Read the line and replace the newline with a null terminator
-    if (fgets(buffer, MAX_NAME_LENGTH, stdin) != NULL) {
-        normalizeString(buffer);
-        return buffer;
-    }
-    return ""; // Return empty string on error
+    readInputLine(prompt, buffer, sizeof(buffer));
+    return buffer;
 }
 
 // Generic menu choice handler
 int getMenuChoice(int maxOption) {
     int choice;
-    printf("\n> Enter your choice (1-%d): ", maxOption);
-    while (scanf("%d", &choice) != 1 || choice < 1 || choice > maxOption) {
-        printf("   Invalid input. Please enter a number between 1 and %d: ", maxOption);
-        // Clear input buffer
-        while (getchar() != '\n');
-    }
-    // Clear input buffer after valid integer read
-    while (getchar() != '\n');
+    char prompt[MAX_LINE_LENGTH];
+    snprintf(prompt, sizeof(prompt), "\n> Enter your choice (1-%d): ", maxOption);
+    while (!readIntInput(prompt, &choice) || choice < 1 || choice > maxOption) {
+        snprintf(prompt, sizeof(prompt), "   Invalid input. Please enter a number between 1 and %d: ", maxOption);
+    }
+    // No action is in flight here, so this is a safe point to adopt finished
+    // writes, to swap in reloaded tables and to write out logged changes
+    applyPersistResults();
+    applyPendingReloads();
+    flushChangeLog();
+    flushShipLog();
     return choice;
 }
 
-// --- FILE I/O AND DATA LOADING ---
+// Appends formatted text to a growable buffer, doubling capacity as needed
+void tbAppendf(TextBuffer *tb, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int needed = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+    if (needed < 0) return;
+
+    if (tb->length + needed + 1 > tb->capacity) {
+        size_t newCapacity = tb->capacity ? tb->capacity : 256;
+        while (tb->length + needed + 1 > newCapacity) newCapacity *= 2;
+        char *grown = (char *)realloc(tb->data, newCapacity);
+        if (grown == NULL) return;
+        tb->data = grown;
+        tb->capacity = newCapacity;
+    }
 
-// Loads records from all data files into memory arrays
-void loadAllRecords() {
-    loadLocationData(); // Loads locations into Hash Table
-    
-    // --- Load Students ---
-    FILE *fp = fopen("db/students.dat", "r");
-    studentCount = 0;
-    if (fp) {
-        char line[MAX_LINE_LENGTH];
-        while (fgets(line, MAX_LINE_LENGTH, fp) && studentCount < MAX_RECORDS) {
-            char *token = strtok(line, ",");
-            if (token) strcpy(students[studentCount].id, token); else continue;
-            token = strtok(NULL, ",");
-            if (token) strcpy(students[studentCount].name, token); else continue;
-            token = strtok(NULL, ",");
-            if (token) strcpy(students[studentCount].program, token); else continue;
-            token = strtok(NULL, ",");
-            if (token) {
-                normalizeString(token);
-                strcpy(students[studentCount].email, token);
-            } else continue;
-            studentCount++;
-        }
-        fclose(fp);
+    va_start(args, fmt);
+    vsnprintf(tb->data + tb->length, tb->capacity - tb->length, fmt, args);
+    va_end(args);
+    tb->length += needed;
+}
+
+// Appends raw bytes (may contain NULs) to the buffer
+void tbAppendBytes(TextBuffer *tb, const void *bytes, size_t count) {
+    if (tb->length + count + 1 > tb->capacity) {
+        size_t newCapacity = tb->capacity ? tb->capacity : 256;
+        while (tb->length + count + 1 > newCapacity) newCapacity *= 2;
+        char *grown = (char *)realloc(tb->data, newCapacity);
+        if (grown == NULL) return;
+        tb->data = grown;
+        tb->capacity = newCapacity;
     }
+    memcpy(tb->data + tb->length, bytes, count);
+    tb->length += count;
+    tb->data[tb->length] = '\0';
+}
 
-    // --- Load Courses ---
-    fp = fopen("db/courses.dat", "r");
-    courseCount = 0;
-    if (fp) {
-        char line[MAX_LINE_LENGTH];
-        while (fgets(line, MAX_LINE_LENGTH, fp) && courseCount < MAX_RECORDS) {
-            char *token = strtok(line, ",");
-            if (token) strcpy(courses[courseCount].code, token); else continue;
-            token = strtok(NULL, ",");
-            if (token) strcpy(courses[courseCount].name, token); else continue;
-            token = strtok(NULL, ",");
-            if (token) {
-                courses[courseCount].credits = atoi(token);
-            } else continue;
-            courseCount++;
-        }
-        fclose(fp);
+// Empties the buffer but keeps its allocation for reuse
+void tbClear(TextBuffer *tb) {
+    tb->length = 0;
+    if (tb->data) tb->data[0] = '\0';
+}
+
+int lowerChar(int c) {
+    return tolower((unsigned char)c);
+}
+
+// Case-insensitive search for an already lowercased needle
+int containsIgnoreCase(const char *haystack, const char *needle, size_t needleLength) {
+    if (needleLength == 0) return 1;
+    for (; *haystack; haystack++) {
+        if (lowerChar(*haystack) != needle[0]) continue;
+        size_t i = 1;
+        while (i < needleLength && haystack[i] && lowerChar(haystack[i]) == needle[i]) i++;
+        if (i == needleLength) return 1;
     }
-    
-    // --- Load Faculty ---
-    fp = fopen("db/faculty.dat", "r");
-    facultyCount = 0;
-    if (fp) {
-        char line[MAX_LINE_LENGTH];
-        while (fgets(line, MAX_LINE_LENGTH, fp) && facultyCount < MAX_RECORDS) {
-            char *token = strtok(line, ",");
-            if (token) strcpy(faculty[facultyCount].id, token); else continue;
-            token = strtok(NULL, ",");
-            if (token) strcpy(faculty[facultyCount].name, token); else continue;
-            token = strtok(NULL, ",");
-            if (token) {
-                normalizeString(token);
-                strcpy(faculty[facultyCount].department, token);
-            } else continue;
-            facultyCount++;
+    return 0;
+}
+
+// Semesters are written "YYYY-T" (e.g., "2024-2") so they compare as strings.
+// T runs from 1 to SEMESTERS_PER_YEAR, so "YYYY-T" also maps to one term number.
+int isValidSemester(const char *str) {
+    return strlen(str) == 6 && isdigit((unsigned char)str[0]) && isdigit((unsigned char)str[1]) &&
+           isdigit((unsigned char)str[2]) && isdigit((unsigned char)str[3]) && str[4] == '-' &&
+           str[5] >= '1' && str[5] < '1' + SEMESTERS_PER_YEAR;
+}
+
+// Prompts until a valid semester is entered; a blank answer keeps 'dest' as it is
+void readSemesterInput(const char *prompt, char *dest) {
+    while (1) {
+        char *input = getInput(prompt);
+        if (input[0] == '\0') return;
+        if (isValidSemester(input)) {
+            strcpy(dest, input);
+            return;
         }
-        fclose(fp);
+        printf("   Invalid semester. Use the form YYYY-T with T from 1 to %d, e.g., 2024-1.\n", SEMESTERS_PER_YEAR);
     }
 }
 
-// Saves Student records from memory array back to file
-void saveStudentRecords() {
-    FILE *fp = fopen("db/students.dat", "w");
-    if (!fp) {
-        printf("Error: Could not open students.dat for writing.\n");
-        return;
+// --- SCREEN RENDERER ---
+// stdout is switched to full buffering, so a whole frame (clear + menu or table)
+// collects in one buffer and reaches the terminal in a single write when the
+// program next waits for input. Clearing uses ANSI escapes instead of spawning
+// a shell. When stdout is not a terminal (piped, redirected), no escapes are
+// written and frames are simply separated by a blank line.
+
+#define FRAME_BUFFER_SIZE (64 * 1024)
+#define MIN_FITTED_COLUMN_WIDTH 6   // Columns never shrink below this to fit the terminal
+
+#ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+#define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+#endif
+
+static int outputIsTerminal = 0;
+static int terminalSupportsAnsi = 0;
+static char frameBuffer[FRAME_BUFFER_SIZE];
+
+// Must run before anything is written to stdout
+void initRenderer() {
+#ifdef _WIN32
+    outputIsTerminal = _isatty(_fileno(stdout));
+    if (outputIsTerminal) {
+        HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD mode = 0;
+        terminalSupportsAnsi = GetConsoleMode(console, &mode) &&
+                               SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
     }
-    for (int i = 0; i < studentCount; i++) {
-        fprintf(fp, "%s,%s,%s,%s\n", 
-                students[i].id, 
-                students[i].name, 
-                students[i].program, 
-                students[i].email);
-    }
-    fclose(fp);
+#else
+    const char *term = getenv("TERM");
+    outputIsTerminal = isatty(fileno(stdout));
+    terminalSupportsAnsi = outputIsTerminal && !(term && strcmp(term, "dumb") == 0);
+#endif
+    setvbuf(stdout, frameBuffer, _IOFBF, sizeof(frameBuffer));
 }
 
-// Saves Course records from memory array back to file
-void saveCourseRecords() {
-    FILE *fp = fopen("db/courses.dat", "w");
-    if (!fp) {
-        printf("Error: Could not open courses.dat for writing.\n");
-        return;
+// Sends the frame built so far; called wherever the program blocks on input
+void flushFrame() {
+    fflush(stdout);
+}
+
+// Width of the terminal in columns, or 0 when unknown / not a terminal
+int terminalColumns() {
+    if (!outputIsTerminal) return 0;
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+        return info.srWindow.Right - info.srWindow.Left + 1;
     }
-    for (int i = 0; i < courseCount; i++) {
-        fprintf(fp, "%s,%s,%d\n", 
-                courses[i].code, 
-                courses[i].name, 
-                courses[i].credits);
+#else
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0) return size.ws_col;
+#endif
+    return 0;
+}
+
+// Clears the console screen for cleaner UI
+void clearScreen() {
+    if (terminalSupportsAnsi) {
+        fputs("\033[H\033[2J\033[3J", stdout); // Cursor home, clear screen, clear scrollback
+    } else if (outputIsTerminal) {
+        #ifdef _WIN32
+            fflush(stdout); // Legacy console without escape support
+            system("cls");
+        #else
+            fputs("\n\n", stdout);
+        #endif
+    } else {
+        fputs("\n", stdout);
     }
-    fclose(fp);
 }
 
-// Saves Faculty records from memory array back to file
-void saveFacultyRecords() {
-    FILE *fp = fopen("db/faculty.dat", "w");
-    if (!fp) {
-        printf("Error: Could not open faculty.dat for writing.\n");
-        return;
+// Takes 'columns' header strings; they must outlive the table
+void tvInit(TableView *tv, int columns, ...) {
+    memset(tv, 0, sizeof(*tv));
+    tv->columns = columns > MAX_TABLE_COLUMNS ? MAX_TABLE_COLUMNS : columns;
+    va_list args;
+    va_start(args, columns);
+    for (int c = 0; c < tv->columns; c++) tv->headers[c] = va_arg(args, const char *);
+    va_end(args);
+}
+
+// Same as tvInit, for column lists built at run time
+void tvInitColumns(TableView *tv, int columns, const char *const *headers) {
+    memset(tv, 0, sizeof(*tv));
+    tv->columns = columns > MAX_TABLE_COLUMNS ? MAX_TABLE_COLUMNS : columns;
+    for (int c = 0; c < tv->columns; c++) tv->headers[c] = headers[c];
+}
+
+void tvAlignRight(TableView *tv, int column) {
+    if (column >= 0 && column < tv->columns) tv->rightAligned[column] = 1;
+}
+
+// Takes an array of one string per column; the strings are copied
+void tvAddRowCells(TableView *tv, const char *const *cells) {
+    if (tv->rows == tv->capacity) {
+        int newCapacity = tv->capacity ? tv->capacity * 2 : 32;
+        size_t *grown = (size_t *)realloc(tv->cellOffsets, sizeof(size_t) * newCapacity * tv->columns);
+        if (grown == NULL) return;
+        tv->cellOffsets = grown;
+        tv->capacity = newCapacity;
     }
-    for (int i = 0; i < facultyCount; i++) {
-        fprintf(fp, "%s,%s,%s\n", 
-                faculty[i].id, 
-                faculty[i].name, 
-                faculty[i].department);
+    for (int c = 0; c < tv->columns; c++) {
+        const char *cell = cells[c] ? cells[c] : "";
+        tv->cellOffsets[tv->rows * tv->columns + c] = tv->cells.length;
+        tbAppendBytes(&tv->cells, cell, strlen(cell) + 1);
     }
-    fclose(fp);
+    tv->rows++;
 }
 
+// Takes one string per column; the strings are copied
+void tvAddRow(TableView *tv, ...) {
+    const char *cells[MAX_TABLE_COLUMNS];
+    va_list args;
+    va_start(args, tv);
+    for (int c = 0; c < tv->columns; c++) cells[c] = va_arg(args, const char *);
+    va_end(args);
+    tvAddRowCells(tv, cells);
+}
 
-// --- HASH TABLE (LOCATION GUIDE) IMPLEMENTATION ---
+static const char* tvCell(const TableView *tv, int row, int column) {
+    return tv->cells.data + tv->cellOffsets[row * tv->columns + column];
+}
 
-// Simple custom hash function for strings
-int hashFunction(const char *key) {
-    int hash = 0;
-    for (int i = 0; key[i] != '\0'; i++) {
-        hash = (hash * 31 + key[i]) % HASH_SIZE;
+static void tvAppendBorder(TextBuffer *out, const int *widths, int columns) {
+    tbAppendBytes(out, "+", 1);
+    for (int c = 0; c < columns; c++) {
+        for (int i = 0; i < widths[c] + 2; i++) tbAppendBytes(out, "-", 1);
+        tbAppendBytes(out, "+", 1);
     }
-    return hash;
+    tbAppendBytes(out, "\n", 1);
 }
 
-// Inserts a new location into the hash table
-void insertLocation(const char *key, const char *building, const char *floor, const char *room, const char *desc) {
-    int index = hashFunction(key);
-    LocationNode *newNode = (LocationNode *)malloc(sizeof(LocationNode));
-    if (newNode == NULL) {
-        printf("Memory allocation failed.\n");
-        return;
+// Cells wider than their column are cut short and end in "..."
+static void tvAppendCell(TextBuffer *out, const char *text, int width, int rightAligned) {
+    int length = (int)strlen(text);
+    if (length > width) {
+        tbAppendf(out, " %.*s... |", width - 3, text);
+    } else if (rightAligned) {
+        tbAppendf(out, " %*s |", width, text);
+    } else {
+        tbAppendf(out, " %-*s |", width, text);
     }
+}
 
-    // Copy data to the new node
-    strncpy(newNode->key, key, MAX_ID_LENGTH - 1); newNode->key[MAX_ID_LENGTH - 1] = '\0';
-    strncpy(newNode->building, building, MAX_NAME_LENGTH - 1); newNode->building[MAX_NAME_LENGTH - 1] = '\0';
-    strncpy(newNode->floor, floor, MAX_ID_LENGTH - 1); newNode->floor[MAX_ID_LENGTH - 1] = '\0';
-    strncpy(newNode->room, room, MAX_ID_LENGTH - 1); newNode->room[MAX_ID_LENGTH - 1] = '\0';
-    strncpy(newNode->description, desc, MAX_NAME_LENGTH - 1); newNode->description[MAX_NAME_LENGTH - 1] = '\0';
+// Fits the columns in one pass over the cells and appends the whole table to
+// 'text'. A 'width' of 0 leaves the columns unbounded. Frees the table.
+void tvRenderText(TableView *tv, TextBuffer *text, int width) {
+    int widths[MAX_TABLE_COLUMNS];
+    int total = 1;
+    for (int c = 0; c < tv->columns; c++) widths[c] = (int)strlen(tv->headers[c]);
+    for (int r = 0; r < tv->rows; r++) {
+        for (int c = 0; c < tv->columns; c++) {
+            int length = (int)strlen(tvCell(tv, r, c));
+            if (length > widths[c]) widths[c] = length;
+        }
+    }
+    for (int c = 0; c < tv->columns; c++) total += widths[c] + 3;
+
+    // On a narrow terminal, take width from the widest column until the table fits
+    int limit = width;
+    while (limit > 0 && total > limit) {
+        int widest = 0;
+        for (int c = 1; c < tv->columns; c++) {
+            if (widths[c] > widths[widest]) widest = c;
+        }
+        if (widths[widest] <= MIN_FITTED_COLUMN_WIDTH) break;
+        widths[widest]--;
+        total--;
+    }
 
-    // Insert node at the head of the linked list (Separate Chaining)
-    newNode->next = hashTable[index];
-    hashTable[index] = newNode;
+    tvAppendBorder(text, widths, tv->columns);
+    tbAppendBytes(text, "|", 1);
+    for (int c = 0; c < tv->columns; c++) tvAppendCell(text, tv->headers[c], widths[c], 0);
+    tbAppendBytes(text, "\n", 1);
+    tvAppendBorder(text, widths, tv->columns);
+    for (int r = 0; r < tv->rows; r++) {
+        tbAppendBytes(text, "|", 1);
+        for (int c = 0; c < tv->columns; c++) {
+            tvAppendCell(text, tvCell(tv, r, c), widths[c], tv->rightAligned[c]);
+        }
+        tbAppendBytes(text, "\n", 1);
+    }
+    tvAppendBorder(text, widths, tv->columns);
+
+    free(tv->cells.data);
+    free(tv->cellOffsets);
+    memset(tv, 0, sizeof(*tv));
 }
 
-// Reads data from the file into the Hash Table
-void loadLocationData() {
-    // Free existing hash table data first
-    for (int i = 0; i < HASH_SIZE; i++) {
-        LocationNode *current = hashTable[i];
-        while (current) {
-            LocationNode *temp = current;
-            current = current->next;
-            free(temp);
+// Renders the table and hands it to 'out' with one fwrite. Frees the table.
+void tvRender(TableView *tv, FILE *out) {
+    TextBuffer text = {0};
+    tvRenderText(tv, &text, out == stdout ? terminalColumns() : 0);
+    if (text.length) fwrite(text.data, 1, text.length, out);
+    free(text.data);
+}
+
+// --- RENDERED VIEW CACHE ---
+// Read-mostly pages (course catalog, faculty directory, notice board) are kept
+// as finished text, so a repeat visit is one buffer write. Each page holds a few
+// slots keyed by output format: the terminal width its tables were fitted to,
+// a per-page variant (the viewer's role) and a freshness stamp (today's date).
+// The save paths for the underlying table drop every slot of the page.
+
+static CachedView viewCache[VIEW_COUNT][VIEW_CACHE_SLOTS];
+static unsigned long viewCacheClock = 0;
+
+// Returns the page body for the current terminal width, building it with
+// 'build' on a miss. The text stays valid until the page is next rebuilt.
+const char* cachedView(ViewID view, int variant, int stamp, ViewBuilder build) {
+    int width = terminalColumns();
+    CachedView *slots = viewCache[view];
+    CachedView *victim = &slots[0];
+    for (int s = 0; s < VIEW_CACHE_SLOTS; s++) {
+        CachedView *slot = &slots[s];
+        if (slot->valid && slot->width == width && slot->variant == variant && slot->stamp == stamp) {
+            slot->lastUsed = ++viewCacheClock;
+            return slot->text.data ? slot->text.data : "";
         }
-        hashTable[i] = NULL;
+        // Reuse an empty slot first, otherwise the least recently shown format
+        unsigned long age = slot->valid ? slot->lastUsed : 0;
+        unsigned long victimAge = victim->valid ? victim->lastUsed : 0;
+        if (age < victimAge) victim = slot;
     }
 
-    FILE *fp = fopen("db/university_data.txt", "r");
-    if (fp == NULL) {
-        printf("Warning: 'university_data.txt' not found or could not be opened. Location features will be empty.\n");
+    tbClear(&victim->text);
+    build(&victim->text, width, variant);
+    victim->valid = 1;
+    victim->width = width;
+    victim->variant = variant;
+    victim->stamp = stamp;
+    victim->lastUsed = ++viewCacheClock;
+    return victim->text.data ? victim->text.data : "";
+}
+
+// Drops every cached format of a page; the buffers are kept for the rebuild
+void invalidateView(ViewID view) {
+    for (int s = 0; s < VIEW_CACHE_SLOTS; s++) viewCache[view][s].valid = 0;
+}
+
+// --- INPUT SESSIONS (RECORD AND REPLAY) ---
+// Every keyboard read goes through readInputLine. Normally it reads a line from
+// stdin. During a replay it takes the next line of a recorded session file.
+// While recording, each line is saved along with the think time the user spent
+// at the prompt, so a replay can reproduce real pacing or compress it.
+// In a replay, a step's latency is the time from handing a line to the app
+// until the app asks for the next one. That covers the action, any file I/O
+// and rendering the next frame.
+//
+// Session file: a "#session v1" header, then one "<think ms>\t<line>" per input.
+// Recordings hold whatever was typed, passwords included.
+
+#define SESSION_HEADER "#session v1"
+#define MAX_STEP_LABEL 64
+#define REPORT_SLOWEST_GROUPS 15
+
+typedef struct ReplayLine {
+    long thinkMillis;
+    char *text;
+} ReplayLine;
+
+typedef struct StepLatency {
+    int session;
+    char label[MAX_STEP_LABEL];  // Prompt and the input answered to it
+    double millis;
+} StepLatency;
+
+static FILE *recordFile = NULL;
+static int replayActive = 0;
+static double replaySpeed = 1.0;     // Think-time divisor; 0 skips think time entirely
+static ReplayLine *replayLines = NULL;
+static int replayLineCount = 0;
+static int replayPosition = 0;
+static int replaySession = 0;
+static jmp_buf replaySessionEnd;
+static double stepStartedAt = -1;    // When the pending step's line was handed over
+static char stepLabel[MAX_STEP_LABEL];
+static StepLatency *stepLatencies = NULL;
+static int stepCount = 0;
+static int stepCapacity = 0;
+
+double monotonicMillis() {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1000.0 / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+#endif
+}
+
+int startRecording(const char *path) {
+    recordFile = fopen(path, "w");
+    if (recordFile == NULL) {
+        printf("Error: Could not create session recording %s.\n", path);
+        return 0;
+    }
+    fprintf(recordFile, "%s\n", SESSION_HEADER);
+    return 1;
+}
+
+// Closes out the step in flight, if any, at time 'now'
+static void finishReplayStep(double now) {
+    if (stepStartedAt < 0) return;
+    if (stepCount == stepCapacity) {
+        int newCapacity = stepCapacity ? stepCapacity * 2 : 256;
+        StepLatency *grown = (StepLatency *)realloc(stepLatencies, sizeof(StepLatency) * newCapacity);
+        if (grown == NULL) return;
+        stepLatencies = grown;
+        stepCapacity = newCapacity;
+    }
+    StepLatency *step = &stepLatencies[stepCount++];
+    step->session = replaySession;
+    strcpy(step->label, stepLabel);
+    step->millis = now - stepStartedAt;
+    stepStartedAt = -1;
+}
+
+// Called when there is no more input: ends the replayed session, or the program
+// (this is also the exit path of loginMenu and mainMenu, so it is the shutdown
+// barrier for saves still being written behind)
+void endInputSession() {
+    if (replayActive) {
+        finishReplayStep(monotonicMillis());
+        flushPersistence();
+        longjmp(replaySessionEnd, 1);
+    }
+    flushPersistence();
+    if (recordFile) fclose(recordFile);
+    flushFrame();
+    exit(0);
+}
+
+// Reads one line into 'dest' without its newline. 'label' names the prompt in
+// latency reports. Does not return once input is exhausted (a replay unwinds
+// with longjmp), so no caller may hold an epoch slot, a lock or a half-applied
+// edit across a prompt.
+void readInputLine(const char *label, char *dest, size_t size) {
+    flushFrame();
+    double promptShownAt = monotonicMillis();
+
+    if (replayActive) {
+        finishReplayStep(promptShownAt);
+        if (replayPosition >= replayLineCount) endInputSession();
+        const ReplayLine *line = &replayLines[replayPosition++];
+        if (replaySpeed > 0 && line->thinkMillis > 0) sleepMillis((int)(line->thinkMillis / replaySpeed));
+
+        strncpy(dest, line->text, size - 1);
+        dest[size - 1] = '\0';
+        printf("%s\n", dest); // Echo so the transcript reads like a terminal
+        while (isspace((unsigned char)*label)) label++;
+        int labelLength = (int)strlen(label);
+        while (labelLength > 0 && (isspace((unsigned char)label[labelLength - 1]) || label[labelLength - 1] == ':')) labelLength--;
+        if (labelLength > 44) labelLength = 44;
+        snprintf(stepLabel, sizeof(stepLabel), "%.*s%s%.12s", labelLength, label, dest[0] ? " = " : "", dest);
+        stepStartedAt = monotonicMillis();
         return;
     }
 
-    char line[MAX_LINE_LENGTH];
-    while (fgets(line, MAX_LINE_LENGTH, fp) != NULL) {
-        // Skip comment lines or empty lines
-        if (line[0] == '#' || strlen(line) < 5) continue;
+    if (fgets(dest, (int)size, stdin) == NULL) {
+        printf("\nInput closed. Goodbye!\n");
+        endInputSession();
+    }
+    if (strchr(dest, '\n') == NULL) {
+        int c;
+        while ((c = getchar()) != '\n' && c != EOF); // Drop the rest of an over-long line
+    }
+    normalizeString(dest);
+
+    if (recordFile) {
+        fprintf(recordFile, "%ld\t%s\n", (long)(monotonicMillis() - promptShownAt), dest);
+        fflush(recordFile);
+    }
+}
 
-        // Tokenize line using ';' delimiter
-        char *key = strtok(line, ";");
-        char *building = strtok(NULL, ";");
-        char *floor = strtok(NULL, ";");
-        char *room = strtok(NULL, ";");
-        char *description = strtok(NULL, ";");
+// Prints 'prompt' and reads a whole line as an integer; returns 0 if it is not one
+int readIntInput(const char *prompt, int *value) {
+    char line[MAX_LINE_LENGTH];
+    char *end;
+    printf("%s", prompt);
+    readInputLine(prompt, line, sizeof(line));
+    long parsed = strtol(line, &end, 10);
+    if (end == line || *end != '\0') return 0;
+    *value = (int)parsed;
+    return 1;
+}
 
-        if (key && building && floor && room && description) {
-            normalizeString(key);
-            normalizeString(building);
-            normalizeString(floor);
-            normalizeString(room);
-            normalizeString(description);
-            insertLocation(key, building, floor, room, description);
+static int loadReplayFile(const char *path) {
+    FILE *fp = fopen(path, "r");
+    char line[MAX_LINE_LENGTH];
+    if (fp == NULL || fgets(line, sizeof(line), fp) == NULL || strncmp(line, SESSION_HEADER, strlen(SESSION_HEADER)) != 0) {
+        printf("Error: %s is not a recorded session.\n", path);
+        if (fp) fclose(fp);
+        return 0;
+    }
+    for (int i = 0; i < replayLineCount; i++) free(replayLines[i].text);
+    replayLineCount = 0;
+    replayPosition = 0;
+
+    int capacity = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        char *tab = strchr(line, '\t');
+        if (tab == NULL) continue;
+        if (replayLineCount == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            ReplayLine *grown = (ReplayLine *)realloc(replayLines, sizeof(ReplayLine) * capacity);
+            if (grown == NULL) break;
+            replayLines = grown;
         }
+        line[strcspn(line, "\r\n")] = '\0';
+        replayLines[replayLineCount].thinkMillis = strtol(line, NULL, 10);
+        replayLines[replayLineCount].text = strdup(tab + 1);
+        replayLineCount++;
     }
     fclose(fp);
+    return 1;
 }
 
-// Appends a new location to the data file
-void saveLocationToFile(const char *key, const char *building, const char *floor, const char *room, const char *desc) {
-    FILE *fp = fopen("db/university_data.txt", "a"); // 'a' for append mode
-    if (fp == NULL) {
-        printf("Error: Could not open university_data.txt for writing.\n");
-        return;
-    }
-    fprintf(fp, "%s;%s;%s;%s;%s\n", key, building, floor, room, desc);
-    fclose(fp);
-    loadLocationData(); // Reload hash table to include new entry
+static int compareStepLabels(const void *a, const void *b) {
+    return strcmp(((const StepLatency *)a)->label, ((const StepLatency *)b)->label);
 }
 
-// Rewrites the entire location file from the current Hash Table state
-void rewriteLocationFile() {
-    FILE *fp = fopen("db/university_data.txt", "w"); // 'w' for overwrite mode
-    if (fp == NULL) {
-        printf("Error: Could not open university_data.txt for writing.\n");
+static int compareMillis(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct StepGroup {
+    const char *label;
+    int steps;
+    double total;
+    double p95;
+    double max;
+} StepGroup;
+
+static int compareGroupTotals(const void *a, const void *b) {
+    double x = ((const StepGroup *)a)->total, y = ((const StepGroup *)b)->total;
+    return (y > x) - (y < x);
+}
+
+// Per-prompt latency summary, slowest (by total time spent) first
+static void printLatencyReport(int sessions, double wallMillis) {
+    fprintf(stderr, "\n=== Replay latency report ===\n");
+    fprintf(stderr, "Sessions: %d | Steps: %d | Wall time: %.1f ms (think time %s)\n\n",
+            sessions, stepCount, wallMillis, replaySpeed > 0 ? "included" : "skipped");
+    if (stepCount == 0) return;
+
+    qsort(stepLatencies, stepCount, sizeof(StepLatency), compareStepLabels);
+    StepGroup *groups = (StepGroup *)calloc(stepCount, sizeof(StepGroup));
+    double *samples = (double *)malloc(sizeof(double) * stepCount);
+    double overall = 0;
+    int groupCount = 0;
+    if (groups == NULL || samples == NULL) {
+        free(groups);
+        free(samples);
         return;
     }
-    fprintf(fp, "# Location Data File\n");
-    fprintf(fp, "# Format: key;building;floor;room;description\n");
 
-    for (int i = 0; i < HASH_SIZE; i++) {
-        LocationNode *current = hashTable[i];
-        while (current) {
-            fprintf(fp, "%s;%s;%s;%s;%s\n", 
-                    current->key, 
-                    current->building, 
-                    current->floor, 
-                    current->room, 
-                    current->description);
-            current = current->next;
+    for (int start = 0; start < stepCount; ) {
+        int end = start;
+        StepGroup *group = &groups[groupCount++];
+        group->label = stepLatencies[start].label;
+        while (end < stepCount && strcmp(stepLatencies[end].label, group->label) == 0) {
+            samples[end - start] = stepLatencies[end].millis;
+            group->total += stepLatencies[end].millis;
+            end++;
         }
+        group->steps = end - start;
+        qsort(samples, group->steps, sizeof(double), compareMillis);
+        group->p95 = samples[(group->steps * 95 - 1) / 100];
+        group->max = samples[group->steps - 1];
+        overall += group->total;
+        start = end;
     }
-    fclose(fp);
+    qsort(groups, groupCount, sizeof(StepGroup), compareGroupTotals);
+
+    TableView table;
+    tvInit(&table, 6, "Prompt = input", "Steps", "Mean ms", "p95 ms", "Max ms", "Total ms");
+    for (int c = 1; c < 6; c++) tvAlignRight(&table, c);
+    for (int g = 0; g < groupCount && g < REPORT_SLOWEST_GROUPS; g++) {
+        char steps[16], mean[24], p95[24], max[24], total[24];
+        snprintf(steps, sizeof(steps), "%d", groups[g].steps);
+        snprintf(mean, sizeof(mean), "%.3f", groups[g].total / groups[g].steps);
+        snprintf(p95, sizeof(p95), "%.3f", groups[g].p95);
+        snprintf(max, sizeof(max), "%.3f", groups[g].max);
+        snprintf(total, sizeof(total), "%.3f", groups[g].total);
+        tvAddRow(&table, groups[g].label, steps, mean, p95, max, total);
+    }
+    tvRender(&table, stderr);
+    fprintf(stderr, "\nTime in the app across all steps: %.3f ms (mean %.3f ms per step)\n",
+            overall, overall / stepCount);
+
+    free(groups);
+    free(samples);
 }
 
-// --- LOCATION FUNCTIONALITIES MENU ---
+// Replays each recorded session in turn against this process, starting every
+// one from the login screen, then prints the latency report to stderr.
+int replaySessions(char **paths, int count, double speed) {
+    volatile int sessions = 0; // Kept across the longjmp that ends each session
+    replaySpeed = speed;
+    double started = monotonicMillis();
+
+    for (volatile int i = 0; i < count; i++) {
+        if (!loadReplayFile(paths[i])) continue;
+        currentUserRole = ROLE_UNKNOWN;
+        loggedInUserID[0] = '\0';
+        replaySession = ++sessions;
+        replayActive = 1;
+        if (setjmp(replaySessionEnd) == 0) runApplication();
+        replayActive = 0;
+    }
+    flushFrame();
+    printLatencyReport(sessions, monotonicMillis() - started);
+    return sessions > 0;
+}
 
-void locationFunctionalitiesMenu() {
-    clearScreen();
-    int choice;
-    do {
-        clearScreen();
-        printf("======================================================\n");
-        printf("              Campus Location Guidebook\n");
-        printf("======================================================\n");
-        printf("This module allows you to find locations by Task Key.\n");
-        printf("Example Keys: 'library', 'c_lab', 'admin_office', etc.\n\n");
-        
-        printf("[1] Search for a Location (By Task Key)\n");
-        printf("[2] View All Available Locations\n");
-        printf("[3] Add a New Location (Admin/Staff only)\n");
-        printf("[4] Delete a Location (Admin/Staff only)\n");
-        printf("[5] Return to Main Menu\n");
-        printf("------------------------------------------------------\n");
+// --- DATE HELPERS (dates are stored as YYYYMMDD integers so they sort naturally) ---
 
-        choice = getMenuChoice(5);
+int todayDate() {
+    time_t now = time(NULL);
+    struct tm *local = localtime(&now);
+    return (local->tm_year + 1900) * 10000 + (local->tm_mon + 1) * 100 + local->tm_mday;
+}
 
-        switch (choice) {
-            case 1: searchLocation(); break;
-            case 2: viewAllLocations(); break;
-            case 3: addLocationMenu(); break;
-            case 4: deleteLocationMenu(); break;
-            case 5: printf("Returning to Main Menu...\n"); break;
-        }
-        if (choice != 5) pressEnterToContinue();
+// Adds (or subtracts) days, letting mktime normalise month/year rollover
+int addDaysToDate(int date, int days) {
+    struct tm t = {0};
+    t.tm_year = date / 10000 - 1900;
+    t.tm_mon = (date / 100) % 100 - 1;
+    t.tm_mday = date % 100 + days;
+    t.tm_hour = 12; // Midday avoids DST edge cases
+    mktime(&t);
+    return (t.tm_year + 1900) * 10000 + (t.tm_mon + 1) * 100 + t.tm_mday;
+}
 
-    } while (choice != 5);
+static int daysInMonth(int year, int month) {
+    static const int days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    int leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return days[month - 1] + (month == 2 && leap);
 }
 
-void searchLocation() {
-    clearScreen();
-    printf("======================================================\n");
-    printf("                  Search Location\n");
-    printf("======================================================\n");
-    printf("Instruction: Enter the unique 'Task Key' (e.g., 'library', 'c_lab') to find its location.\n\n");
-    
-    char *key = getInput("Enter Task Key to search: ");
-    
-    int index = hashFunction(key);
-    LocationNode *current = hashTable[index];
-    int found = 0;
+// Parses "YYYY-MM-DD" into YYYYMMDD, returns 0 if the string is not a valid date
+int parseDate(const char *str) {
+    int y, m, d;
+    if (sscanf(str, "%4d-%2d-%2d", &y, &m, &d) != 3) return 0;
+    if (y < 1900 || m < 1 || m > 12 || d < 1 || d > daysInMonth(y, m)) return 0;
+    return y * 10000 + m * 100 + d;
+}
 
-    printf("\n--- Search Results ---\n");
-    while (current) {
-        if (strcmp(current->key, key) == 0) {
-            printf("Key: %s\n", current->key);
-            printf("Building: %s\n", current->building);
-            printf("Floor: %s\n", current->floor);
-            printf("Room/Facility: %s\n", current->room);
-            printf("Description: %s\n", current->description);
-            found = 1;
-            break;
-        }
-        current = current->next;
-    }
+void formatDate(int date, char *out, size_t size) {
+    snprintf(out, size, "%04d-%02d-%02d", date / 10000, (date / 100) % 100, date % 100);
+}
 
-    if (!found) {
-        printf("Location for key '%s' not found in the directory.\n", key);
+// --- THREADING PRIMITIVES (Win32 threads or pthreads) ---
+
+#ifdef _WIN32
+typedef CRITICAL_SECTION Mutex;
+typedef HANDLE Thread;
+#define THREAD_FUNC(name, arg) static DWORD WINAPI name(LPVOID arg)
+#define THREAD_RETURN return 0
+#define mutexInit(m) InitializeCriticalSection(m)
+#define mutexLock(m) EnterCriticalSection(m)
+#define mutexUnlock(m) LeaveCriticalSection(m)
+#define threadStart(t, fn, arg) ((*(t) = CreateThread(NULL, 0, fn, arg, 0, NULL)) != NULL)
+#define threadDetach(t) CloseHandle(t)
+#define threadJoin(t) (WaitForSingleObject(t, INFINITE), CloseHandle(t))
+typedef CONDITION_VARIABLE CondVar;
+#define condInit(c) InitializeConditionVariable(c)
+#define condWait(c, m) SleepConditionVariableCS(c, m, INFINITE)
+#define condWaitMillis(c, m, ms) SleepConditionVariableCS(c, m, (DWORD)(ms))
+#define condBroadcast(c) WakeAllConditionVariable(c)
+#else
+typedef pthread_mutex_t Mutex;
+typedef pthread_t Thread;
+#define THREAD_FUNC(name, arg) static void *name(void *arg)
+#define THREAD_RETURN return NULL
+#define mutexInit(m) pthread_mutex_init(m, NULL)
+#define mutexLock(m) pthread_mutex_lock(m)
+#define mutexUnlock(m) pthread_mutex_unlock(m)
+#define threadStart(t, fn, arg) (pthread_create(t, NULL, fn, arg) == 0)
+#define threadDetach(t) pthread_detach(t)
+#define threadJoin(t) pthread_join(t, NULL)
+typedef pthread_cond_t CondVar;
+#define condInit(c) pthread_cond_init(c, NULL)
+#define condWait(c, m) pthread_cond_wait(c, m)
+#define condBroadcast(c) pthread_cond_broadcast(c)
+
+// Waits for a broadcast or until 'ms' milliseconds have passed
+static void condWaitMillis(CondVar *c, Mutex *m, int ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ms / 1000;
+    deadline.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
     }
+    pthread_cond_timedwait(c, m, &deadline);
 }
+#endif
 
-void viewAllLocations() {
-    clearScreen();
-    printf("======================================================\n");
-    printf("              All Available Locations\n");
-    printf("======================================================\n");
-    printf("This shows all locations currently loaded into the system:\n\n");
-    
-    int total = 0;
-    
-    printf("+-----------------+---------------------+-------------+-----------+------------------------+\n");
-    printf("| Task Key        | Building            | Floor       | Room      | Description            |\n");
-    printf("+-----------------+---------------------+-------------+-----------+------------------------+\n");
+int processorCount() {
+    #ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return (int)info.dwNumberOfProcessors;
+    #else
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        return count > 0 ? (int)count : 1;
+    #endif
+}
 
-    for (int i = 0; i < HASH_SIZE; i++) {
-        LocationNode *current = hashTable[i];
-        while (current) {
-            printf("| %-15s | %-19s | %-11s | %-9s | %-22s |\n", 
-                   current->key, 
-                   current->building, 
-                   current->floor, 
-                   current->room, 
-                   current->description);
-            current = current->next;
-            total++;
+void sleepMillis(int ms) {
+    #ifdef _WIN32
+        Sleep(ms);
+    #else
+        struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+        nanosleep(&ts, NULL);
+    #endif
+}
+
+// --- CONCURRENT ACCESS (FILE LOCKS AND VERSION STAMPS) ---
+// Several guide instances may share one db directory. Readers take a shared
+// lock while parsing; writers serialise the table first and only then take an
+// exclusive lock, so the lock is held just for the version check and the write.
+// Every table file starts with a fixed-width "#version=" line that writers bump.
+// A writer whose in-memory version is behind the file merges its own changed
+// records into the newer file instead of overwriting it.
+
+int tableVersions[TABLE_COUNT];          // Version of each table as last loaded or written
+DirtySet dirtyRecords[TABLE_COUNT];      // Keys changed locally since the last successful write
+DurabilityPolicy durabilityPolicy = DURABILITY_BARRIER;
+static atomic_int unsyncedTables[TABLE_COUNT]; // Written since the last barrier sync
+
+static const char *durabilityNames[] = { "none", "barrier", "always" };
+
+// Selects the fsync policy by name; returns 0 if 'name' is not a policy
+int setDurabilityPolicy(const char *name) {
+    for (int p = DURABILITY_NONE; p <= DURABILITY_ALWAYS; p++) {
+        if (strcmp(name, durabilityNames[p]) == 0) {
+            durabilityPolicy = (DurabilityPolicy)p;
+            return 1;
         }
     }
-    
-    printf("+-----------------+---------------------+-------------+-----------+------------------------+\n");
-    printf("\nTotal locations found: %d\n", total);
+    return 0;
 }
 
-void addLocationMenu() {
-    if (currentUserRole != ROLE_ADMIN) {
-        printf("\nAuthorization Required: Only Administrators can add new locations.\n");
-        return;
-    }
-    
-    clearScreen();
-    printf("======================================================\n");
-    printf("                  Add New Location\n");
-    printf("======================================================\n");
+static void syncFileToDisk(FILE *fp) {
+    fflush(fp);
+    #ifdef _WIN32
+        _commit(_fileno(fp));
+    #else
+        fsync(fileno(fp));
+    #endif
+}
+
+// Moves 'from' over 'to' in one step (rename cannot replace a file on Windows)
+static int replaceFile(const char *from, const char *to) {
+    #ifdef _WIN32
+        return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) ? 1 : 0;
+    #else
+        return rename(from, to) == 0;
+    #endif
+}
+
+// Called after writing a table file, while it is still open
+static void noteTableWrite(TableID table, FILE *fp) {
+    if (durabilityPolicy == DURABILITY_ALWAYS) {
+        syncFileToDisk(fp);
+    } else if (durabilityPolicy == DURABILITY_BARRIER) {
+        atomic_store(&unsyncedTables[table], 1);
+    }
+}
+
+// Syncs every table written since the last call (the DURABILITY_BARRIER policy)
+void syncWrittenTables() {
+    for (int t = 0; t < TABLE_COUNT; t++) {
+        if (!atomic_exchange(&unsyncedTables[t], 0)) continue;
+        FILE *fp = fopen(tableFiles[t], "r+");
+        if (fp == NULL) continue;
+        syncFileToDisk(fp);
+        fclose(fp);
+    }
+}
+
+// Takes a shared (reader) or exclusive (writer) advisory lock on the whole file
+int lockFile(FILE *fp, int exclusive) {
+    #ifdef _WIN32
+        OVERLAPPED overlapped = {0};
+        HANDLE handle = (HANDLE)_get_osfhandle(_fileno(fp));
+        DWORD flags = exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0;
+        return LockFileEx(handle, flags, 0, MAXDWORD, MAXDWORD, &overlapped) ? 1 : 0;
+    #else
+        // flock locks belong to the open file, so another thread closing its own
+        // handle on the same file cannot drop this lock (unlike fcntl locks)
+        while (flock(fileno(fp), exclusive ? LOCK_EX : LOCK_SH) != 0) {
+            if (errno != EINTR) return 0;
+        }
+        return 1;
+    #endif
+}
+
+void unlockFile(FILE *fp) {
+    fflush(fp);
+    #ifdef _WIN32
+        OVERLAPPED overlapped = {0};
+        UnlockFileEx((HANDLE)_get_osfhandle(_fileno(fp)), 0, MAXDWORD, MAXDWORD, &overlapped);
+    #else
+        flock(fileno(fp), LOCK_UN);
+    #endif
+}
+
+static int truncateFile(FILE *fp) {
+    fflush(fp);
+    #ifdef _WIN32
+        return _chsize(_fileno(fp), 0) == 0;
+    #else
+        return ftruncate(fileno(fp), 0) == 0;
+    #endif
+}
+
+// Returns 1 for '#' lines (comments and the version header); reads the version if present
+int isHeaderLine(const char *line, int *version) {
+    if (line[0] != '#') return 0;
+    if (version && strncmp(line, VERSION_HEADER_PREFIX, strlen(VERSION_HEADER_PREFIX)) == 0) {
+        *version = atoi(line + strlen(VERSION_HEADER_PREFIX));
+    }
+    return 1;
+}
+
+// Opens a table file for shared reading, or NULL if it does not exist
+FILE* openTableForRead(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (fp && !lockFile(fp, 0)) {
+        fclose(fp);
+        return NULL;
+    }
+    return fp;
+}
+
+void closeTable(FILE *fp) {
+    unlockFile(fp);
+    fclose(fp);
+}
+
+// Takes the exclusive writers' lock of a table (students.dat -> students.lock).
+// Saves replace the table file by rename, so the file itself cannot carry it;
+// readers keep share-locking the file, and see either the old or the new one.
+static FILE* lockTableWriters(TableID table) {
+    char path[MAX_LINE_LENGTH + 8];
+    snprintf(path, sizeof(path), "%s", tableFiles[table]);
+    char *base = strrchr(path, '/');
+    char *extension = strrchr(base ? base : path, '.');
+    if (extension) *extension = '\0';
+    strcat(path, ".lock");
+    FILE *fp = fopen(path, "a");
+    if (fp && !lockFile(fp, 1)) {
+        fclose(fp);
+        return NULL;
+    }
+    return fp;
+}
+
+// Opens a table file for writing under an exclusive lock without truncating it,
+// and reports the version currently on disk (0 if the file has no header yet).
+// 'writers' gets the table's writers' lock; release both with closeTable().
+static FILE* openTableForWrite(TableID table, FILE **writers, int *diskVersion, int *hasHeader) {
+    *writers = lockTableWriters(table);
+    if (*writers == NULL) return NULL;
+    FILE *fp = fopen(tableFiles[table], "r+");
+    if (fp == NULL) fp = fopen(tableFiles[table], "w+");
+    if (fp && !lockFile(fp, 1)) {
+        fclose(fp);
+        fp = NULL;
+    }
+    if (fp == NULL) {
+        closeTable(*writers);
+        return NULL;
+    }
+
+    char line[MAX_LINE_LENGTH];
+    *diskVersion = 0;
+    *hasHeader = 0;
+    if (fgets(line, MAX_LINE_LENGTH, fp) &&
+        strncmp(line, VERSION_HEADER_PREFIX, strlen(VERSION_HEADER_PREFIX)) == 0) {
+        *diskVersion = atoi(line + strlen(VERSION_HEADER_PREFIX));
+        *hasHeader = 1;
+    }
+    return fp;
+}
+
+// Replaces a table file with 'body' if the disk still holds 'expectedVersion'.
+// Returns 1 when written, 0 when the disk copy is newer (caller must merge), -1 on error.
+// Leaves the in-memory tables alone, so the persistence thread can call it.
+// The new file is written next to the old one and renamed over it, so a crash
+// or a full disk mid-save leaves the previous version in place.
+int writeTableFile(TableID table, const char *body, int expectedVersion) {
+    int diskVersion, hasHeader;
+    FILE *writers;
+    FILE *fp = openTableForWrite(table, &writers, &diskVersion, &hasHeader);
+    if (fp == NULL) return -1;
+    closeTable(fp); // Only its version was needed
+
+    if (diskVersion != expectedVersion) {
+        closeTable(writers);
+        return 0;
+    }
+
+    char tempPath[MAX_LINE_LENGTH + 8];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", tableFiles[table]);
+    FILE *out = fopen(tempPath, "w");
+    int ok = (out != NULL);
+    if (ok) {
+        fprintf(out, VERSION_HEADER_FORMAT, expectedVersion + 1);
+        fputs(body, out);
+        ok = fflush(out) == 0 && !ferror(out);
+        if (ok) noteTableWrite(table, out);
+        ok = (fclose(out) == 0) && ok;
+        ok = ok && replaceFile(tempPath, tableFiles[table]);
+        if (!ok) remove(tempPath);
+    }
+    closeTable(writers);
+    if (!ok) return -1;
+
+    markTableSynced(table);
+    return 1;
+}
+
+// Appends one line to an append-only table and bumps its version header in place.
+// Same return convention as writeTableFile.
+int appendTableLine(TableID table, const char *line, int expectedVersion) {
+    int diskVersion, hasHeader;
+    FILE *writers;
+    FILE *fp = openTableForWrite(table, &writers, &diskVersion, &hasHeader);
+    if (fp == NULL) return -1;
+
+    if (diskVersion != expectedVersion) {
+        closeTable(fp);
+        closeTable(writers);
+        return 0;
+    }
+
+    if (hasHeader) {
+        fseek(fp, 0, SEEK_END);
+        fputs(line, fp);
+        fseek(fp, 0, SEEK_SET); // The header is fixed-width, so it can be overwritten in place
+        fprintf(fp, VERSION_HEADER_FORMAT, expectedVersion + 1);
+    } else {
+        // Older file without a header: rewrite it once with one in front
+        TextBuffer existing = {0};
+        char chunk[MAX_LINE_LENGTH];
+        rewind(fp);
+        while (fgets(chunk, MAX_LINE_LENGTH, fp)) tbAppendf(&existing, "%s", chunk);
+        rewind(fp);
+        truncateFile(fp);
+        fprintf(fp, VERSION_HEADER_FORMAT, expectedVersion + 1);
+        if (existing.data) fputs(existing.data, fp);
+        fputs(line, fp);
+        free(existing.data);
+    }
+    noteTableWrite(table, fp);
+    closeTable(fp);
+    closeTable(writers);
+
+    tableVersions[table] = expectedVersion + 1;
+    markTableSynced(table);
+    return 1;
+}
+
+// Remembers that a record was added, changed or deleted locally, so a stale
+// save can replay just these records on top of the newer file
+void markRecordDirty(TableID table, const char *key) {
+    DirtySet *set = &dirtyRecords[table];
+    for (int i = 0; i < set->count; i++) {
+        if (strcmp(set->keys[i], key) == 0) return;
+    }
+    if (set->count >= MAX_DIRTY_KEYS) {
+        set->overflow = 1;
+        return;
+    }
+    strncpy(set->keys[set->count], key, MAX_ID_LENGTH - 1);
+    set->keys[set->count][MAX_ID_LENGTH - 1] = '\0';
+    set->count++;
+}
+
+// --- RECORD TABLE ENGINE ---
+// Students, courses and faculty are all "array tables": a fixed array of
+// records, one comma-separated line per record in a .dat file, key first.
+// Each one is described once by its field list (see DATA STRUCTURES), and the
+// macros below expand that list into the struct, a straight-line line parser
+// and line formatter per table, and a RecordSchema the generic code (loading,
+// merging, saving, snapshots, key filters, indexes, queries and the admin
+// record editor) works from. Adding a table means adding a field list, a
+// RECORD_TABLES entry and a TableID with its file and name.
+//
+// Per-field work is picked by the field's kind at compile time: the generated
+// parse and format loops call parseStringField, parseIntField and so on
+// directly, so loading or saving a table never switches on field types.
+
+// Splits the next comma-separated field off the line, or returns NULL past its
+// end. Unlike strtok an empty field comes back as "", so an optional field
+// left blank keeps the fields after it in their columns.
+static char* nextLineField(char **cursor) {
+    char *field = *cursor;
+    if (field == NULL) return NULL;
+    char *comma = strchr(field, ',');
+    if (comma) *comma = '\0';
+    *cursor = comma ? comma + 1 : NULL;
+    return field;
+}
+
+// strtok without its hidden state: skips runs of 'delimiter' the same way,
+// but can be used by parsers running on several threads at once
+static char* nextToken(char **cursor, char delimiter) {
+    char *token = *cursor;
+    if (token == NULL) return NULL;
+    while (*token == delimiter) token++;
+    if (*token == '\0') {
+        *cursor = NULL;
+        return NULL;
+    }
+    char *end = strchr(token, delimiter);
+    if (end) *end = '\0';
+    *cursor = end ? end + 1 : NULL;
+    return token;
+}
+
+// Typed field routines. 'token' is NULL past the end of the line; a parser
+// returns 0 when a required field is missing (the line is skipped).
+static int parseStringField(char *token, void *dst, size_t size) {
+    if (token == NULL) return 0;
+    normalizeString(token);
+    snprintf((char *)dst, size, "%s", token);
+    return 1;
+}
+
+static int parseIntField(char *token, void *dst, size_t size) {
+    (void)size;
+    if (token == NULL) return 0;
+    *(int *)dst = atoi(token);
+    return 1;
+}
+
+// Optional: older lines end before the semester or the course lists
+static int parseOptionalField(char *token, void *dst, size_t size) {
+    ((char *)dst)[0] = '\0';
+    if (token) parseStringField(token, dst, size);
+    return 1;
+}
+
+// A formatter returns 0 when its field may be left off the end of the line
+static int formatStringField(TextBuffer *tb, const void *value, int first) {
+    tbAppendf(tb, first ? "%s" : ",%s", (const char *)value);
+    return 1;
+}
+
+static int formatIntField(TextBuffer *tb, const void *value, int first) {
+    tbAppendf(tb, first ? "%d" : ",%d", *(const int *)value);
+    return 1;
+}
+
+static int parseOptionalIntField(char *token, void *dst, size_t size) {
+    *(int *)dst = 0;
+    if (token) parseIntField(token, dst, size);
+    return 1;
+}
+
+// Empty optional fields at the end of a line are trimmed, so records without
+// them are written exactly as they were before those fields existed
+static int formatOptionalField(TextBuffer *tb, const void *value, int first) {
+    formatStringField(tb, value, first);
+    return ((const char *)value)[0] != '\0';
+}
+
+static int formatOptionalIntField(TextBuffer *tb, const void *value, int first) {
+    formatIntField(tb, value, first);
+    return *(const int *)value != 0;
+}
+
+// GPAs are written with two decimals ("8.75") and held as hundredths (875).
+// A student without one holds GPA_NONE, so 0.00 stays an ordinary GPA.
+#define GPA_SCALE 100
+#define GPA_MAX (10 * GPA_SCALE)
+#define GPA_NONE -1
+
+static int hasGpa(int gpa) {
+    return gpa >= 0 && gpa <= GPA_MAX;
+}
+
+int parseGpa(const char *text, int *out) {
+    char *end;
+    double value = strtod(text, &end);
+    if (end == text) return 0;
+    while (isspace((unsigned char)*end)) end++;
+    if (*end != '\0' || value < 0 || value > GPA_MAX / (double)GPA_SCALE) return 0;
+    *out = (int)(value * GPA_SCALE + 0.5);
+    return 1;
+}
+
+// Blank when no GPA is recorded
+void formatGpa(int gpa, char *out, size_t size) {
+    if (!hasGpa(gpa)) snprintf(out, size, "%s", "");
+    else snprintf(out, size, "%d.%02d", gpa / GPA_SCALE, gpa % GPA_SCALE);
+}
+
+static int parseGpaField(char *token, void *dst, size_t size) {
+    (void)size;
+    *(int *)dst = GPA_NONE;
+    if (token) {
+        normalizeString(token);
+        if (token[0] != '\0' && !parseGpa(token, (int *)dst)) *(int *)dst = GPA_NONE;
+    }
+    return 1;
+}
+
+static int formatGpaField(TextBuffer *tb, const void *value, int first) {
+    char text[16];
+    formatGpa(*(const int *)value, text, sizeof(text));
+    tbAppendf(tb, first ? "%s" : ",%s", text);
+    return text[0] != '\0';
+}
+
+#define parseSemesterField parseOptionalField
+#define formatSemesterField formatOptionalField
+#define parseCourseListField parseOptionalField
+#define formatCourseListField formatOptionalField
+
+#define FIELD_TYPE_String FIELD_STRING
+#define FIELD_TYPE_Int FIELD_INT
+#define FIELD_TYPE_Semester FIELD_SEMESTER
+#define FIELD_TYPE_CourseList FIELD_COURSE_LIST
+#define FIELD_TYPE_OptionalInt FIELD_INT
+#define FIELD_TYPE_Gpa FIELD_GPA
+
+#define PARSE_RECORD_FIELD(ctx, kind, member, size, name, header, prompt)           \
+    if (!parse##kind##Field(nextLineField(&cursor), &out->member, sizeof(out->member))) return 0;
+#define FORMAT_RECORD_FIELD(ctx, kind, member, size, name, header, prompt)          \
+    if (format##kind##Field(tb, &row->member, offsetof(ctx, member) == 0)) kept = tb->length;
+#define DESCRIBE_RECORD_FIELD(ctx, kind, member, size, name, header, prompt)        \
+    { name, FIELD_TYPE_##kind, offsetof(ctx, member), sizeof(((ctx *)0)->member), header, prompt },
+
+// Expands to parse<Type>Line, parse<Type>File and serialize<Type>s, untyped
+// adapters for the schema, and the <prefix>Fields descriptor array
+#define DEFINE_RECORD_CODEC(Type, prefix, rows, table, FIELDS, view, onAdd)                  \
+    int parse##Type##Line(char *line, Type *out) {                                           \
+        char *cursor = line;                                                                 \
+        FIELDS(PARSE_RECORD_FIELD, Type)                                                     \
+        return 1;                                                                            \
+    }                                                                                        \
+    int parse##Type##File(const char *path, Type *dst, int max, int *version) {              \
+        FILE *fp = openTableForRead(path);                                                   \
+        if (!fp) return -1;                                                                  \
+        int count = 0;                                                                       \
+        char line[MAX_LINE_LENGTH];                                                          \
+        *version = 0;                                                                        \
+        while (fgets(line, MAX_LINE_LENGTH, fp) && count < max) {                            \
+            if (isHeaderLine(line, version)) continue;                                       \
+            if (parse##Type##Line(line, &dst[count])) count++;                               \
+        }                                                                                    \
+        closeTable(fp);                                                                      \
+        return count;                                                                        \
+    }                                                                                        \
+    void serialize##Type##s(const Type *records, int count, TextBuffer *tb) {                \
+        for (int i = 0; i < count; i++) {                                                    \
+            const Type *row = &records[i];                                                   \
+            size_t kept = tb->length;                                                        \
+            FIELDS(FORMAT_RECORD_FIELD, Type)                                                \
+            tb->length = kept; /* Drops trailing empty optional fields */                    \
+            tbAppendBytes(tb, "\n", 1);                                                      \
+        }                                                                                    \
+    }                                                                                        \
+    static int parse##Type##Row(char *line, void *out) {                                     \
+        return parse##Type##Line(line, (Type *)out);                                         \
+    }                                                                                        \
+    static int parse##Type##Rows(const char *path, void *dst, int max, int *version) {       \
+        return parse##Type##File(path, (Type *)dst, max, version);                           \
+    }                                                                                        \
+    static void serialize##Type##Rows(const void *records, int count, TextBuffer *tb) {      \
+        serialize##Type##s((const Type *)records, count, tb);                                \
+    }                                                                                        \
+    static const RecordField prefix##Fields[] = { FIELDS(DESCRIBE_RECORD_FIELD, Type) };
+RECORD_TABLES(DEFINE_RECORD_CODEC)
+
+#define RECORD_SCHEMA_ENTRY(Type, prefix, rows, table, FIELDS, view, onAdd)                  \
+    { table, #rows, sizeof(Type), rows, &prefix##Count,                                      \
+      prefix##Fields, (int)(sizeof(prefix##Fields) / sizeof(prefix##Fields[0])), view, onAdd, \
+      parse##Type##Row, parse##Type##Rows, serialize##Type##Rows },
+static const RecordSchema recordSchemas[] = { RECORD_TABLES(RECORD_SCHEMA_ENTRY) };
+#define RECORD_TABLE_COUNT ((int)(sizeof(recordSchemas) / sizeof(recordSchemas[0])))
+
+// The schema of an array table, or NULL for locations and notices
+const RecordSchema* recordSchema(TableID table) {
+    for (int i = 0; i < RECORD_TABLE_COUNT; i++) {
+        if (recordSchemas[i].table == table) return &recordSchemas[i];
+    }
+    return NULL;
+}
+
+const RecordSchema* recordSchemaNamed(const char *rowsName) {
+    for (int i = 0; i < RECORD_TABLE_COUNT; i++) {
+        if (strcmp(recordSchemas[i].rowsName, rowsName) == 0) return &recordSchemas[i];
+    }
+    return NULL;
+}
+
+// Formats one field of a row for listings and query output
+static const char* formatRecordCell(const RecordField *field, const void *row, char *out, size_t size) {
+    const char *value = (const char *)row + field->offset;
+    if (field->type == FIELD_GPA) {
+        formatGpa(*(const int *)value, out, size);
+        return out;
+    }
+    if (field->type != FIELD_INT) return value;
+    snprintf(out, size, "%d", *(const int *)value);
+    return out;
+}
+
+// --- LAZY TABLE LOADING ---
+// Nothing is read at startup. Each table is faulted in the first time a menu
+// calls ensureTableLoaded(), and once someone logs in a background thread
+// prefetches the rest, so the login prompt appears at once whatever the data size.
+// The prefetch thread only parses files into staging copies (see HOT RELOAD);
+// the live arrays, statistics and snapshots are written by the menu thread alone.
+
+static atomic_int tablesLoaded[TABLE_COUNT];
+static int prefetchStarted = 0;
+
+void initLazyLoading() {
+    for (int t = 0; t < TABLE_COUNT; t++) atomic_init(&tablesLoaded[t], 0);
+}
+
+int isTableLoaded(TableID table) {
+    return atomic_load(&tablesLoaded[table]);
+}
+
+void markTableLoaded(TableID table) {
+    atomic_store(&tablesLoaded[table], 1);
+}
+
+static void loadTable(TableID table) {
+    const RecordSchema *schema = recordSchema(table);
+    if (schema) {
+        int count = schema->parseFile(tableFiles[table], schema->rows, MAX_RECORDS, &tableVersions[table]);
+        *schema->count = count < 0 ? 0 : count;
+    } else if (table == TABLE_LOCATIONS) {
+        loadLocationData(); // Loads locations into Hash Table
+    } else if (table == TABLE_NOTICES) {
+        loadNotices();
+    }
+    if (table != TABLE_LOCATIONS) { // loadLocationData does these itself
+        rebuildKeyFilter(table);
+        rebuildTableStats(table);
+        rebuildRequisiteGraph(table);
+        syncCourseSeats(table);
+        publishTable(table);
+    }
+    markTableSynced(table);
+}
+
+// Loads a table on first use (menu thread only). A copy the prefetch thread
+// has already parsed is installed instead of reading the file again.
+void ensureTableLoaded(TableID table) {
+    if (isTableLoaded(table)) return;
+    if (!adoptPrefetchedTable(table)) loadTable(table);
+    markTableLoaded(table);
+}
+
+// Loads records from all data files into memory arrays
+void loadAllRecords() {
+    for (int t = 0; t < TABLE_COUNT; t++) ensureTableLoaded((TableID)t);
+}
+
+THREAD_FUNC(prefetchThreadMain, arg) {
+    (void)arg;
+    for (int t = 0; t < TABLE_COUNT; t++) stageTablePrefetch((TableID)t);
+    THREAD_RETURN;
+}
+
+// Called after a successful login: parse every table while the user reads the
+// menu. The next menu boundary (applyPendingReloads) installs what is ready.
+void startBackgroundPrefetch() {
+    if (prefetchStarted) return;
+    prefetchStarted = 1;
+
+    Thread prefetcher;
+    if (threadStart(&prefetcher, prefetchThreadMain, NULL)) {
+        threadDetach(prefetcher);
+    }
+}
+
+// Finds a row by key in an array table (every record type stores its key first)
+static int findRowByKey(void *rows, size_t rowSize, int count, const char *key) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp((const char *)rows + i * rowSize, key) == 0) return i;
+    }
+    return -1;
+}
+
+// Another instance wrote the table since we loaded it: adopt the newer file and
+// replay only our own dirty records on top, so neither side's edits are lost
+void mergeStaleArrayTable(TableID table) {
+    const RecordSchema *schema = recordSchema(table);
+    if (schema == NULL) return;
+    void *rows = schema->rows;
+    size_t rowSize = schema->rowSize;
+    int *count = schema->count;
+
+    void *disk = malloc(rowSize * MAX_RECORDS);
+    if (disk == NULL) return;
+    int diskVersion = 0;
+    int diskCount = schema->parseFile(tableFiles[table], disk, MAX_RECORDS, &diskVersion);
+
+    DirtySet *set = &dirtyRecords[table];
+    if (diskCount >= 0 && set->overflow) {
+        printf("Warning: Too many local edits to merge; %s records from another instance will be overwritten.\n", tableNames[table]);
+    } else if (diskCount >= 0) {
+        for (int k = 0; k < set->count; k++) {
+            int ours = findRowByKey(rows, rowSize, *count, set->keys[k]);
+            int theirs = findRowByKey(disk, rowSize, diskCount, set->keys[k]);
+            if (ours >= 0 && theirs >= 0) {
+                memcpy((char *)disk + theirs * rowSize, (char *)rows + ours * rowSize, rowSize);
+            } else if (ours >= 0 && diskCount < MAX_RECORDS) {
+                memcpy((char *)disk + diskCount * rowSize, (char *)rows + ours * rowSize, rowSize);
+                diskCount++;
+            } else if (ours < 0 && theirs >= 0) {
+                memmove((char *)disk + theirs * rowSize, (char *)disk + (theirs + 1) * rowSize,
+                        (diskCount - theirs - 1) * rowSize);
+                diskCount--;
+            }
+        }
+        memcpy(rows, disk, rowSize * diskCount);
+        *count = diskCount;
+        rebuildKeyFilter(table);
+        rebuildTableStats(table);
+        rebuildRequisiteGraph(table);
+        syncCourseSeats(table);
+        printf("(%s records were changed by another instance; your edits were merged.)\n", tableNames[table]);
+    }
+    tableVersions[table] = diskVersion;
+    free(disk);
+}
+
+// Snapshots an array table for the persistence thread and republishes it.
+// A newer on-disk copy is merged later, at a menu boundary (see applyPersistResults).
+void saveRecordTable(TableID table) {
+    const RecordSchema *schema = recordSchema(table);
+    if (schema == NULL) return;
+    TextBuffer body = {0};
+    schema->serialize(schema->rows, *schema->count, &body);
+    queueTableWrite(table, &body);
+    publishTable(table);
+    if (schema->view >= 0) invalidateView((ViewID)schema->view);
+}
+
+// --- CAMPUS SHARDS (ONE DATA DIRECTORY PER CAMPUS) ---
+// Each campus keeps a complete data set of its own in db/campuses/<name>/,
+// with the names listed in db/campuses.dat. '--campus <name>' points every
+// table path at that shard before anything is read, so a kiosk only ever
+// loads, locks, indexes and watches its own campus. Without the flag the
+// application works on db/ exactly as before. '--campus all' is only
+// meaningful for --query, which scans every shard in parallel (see FILTER QUERIES).
+
+#define CAMPUSES_FILE DB_DIRECTORY "/campuses.dat"
+#define CAMPUS_DIRECTORY DB_DIRECTORY "/campuses"
+#define MAX_CAMPUSES 32
+
+// Points all table, index and log paths at 'directory'
+void useDataDirectory(const char *directory) {
+    snprintf(dataDirectory, sizeof(dataDirectory), "%s", directory);
+    for (int t = 0; t < TABLE_COUNT; t++) {
+        snprintf(tableFiles[t], MAX_LINE_LENGTH, "%s/%s", dataDirectory, tableFileNames[t]);
+    }
+    snprintf(usersFile, sizeof(usersFile), "%s/users.dat", dataDirectory);
+}
+
+void campusDirectory(const char *campus, char *out, size_t size) {
+    snprintf(out, size, "%s/%s", CAMPUS_DIRECTORY, campus);
+}
+
+// Campus names become directory names: letters, digits, '-' and '_' only
+int isValidCampusName(const char *name) {
+    size_t length = strlen(name);
+    if (length == 0 || length >= MAX_ID_LENGTH) return 0;
+    for (size_t i = 0; i < length; i++) {
+        if (!isalnum((unsigned char)name[i]) && name[i] != '-' && name[i] != '_') return 0;
+    }
+    return strcmp(name, "all") != 0;
+}
+
+// Reads the registry (one campus name per line); returns how many were found
+int loadCampusList(char campuses[][MAX_ID_LENGTH], int max) {
+    FILE *fp = fopen(CAMPUSES_FILE, "r");
+    if (fp == NULL) return 0;
+    int count = 0;
+    char line[MAX_LINE_LENGTH];
+    while (count < max && fgets(line, sizeof(line), fp) != NULL) {
+        if (line[0] == '#') continue;
+        normalizeString(line);
+        if (isValidCampusName(line)) strcpy(campuses[count++], line);
+    }
+    fclose(fp);
+    return count;
+}
+
+static int isRegisteredCampus(const char *name) {
+    char campuses[MAX_CAMPUSES][MAX_ID_LENGTH];
+    int count = loadCampusList(campuses, MAX_CAMPUSES);
+    for (int c = 0; c < count; c++) {
+        if (strcmp(campuses[c], name) == 0) return 1;
+    }
+    return 0;
+}
+
+// Switches the process to one campus's shard; must run before any table is loaded
+int selectCampus(const char *name) {
+    char directory[MAX_LINE_LENGTH];
+    if (!isValidCampusName(name) || !isRegisteredCampus(name)) {
+        printf("Error: Unknown campus '%s' (see %s).\n", name, CAMPUSES_FILE);
+        return 0;
+    }
+    campusDirectory(name, directory, sizeof(directory));
+    if (strlen(directory) >= sizeof(dataDirectory)) {
+        printf("Error: Campus path %s is too long.\n", directory);
+        return 0;
+    }
+    useDataDirectory(directory);
+    strcpy(campusName, name);
+    return 1;
+}
+
+static int makeDirectory(const char *path) {
+#ifdef _WIN32
+    int result = _mkdir(path);
+#else
+    int result = mkdir(path, 0755);
+#endif
+    return result == 0 || errno == EEXIST;
+}
+
+// Creates an empty shard (admin accounts are copied from db/users.dat) and registers it
+int addCampus(const char *name) {
+    char directory[MAX_LINE_LENGTH], path[MAX_LINE_LENGTH * 2], line[MAX_LINE_LENGTH];
+    if (!isValidCampusName(name)) {
+        printf("Error: Campus names use letters, digits, '-' and '_' (max %d characters).\n", MAX_ID_LENGTH - 1);
+        return 0;
+    }
+    if (isRegisteredCampus(name)) {
+        printf("Error: Campus '%s' already exists.\n", name);
+        return 0;
+    }
+    campusDirectory(name, directory, sizeof(directory));
+    if (!makeDirectory(CAMPUS_DIRECTORY) || !makeDirectory(directory)) {
+        printf("Error: Could not create %s.\n", directory);
+        return 0;
+    }
+
+    for (int t = 0; t < TABLE_COUNT; t++) {
+        snprintf(path, sizeof(path), "%s/%s", directory, tableFileNames[t]);
+        FILE *probe = fopen(path, "r");
+        if (probe) { // Keep whatever is already there
+            fclose(probe);
+            continue;
+        }
+        FILE *fp = fopen(path, "w");
+        if (fp == NULL) {
+            printf("Error: Could not create %s.\n", path);
+            return 0;
+        }
+        fprintf(fp, VERSION_HEADER_FORMAT, 1);
+        if (t == TABLE_LOCATIONS) {
+            fprintf(fp, "# Location Data File\n# Format: key;building;floor;room;description[;x,y[,level]]\n");
+        } else if (t == TABLE_NOTICES) {
+            fprintf(fp, "# Academic Calendar File (append-only)\n");
+        }
+        fclose(fp);
+    }
+
+    snprintf(path, sizeof(path), "%s/users.dat", directory);
+    FILE *users = fopen(DB_DIRECTORY "/users.dat", "r");
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) {
+        printf("Error: Could not create %s.\n", path);
+        if (users) fclose(users);
+        return 0;
+    }
+    while (users && fgets(line, sizeof(line), users) != NULL) {
+        char copy[MAX_LINE_LENGTH];
+        strcpy(copy, line);
+        normalizeString(copy);
+        size_t length = strlen(copy);
+        if (length > 6 && strcmp(copy + length - 6, ",admin") == 0) fprintf(fp, "%s\n", copy);
+    }
+    if (users) fclose(users);
+    fclose(fp);
+
+    FILE *registry = fopen(CAMPUSES_FILE, "a");
+    if (registry == NULL) {
+        printf("Error: Could not update %s.\n", CAMPUSES_FILE);
+        return 0;
+    }
+    fprintf(registry, "%s\n", name);
+    fclose(registry);
+    printf("Campus '%s' created in %s.\n", name, directory);
+    return 1;
+}
+
+// --- KEY FILTERS (BLOOM) ---
+// Each keyed table keeps a Bloom filter of its keys, so the common "does this
+// key exist?" miss (a new ID checked for uniqueness, a mistyped location key,
+// an unknown login name) is answered from a few bits without scanning the
+// table or opening the file. A "maybe" still goes to the real lookup. Keys are
+// added as records are inserted; bits cannot be cleared, so a filter is rebuilt
+// from its table on load, reload and merge, after deletes, and when it grows
+// past the size it was built for.
+
+static BloomFilter keyFilters[TABLE_COUNT];
+static BloomFilter userFilter;                 // Login names in users.dat
+static long long userFilterMtime = -1, userFilterSize = -1;
+
+// FNV-1a, then a second hash derived from it for double hashing
+static void bloomHashes(const char *key, uint64_t *h1, uint64_t *h2) {
+    uint64_t h = 1469598103934665603ULL;
+    for (const unsigned char *p = (const unsigned char *)key; *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ULL;
+    }
+    uint64_t mixed = (h ^ (h >> 31)) * 0x9E3779B97F4A7C15ULL;
+    *h1 = h;
+    *h2 = (mixed ^ (mixed >> 29)) | 1;
+}
+
+// Empties the filter and sizes it for 'expectedKeys' (with room to grow)
+void bloomReset(BloomFilter *filter, int expectedKeys) {
+    int capacity = expectedKeys * 2 < 64 ? 64 : expectedKeys * 2;
+    uint32_t bitCount = (uint32_t)(((uint64_t)capacity * BLOOM_BITS_PER_KEY + 63) / 64 * 64);
+    if (bitCount != filter->bitCount || filter->bits == NULL) {
+        uint64_t *bits = (uint64_t *)realloc(filter->bits, bitCount / 8);
+        if (bits == NULL) {
+            free(filter->bits);
+            memset(filter, 0, sizeof(*filter)); // No filter: every key "may exist"
+            return;
+        }
+        filter->bits = bits;
+        filter->bitCount = bitCount;
+    }
+    memset(filter->bits, 0, filter->bitCount / 8);
+    filter->keys = 0;
+    filter->capacity = capacity;
+}
+
+void bloomAdd(BloomFilter *filter, const char *key) {
+    if (filter->bits == NULL) return;
+    uint64_t h1, h2;
+    bloomHashes(key, &h1, &h2);
+    for (int i = 0; i < BLOOM_HASHES; i++) {
+        uint32_t bit = (uint32_t)((h1 + (uint64_t)i * h2) % filter->bitCount);
+        filter->bits[bit / 64] |= 1ULL << (bit % 64);
+    }
+    filter->keys++;
+}
+
+// 0 means the key is definitely absent; 1 means look it up
+int bloomMayContain(const BloomFilter *filter, const char *key) {
+    if (filter->bits == NULL) return 1;
+    uint64_t h1, h2;
+    bloomHashes(key, &h1, &h2);
+    for (int i = 0; i < BLOOM_HASHES; i++) {
+        uint32_t bit = (uint32_t)((h1 + (uint64_t)i * h2) % filter->bitCount);
+        if (!(filter->bits[bit / 64] & (1ULL << (bit % 64)))) return 0;
+    }
+    return 1;
+}
+
+// Rebuilds a table's filter from its working copy
+void rebuildKeyFilter(TableID table) {
+    BloomFilter *filter = &keyFilters[table];
+    const RecordSchema *schema = recordSchema(table);
+    if (schema) {
+        bloomReset(filter, *schema->count);
+        for (int i = 0; i < *schema->count; i++) bloomAdd(filter, (const char *)schema->rows + i * schema->rowSize);
+        return;
+    }
+    switch (table) {
+        case TABLE_LOCATIONS: {
+            int count = (int)hashTable.nodes.liveObjects;
+            bloomReset(filter, count);
+            for (int i = 0; i < HASH_SIZE; i++) {
+                for (LocationNode *node = hashTable.buckets[i]; node; node = node->next) bloomAdd(filter, node->key);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Records an inserted key; the key must already be in the working table
+void keyFilterAdd(TableID table, const char *key) {
+    BloomFilter *filter = &keyFilters[table];
+    if (filter->keys >= filter->capacity) {
+        rebuildKeyFilter(table); // Past its sizing the false-positive rate climbs
+    } else {
+        bloomAdd(filter, key);
+    }
+}
+
+int keyMayExist(TableID table, const char *key) {
+    return bloomMayContain(&keyFilters[table], key);
+}
+
+// Filters login names, rebuilding from users.dat whenever the file changes
+int loginMayExist(const char *username) {
+    struct stat st;
+    if (stat(usersFile, &st) != 0) return 1; // Let the login report the missing file
+    if ((long long)st.st_mtime != userFilterMtime || (long long)st.st_size != userFilterSize) {
+        FILE *fp = fopen(usersFile, "r");
+        if (fp == NULL) return 1;
+        char line[MAX_LINE_LENGTH];
+        int lines = 0;
+        while (fgets(line, MAX_LINE_LENGTH, fp)) lines++;
+        bloomReset(&userFilter, lines);
+        rewind(fp);
+        while (fgets(line, MAX_LINE_LENGTH, fp)) {
+            char *comma = strchr(line, ',');
+            if (comma == NULL) continue;
+            *comma = '\0';
+            bloomAdd(&userFilter, line);
+        }
+        fclose(fp);
+        userFilterMtime = (long long)st.st_mtime;
+        userFilterSize = (long long)st.st_size;
+    }
+    return bloomMayContain(&userFilter, username);
+}
+
+// Self-check: false-positive rate and probe cost against a linear key scan
+int benchmarkKeyFilter(int keys) {
+    char (*present)[MAX_ID_LENGTH] = malloc(sizeof(*present) * (size_t)keys);
+    if (present == NULL) return 0;
+    BloomFilter filter = {0};
+    bloomReset(&filter, keys / 2); // Filled to capacity, the worst case it is allowed to reach
+    for (int i = 0; i < keys; i++) {
+        snprintf(present[i], MAX_ID_LENGTH, "K%07d", i);
+        bloomAdd(&filter, present[i]);
+    }
+
+    int missing = 0, falsePositives = 0;
+    char probe[MAX_ID_LENGTH];
+    for (int i = 0; i < keys; i++) {
+        if (!bloomMayContain(&filter, present[i])) missing++;
+    }
+    double started = monotonicMillis();
+    for (int i = 0; i < keys; i++) {
+        snprintf(probe, sizeof(probe), "M%07d", i);
+        if (bloomMayContain(&filter, probe)) falsePositives++;
+    }
+    double filterMillis = monotonicMillis() - started;
+
+    int scans = keys < 1000 ? keys : 1000, found = 0;
+    started = monotonicMillis();
+    for (int i = 0; i < scans; i++) {
+        snprintf(probe, sizeof(probe), "M%07d", i);
+        for (int k = 0; k < keys; k++) {
+            if (strcmp(present[k], probe) == 0) { found++; break; }
+        }
+    }
+    double scanMillis = monotonicMillis() - started;
+
+    printf("%d keys in %u bits (%d hashes): %d false negatives, %.2f%% false positives.\n",
+           keys, filter.bitCount, BLOOM_HASHES, missing, 100.0 * falsePositives / keys);
+    printf("Absent-key check: %.3f us with the filter, %.3f us scanning the keys.\n",
+           filterMillis * 1000.0 / keys, scanMillis * 1000.0 / scans);
+    free(filter.bits);
+    free(present);
+    return missing == 0 && found == 0;
+}
+
+// --- STATISTICS DASHBOARD (INCREMENTAL COUNTERS) ---
+// The dashboard's breakdowns (students per program, courses per credit value,
+// faculty per department, locations per building) are histograms kept up to
+// date as records change: each add, update or delete moves one count, found
+// through a small hash table, so showing or exporting them never rescans a
+// table. Loads, reloads and merges replace a table wholesale and recount it.
+
+typedef struct StatsBreakdown {
+    TableID table;
+    RecordField field;           // What the table is grouped by
+    const char *title;
+    const char *jsonKey;
+} StatsBreakdown;
+
+static const StatsBreakdown statsBreakdowns[] = {
+    { TABLE_STUDENTS, { "program", FIELD_STRING, offsetof(Student, program), MAX_NAME_LENGTH, "Program", NULL },
+      "Headcount per Program", "students_per_program" },
+    { TABLE_FACULTY, { "department", FIELD_STRING, offsetof(Faculty, department), MAX_NAME_LENGTH, "Department", NULL },
+      "Faculty per Department", "faculty_per_department" },
+    { TABLE_COURSES, { "credits", FIELD_INT, offsetof(Course, credits), sizeof(int), "Credits", NULL },
+      "Course Credit Distribution", "courses_per_credits" },
+    { TABLE_LOCATIONS, { "building", FIELD_STRING, offsetof(LocationNode, building), MAX_NAME_LENGTH, "Building", NULL },
+      "Locations per Building", "locations_per_building" }
+};
+#define STATS_BREAKDOWN_COUNT ((int)(sizeof(statsBreakdowns) / sizeof(statsBreakdowns[0])))
+
+static Histogram tableStats[TABLE_COUNT];
+
+static const StatsBreakdown* breakdownFor(TableID table) {
+    for (int i = 0; i < STATS_BREAKDOWN_COUNT; i++) {
+        if (statsBreakdowns[i].table == table) return &statsBreakdowns[i];
+    }
+    return NULL;
+}
+
+static void histogramReset(Histogram *histogram) {
+    if (histogram->buckets) memset(histogram->buckets, 0, sizeof(HistogramBucket) * histogram->capacity);
+    histogram->used = 0;
+    histogram->total = 0;
+}
+
+// Slot holding 'value', or the empty slot where it belongs
+static HistogramBucket* histogramSlot(HistogramBucket *buckets, int capacity, const char *value) {
+    uint64_t h1, h2;
+    bloomHashes(value, &h1, &h2);
+    int mask = capacity - 1;
+    for (int i = (int)(h1 & (uint64_t)mask); ; i = (i + 1) & mask) {
+        if (buckets[i].value[0] == '\0' || strcmp(buckets[i].value, value) == 0) return &buckets[i];
+    }
+}
+
+// Doubles the table once it is half full, so probes stay short
+static int histogramGrow(Histogram *histogram) {
+    int capacity = histogram->capacity ? histogram->capacity * 2 : 16;
+    HistogramBucket *buckets = (HistogramBucket *)calloc(capacity, sizeof(HistogramBucket));
+    if (buckets == NULL) return 0;
+    for (int i = 0; i < histogram->capacity; i++) {
+        if (histogram->buckets[i].value[0] != '\0') {
+            *histogramSlot(buckets, capacity, histogram->buckets[i].value) = histogram->buckets[i];
+        }
+    }
+    free(histogram->buckets);
+    histogram->buckets = buckets;
+    histogram->capacity = capacity;
+    return 1;
+}
+
+static void histogramAdd(Histogram *histogram, const char *value, int delta) {
+    if (value[0] == '\0') value = "(none)";
+    if ((histogram->used + 1) * 2 > histogram->capacity && !histogramGrow(histogram)) return;
+    HistogramBucket *bucket = histogramSlot(histogram->buckets, histogram->capacity, value);
+    if (bucket->value[0] == '\0') {
+        snprintf(bucket->value, sizeof(bucket->value), "%s", value);
+        histogram->used++;
+    }
+    bucket->count += delta;
+    histogram->total += delta;
+}
+
+// Counts 'row' (a record, or a LocationNode for TABLE_LOCATIONS) in or out
+void statsRowChanged(TableID table, const void *row, int delta) {
+    if (table == TABLE_STUDENTS) rankRowChanged((const Student *)row, delta);
+    const StatsBreakdown *breakdown = breakdownFor(table);
+    if (breakdown == NULL) return;
+    char number[16];
+    histogramAdd(&tableStats[table], formatRecordCell(&breakdown->field, row, number, sizeof(number)), delta);
+}
+
+// Recounts a table from its working copy after it was replaced wholesale
+void rebuildTableStats(TableID table) {
+    if (table == TABLE_STUDENTS) resetClassRanks(); // Refilled by the statsRowChanged calls below
+    if (breakdownFor(table) == NULL) return;
+    histogramReset(&tableStats[table]);
+    const RecordSchema *schema = recordSchema(table);
+    if (schema) {
+        for (int i = 0; i < *schema->count; i++) statsRowChanged(table, (const char *)schema->rows + i * schema->rowSize, 1);
+    } else if (table == TABLE_LOCATIONS) {
+        for (int i = 0; i < HASH_SIZE; i++) {
+            for (LocationNode *node = hashTable.buckets[i]; node; node = node->next) statsRowChanged(table, node, 1);
+        }
+    }
+}
+
+// Largest count first; numeric breakdowns (credits) in value order instead
+static int compareBucketsByCount(const void *a, const void *b) {
+    const HistogramBucket *x = *(const HistogramBucket *const *)a, *y = *(const HistogramBucket *const *)b;
+    if (x->count != y->count) return y->count - x->count;
+    return strcmp(x->value, y->value);
+}
+
+static int compareBucketsByNumber(const void *a, const void *b) {
+    const HistogramBucket *x = *(const HistogramBucket *const *)a, *y = *(const HistogramBucket *const *)b;
+    return atoi(x->value) - atoi(y->value);
+}
+
+// Fills 'out' with the non-empty buckets in display order; returns how many.
+// The caller frees 'out'.
+static int sortedBuckets(const StatsBreakdown *breakdown, const HistogramBucket ***out) {
+    const Histogram *histogram = &tableStats[breakdown->table];
+    const HistogramBucket **list = (const HistogramBucket **)malloc(sizeof(HistogramBucket *) * (histogram->used + 1));
+    int count = 0;
+    *out = list;
+    if (list == NULL) return 0;
+    for (int i = 0; i < histogram->capacity; i++) {
+        if (histogram->buckets[i].count > 0) list[count++] = &histogram->buckets[i];
+    }
+    qsort(list, count, sizeof(*list), breakdown->field.type == FIELD_INT ? compareBucketsByNumber : compareBucketsByCount);
+    return count;
+}
+
+static void writeJsonString(FILE *out, const char *text) {
+    fputc('"', out);
+    for (const unsigned char *c = (const unsigned char *)text; *c; c++) {
+        if (*c == '"' || *c == '\\') fprintf(out, "\\%c", *c);
+        else if (*c < 0x20) fprintf(out, "\\u%04x", *c);
+        else fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+// Records in a table; tables without a breakdown are not counted as they change
+static int tableTotal(TableID table) {
+    const RecordSchema *schema = recordSchema(table);
+    if (table == TABLE_NOTICES) return noticeCount;
+    if (breakdownFor(table) == NULL && schema) return *schema->count;
+    return tableStats[table].total;
+}
+
+// Totals and every breakdown as one JSON object
+void writeStatsJson(FILE *out) {
+    char today[16];
+    formatDate(todayDate(), today, sizeof(today));
+    fprintf(out, "{\n  \"date\": \"%s\",\n  \"totals\": {", today);
+    for (int t = 0; t < TABLE_COUNT; t++) {
+        const RecordSchema *schema = recordSchema((TableID)t);
+        const char *name = schema ? schema->rowsName : (t == TABLE_LOCATIONS ? "locations" : "notices");
+        fprintf(out, "%s\n    \"%s\": %d", t ? "," : "", name, tableTotal((TableID)t));
+    }
+    fprintf(out, "\n  }");
+    for (int i = 0; i < STATS_BREAKDOWN_COUNT; i++) {
+        const HistogramBucket **buckets;
+        int count = sortedBuckets(&statsBreakdowns[i], &buckets);
+        fprintf(out, ",\n  \"%s\": {", statsBreakdowns[i].jsonKey);
+        for (int b = 0; b < count; b++) {
+            fprintf(out, "%s\n    ", b ? "," : "");
+            writeJsonString(out, buckets[b]->value);
+            fprintf(out, ": %d", buckets[b]->count);
+        }
+        fprintf(out, "%s}", count ? "\n  " : "");
+        free(buckets);
+    }
+    fprintf(out, "\n}\n");
+}
+
+// --- PREREQUISITE GRAPH (BITSET CLOSURE) ---
+// A course lists the courses it requires (prerequisites, completed in an
+// earlier semester) and those it is taken with (corequisites, completed
+// earlier or taken in the same semester). Both lists together form a DAG over
+// course codes. Row i of courses[] is bit i of a CourseSet. requisiteClosure[i]
+// holds every course row i depends on through either kind of edge (what cycle
+// checks need), and requiredBefore[i] the part of it that must be completed
+// before row i can be taken, so checking a student against a course is one
+// AND-NOT per word rather than a walk of the graph. Editing one course's lists recomputes the
+// closures of that course and of the courses that depend on it; loads,
+// reloads, adds and deletes (which renumber rows) rebuild the whole graph.
+
+enum { CLOSURE_PENDING, CLOSURE_VISITING, CLOSURE_DONE };
+
+static CourseSet directPrerequisites[MAX_RECORDS];
+static CourseSet directCorequisites[MAX_RECORDS];
+static CourseSet requisiteClosure[MAX_RECORDS];
+static CourseSet requiredBefore[MAX_RECORDS]; // The closure less corequisites needed only alongside
+
+static void courseSetAdd(CourseSet *set, int course) {
+    set->bits[course / 64] |= (uint64_t)1 << (course % 64);
+}
+
+static int courseSetHas(const CourseSet *set, int course) {
+    return (int)((set->bits[course / 64] >> (course % 64)) & 1);
+}
+
+static void courseSetUnion(CourseSet *dst, const CourseSet *src) {
+    for (int w = 0; w < COURSE_SET_WORDS; w++) dst->bits[w] |= src->bits[w];
+}
+
+// Copies the next code of a course list into 'code' and returns the rest of
+// the list, or NULL when none is left. Codes may be separated by ';', ',' or spaces.
+static const char* nextCourseCode(const char *list, char *code) {
+    while (*list == ';' || *list == ',' || isspace((unsigned char)*list)) list++;
+    if (*list == '\0') return NULL;
+    size_t length = 0;
+    while (*list && *list != ';' && *list != ',' && !isspace((unsigned char)*list)) {
+        if (length < MAX_ID_LENGTH - 1) code[length++] = *list;
+        list++;
+    }
+    code[length] = '\0';
+    return list;
+}
+
+static int courseRow(const char *code) {
+    return findRowByKey(courses, sizeof(Course), courseCount, code);
+}
+
+// Codes that name no current course (say, an archived one) are left out
+void courseListSet(const char *list, CourseSet *out) {
+    char code[MAX_ID_LENGTH];
+    memset(out, 0, sizeof(*out));
+    while ((list = nextCourseCode(list, code)) != NULL) {
+        int course = courseRow(code);
+        if (course >= 0) courseSetAdd(out, course);
+    }
+}
+
+// Recomputes the closure of 'course' from its direct edges, first closing any
+// dependency still pending. A back edge (a cycle in a hand-edited file) is
+// skipped, which keeps the rest of the graph usable.
+static void closeCourse(int course, unsigned char *state) {
+    state[course] = CLOSURE_VISITING;
+    CourseSet edges = directPrerequisites[course];
+    CourseSet closure, before;
+    memset(&closure, 0, sizeof(closure));
+    memset(&before, 0, sizeof(before));
+    courseSetUnion(&edges, &directCorequisites[course]);
+    for (int dep = 0; dep < courseCount; dep++) {
+        if (!courseSetHas(&edges, dep) || state[dep] == CLOSURE_VISITING) continue;
+        if (state[dep] == CLOSURE_PENDING) closeCourse(dep, state);
+        // A corequisite's own requirements still come first
+        if (courseSetHas(&directPrerequisites[course], dep)) courseSetAdd(&before, dep);
+        courseSetUnion(&before, &requisiteClosure[dep]);
+        courseSetAdd(&closure, dep);
+    }
+    courseSetUnion(&closure, &before);
+    requisiteClosure[course] = closure;
+    requiredBefore[course] = before;
+    state[course] = CLOSURE_DONE;
+}
+
+void rebuildRequisiteGraph(TableID table) {
+    if (table != TABLE_COURSES) return;
+    unsigned char state[MAX_RECORDS];
+    for (int i = 0; i < courseCount; i++) {
+        courseListSet(courses[i].prerequisites, &directPrerequisites[i]);
+        courseListSet(courses[i].corequisites, &directCorequisites[i]);
+        state[i] = CLOSURE_PENDING;
+    }
+    for (int i = 0; i < courseCount; i++) {
+        if (state[i] == CLOSURE_PENDING) closeCourse(i, state);
+    }
+}
+
+// Only 'course' and the courses whose closure contains it can have changed;
+// every other closure is reused as it is
+void requisiteRowChanged(TableID table, int course) {
+    if (table != TABLE_COURSES) return;
+    unsigned char state[MAX_RECORDS];
+    courseListSet(courses[course].prerequisites, &directPrerequisites[course]);
+    courseListSet(courses[course].corequisites, &directCorequisites[course]);
+    for (int i = 0; i < courseCount; i++) {
+        int affected = (i == course) || courseSetHas(&requisiteClosure[i], course);
+        state[i] = affected ? CLOSURE_PENDING : CLOSURE_DONE;
+    }
+    for (int i = 0; i < courseCount; i++) {
+        if (state[i] == CLOSURE_PENDING) closeCourse(i, state);
+    }
+}
+
+// True if either list of 'course' names 'code', current course or not
+static int courseListsName(int course, const char *code) {
+    char listed[MAX_ID_LENGTH];
+    const char *lists[2] = { courses[course].prerequisites, courses[course].corequisites };
+    for (int l = 0; l < 2; l++) {
+        const char *list = lists[l];
+        while ((list = nextCourseCode(list, listed)) != NULL) {
+            if (strcmp(listed, code) == 0) return 1;
+        }
+    }
+    return 0;
+}
+
+// True if 'course' depends on the course 'code', which is being added. A
+// deleted course's code stays in other courses' lists (and counts again once
+// it is re-added), so the graph has no edges to it yet and the lists are read.
+static int dependsOnNewCourse(int course, const char *code) {
+    if (courseListsName(course, code)) return 1;
+    for (int dep = 0; dep < courseCount; dep++) {
+        if (courseSetHas(&requisiteClosure[course], dep) && courseListsName(dep, code)) return 1;
+    }
+    return 0;
+}
+
+// Checks a course list typed into the record editor and rewrites it as
+// ';'-separated codes without repeats. Every code must name a current course.
+// On a course record the list may not name the course itself or a course
+// that already depends on it, either of which would close a cycle.
+// Returns 0 with the reason in 'problem'.
+int normalizeCourseList(TableID table, const void *row, const char *input, char *list, size_t size, char *problem, size_t problemSize) {
+    ensureTableLoaded(TABLE_COURSES); // The student editor loads only students
+    const char *key = (const char *)row; // Keys are the first member of every record
+    int self = (table == TABLE_COURSES) ? courseRow(key) : -1; // -1 while the course is being added
+    CourseSet listed;
+    char code[MAX_ID_LENGTH];
+    size_t length = 0;
+    memset(&listed, 0, sizeof(listed));
+    list[0] = '\0';
+
+    while ((input = nextCourseCode(input, code)) != NULL) {
+        int course = courseRow(code);
+        if (table == TABLE_COURSES && strcmp(code, key) == 0) {
+            snprintf(problem, problemSize, "A course cannot require itself.");
+            return 0;
+        }
+        if (course < 0) {
+            snprintf(problem, problemSize, "Unknown course code '%s'.", code);
+            return 0;
+        }
+        if (table == TABLE_COURSES &&
+            (self >= 0 ? courseSetHas(&requisiteClosure[course], self) : dependsOnNewCourse(course, key))) {
+            snprintf(problem, problemSize, "%s already depends on %s; requiring it would make a cycle.", code, key);
+            return 0;
+        }
+        if (courseSetHas(&listed, course)) continue;
+        courseSetAdd(&listed, course);
+        int written = snprintf(list + length, size - length, "%s%s", length ? ";" : "", code);
+        if (written < 0 || (size_t)written >= size - length) {
+            snprintf(problem, problemSize, "Too many course codes for one list.");
+            return 0;
+        }
+        length += (size_t)written;
+    }
+    return 1;
+}
+
+// Courses that must be completed before 'course' and are not in 'completed'.
+// Returns 1 when nothing is missing.
+int missingRequisites(const CourseSet *completed, int course, CourseSet *missing) {
+    uint64_t any = 0;
+    for (int w = 0; w < COURSE_SET_WORDS; w++) {
+        missing->bits[w] = requiredBefore[course].bits[w] & ~completed->bits[w];
+        any |= missing->bits[w];
+    }
+    return any == 0;
+}
+
+// Corequisites of 'course' still to be taken; returns 1 when there are any
+int pendingCorequisites(const CourseSet *completed, int course, CourseSet *pending) {
+    uint64_t any = 0;
+    for (int w = 0; w < COURSE_SET_WORDS; w++) {
+        pending->bits[w] = directCorequisites[course].bits[w] & ~completed->bits[w];
+        any |= pending->bits[w];
+    }
+    return any != 0;
+}
+
+// Courses not completed in 'after' that it makes eligible and 'before' did not
+int coursesUnlocked(const CourseSet *before, const CourseSet *after, CourseSet *unlocked) {
+    CourseSet missing;
+    int count = 0;
+    memset(unlocked, 0, sizeof(*unlocked));
+    for (int i = 0; i < courseCount; i++) {
+        if (courseSetHas(after, i) || !missingRequisites(after, i, &missing)) continue;
+        if (missingRequisites(before, i, &missing)) continue;
+        courseSetAdd(unlocked, i);
+        count++;
+    }
+    return count;
+}
+
+void formatCourseSet(const CourseSet *set, char *out, size_t size) {
+    size_t length = 0;
+    out[0] = '\0';
+    for (int i = 0; i < courseCount && length < size; i++) {
+        if (!courseSetHas(set, i)) continue;
+        int written = snprintf(out + length, size - length, "%s%s", length ? ", " : "", courses[i].code);
+        if (written < 0) break;
+        length += (size_t)written;
+    }
+}
+
+// --- DEGREE AUDIT (PARALLEL BATCH) ---
+// A student's completed list is checked against the requirements of their
+// program: every required course, 'picks' courses from the elective pool and
+// the minimum credits. Requirements are compiled once into CourseSets (see
+// PREREQUISITE GRAPH), so a student costs one pass over their completed list
+// and a few AND/popcount passes. Pace separates "on track" from "at risk": by
+// now a student should have earned credits in proportion to the semesters
+// since admission. The batch audit splits the rows across one thread per
+// processor; workers only read the tables and each writes its own slice of
+// the results, so nothing is locked while they run.
+
+#define AUDIT_PACE_TOLERANCE 0.75  // Share of the expected credits that still counts as on track
+#define AUDIT_ROWS_PER_THREAD 1024 // Fewer rows than this per thread are not worth another thread
+#define MAX_AUDIT_THREADS 64
+
+const char *auditStatusNames[AUDIT_STATUS_COUNT] = { "Complete", "On track", "At risk", "No program" };
+
+typedef struct AuditPlan {
+    const Program *program;
+    CourseSet required;
+    CourseSet electives;
+} AuditPlan;
+
+typedef struct AuditBatch {
+    const AuditPlan *plans;      // Sorted by program name
+    int planCount;
+    int term;                    // The current semester (see semesterTerm)
+    const Student *rows;
+    AuditResult *results;
+    int begin, end;
+} AuditBatch;
+
+static int courseSetCount(const CourseSet *set) {
+    int count = 0;
+    for (int w = 0; w < COURSE_SET_WORDS; w++) {
+        for (uint64_t word = set->bits[w]; word; word &= word - 1) count++;
+    }
+    return count;
+}
+
+// Semesters since year 0, or -1 for a blank (or hand-edited, malformed) semester
+static int semesterTerm(const char *semester) {
+    if (!isValidSemester(semester)) return -1;
+    return atoi(semester) * SEMESTERS_PER_YEAR + (semester[5] - '1');
+}
+
+static int currentTerm() {
+    int today = todayDate();
+    return (today / 10000) * SEMESTERS_PER_YEAR + (((today / 100) % 100) <= 6 ? 0 : 1);
+}
+
+static void compileAuditPlan(const Program *program, AuditPlan *plan) {
+    plan->program = program;
+    courseListSet(program->required, &plan->required);
+    courseListSet(program->electives, &plan->electives);
+}
+
+static int compareAuditPlans(const void *a, const void *b) {
+    return strcmp(((const AuditPlan *)a)->program->name, ((const AuditPlan *)b)->program->name);
+}
+
+// 'plan' is NULL when the program has no requirements. The detail sets may be NULL.
+static void auditAgainstPlan(const AuditPlan *plan, int term, const Student *student, AuditResult *result,
+                             CourseSet *missingRequired, CourseSet *electivesTaken) {
+    CourseSet completed, missing, electives;
+    courseListSet(student->completed, &completed);
+    memset(result, 0, sizeof(*result));
+    for (int i = 0; i < courseCount; i++) {
+        if (courseSetHas(&completed, i)) result->credits += courses[i].credits;
+    }
+    if (plan == NULL) {
+        result->status = AUDIT_NO_PROGRAM;
+        return;
+    }
+
+    const Program *program = plan->program;
+    for (int w = 0; w < COURSE_SET_WORDS; w++) {
+        missing.bits[w] = plan->required.bits[w] & ~completed.bits[w];
+        electives.bits[w] = plan->electives.bits[w] & completed.bits[w];
+    }
+    result->missingRequired = courseSetCount(&missing);
+    int picked = courseSetCount(&electives);
+    result->electivesShort = picked < program->picks ? program->picks - picked : 0;
+    if (missingRequired) *missingRequired = missing;
+    if (electivesTaken) *electivesTaken = electives;
+
+    int admitted = semesterTerm(student->semester);
+    int elapsed = (admitted < 0) ? 0 : term - admitted; // Semesters finished before this one
+    if (elapsed > 0 && program->semesters > 0) {
+        long expected = (long)program->credits * elapsed / program->semesters;
+        result->expectedCredits = (int)(expected < program->credits ? expected : program->credits);
+    }
+
+    if (result->missingRequired == 0 && result->electivesShort == 0 && result->credits >= program->credits) {
+        result->status = AUDIT_COMPLETE;
+    } else if (admitted >= 0 && program->semesters > 0 && elapsed >= program->semesters) {
+        result->status = AUDIT_AT_RISK; // Past the program's length and still short
+    } else if (result->credits < result->expectedCredits * AUDIT_PACE_TOLERANCE) {
+        result->status = AUDIT_AT_RISK;
+    } else {
+        result->status = AUDIT_ON_TRACK;
+    }
+}
+
+static void runAuditBatch(const AuditBatch *batch) {
+    for (int i = batch->begin; i < batch->end; i++) {
+        const Student *student = &batch->rows[i];
+        AuditPlan key;
+        Program name;
+        snprintf(name.name, sizeof(name.name), "%s", student->program);
+        key.program = &name;
+        const AuditPlan *plan = (const AuditPlan *)bsearch(&key, batch->plans, batch->planCount, sizeof(AuditPlan), compareAuditPlans);
+        auditAgainstPlan(plan, batch->term, student, &batch->results[i], NULL, NULL);
+    }
+}
+
+THREAD_FUNC(auditThreadMain, arg) {
+    runAuditBatch((const AuditBatch *)arg);
+    THREAD_RETURN;
+}
+
+// On demand: one student, with the sets behind the verdict (either may be NULL)
+void auditStudent(const Student *student, AuditResult *result, CourseSet *missingRequired, CourseSet *electivesTaken) {
+    int row = findRowByKey(programs, sizeof(Program), programCount, student->program);
+    AuditPlan plan;
+    if (row >= 0) compileAuditPlan(&programs[row], &plan);
+    auditAgainstPlan(row >= 0 ? &plan : NULL, currentTerm(), student, result, missingRequired, electivesTaken);
+}
+
+// Audits rows[0..count) into results[], split across the processors.
+// Courses and programs must be loaded. Returns the number of threads used.
+int auditStudents(const Student *rows, int count, AuditResult *results) {
+    static AuditPlan plans[MAX_RECORDS];
+    for (int i = 0; i < programCount; i++) compileAuditPlan(&programs[i], &plans[i]);
+    qsort(plans, programCount, sizeof(AuditPlan), compareAuditPlans);
+
+    int threads = processorCount();
+    if (threads > MAX_AUDIT_THREADS) threads = MAX_AUDIT_THREADS;
+    if (threads > count / AUDIT_ROWS_PER_THREAD) threads = count / AUDIT_ROWS_PER_THREAD;
+    if (threads < 1) threads = 1;
+
+    AuditBatch batches[MAX_AUDIT_THREADS];
+    Thread workers[MAX_AUDIT_THREADS];
+    int started[MAX_AUDIT_THREADS];
+    int term = currentTerm();
+    for (int t = 0; t < threads; t++) {
+        AuditBatch batch = { plans, programCount, term, rows, results,
+                             (int)((long)count * t / threads), (int)((long)count * (t + 1) / threads) };
+        batches[t] = batch;
+    }
+    for (int t = 1; t < threads; t++) {
+        started[t] = threadStart(&workers[t], auditThreadMain, &batches[t]);
+        if (!started[t]) runAuditBatch(&batches[t]); // Out of threads: do this slice here
+    }
+    runAuditBatch(&batches[0]);
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) threadJoin(workers[t]);
+    }
+    return threads;
+}
+
+// Every row of students.dat, however many (the menus hold at most
+// MAX_RECORDS). Returns NULL when the file cannot be read; the caller frees.
+Student* readStudentBody(int *count) {
+    FILE *fp = openTableForRead(tableFiles[TABLE_STUDENTS]);
+    if (fp == NULL) return NULL;
+    int lines = 0, c, version;
+    while ((c = fgetc(fp)) != EOF) {
+        if (c == '\n') lines++;
+    }
+    closeTable(fp);
+
+    Student *rows = (Student *)malloc(sizeof(Student) * (size_t)(lines + 1));
+    if (rows == NULL) return NULL;
+    *count = parseStudentFile(tableFiles[TABLE_STUDENTS], rows, lines + 1, &version);
+    if (*count < 0) {
+        free(rows);
+        return NULL;
+    }
+    return rows;
+}
+
+void writeAuditCsv(FILE *out, const Student *rows, const AuditResult *results, int count) {
+    fprintf(out, "id,program,status,credits,expected_credits,missing_required,electives_short\n");
+    for (int i = 0; i < count; i++) {
+        writeCsvField(out, rows[i].id);
+        fputc(',', out);
+        writeCsvField(out, rows[i].program);
+        fprintf(out, ",%s,%d,%d,%d,%d\n", auditStatusNames[results[i].status], results[i].credits,
+                results[i].expectedCredits, results[i].missingRequired, results[i].electivesShort);
+    }
+}
+
+// Times the batch audit over 'rows' synthetic students against a synthetic
+// catalog and programs, which replace the in-memory tables (nothing is saved)
+int benchmarkAudit(int rows) {
+    static const char *programNames[] = { "BSc CS", "BEng ME", "BTech IT", "BA Econ", "MSc Data" };
+    Student *data = (Student *)malloc(sizeof(Student) * (size_t)rows);
+    AuditResult *results = (AuditResult *)malloc(sizeof(AuditResult) * (size_t)rows);
+    if (data == NULL || results == NULL) {
+        printf("Error: Not enough memory for %d rows.\n", rows);
+        free(data);
+        free(results);
+        return 0;
+    }
+
+    courseCount = MAX_RECORDS;
+    for (int i = 0; i < courseCount; i++) {
+        memset(&courses[i], 0, sizeof(Course));
+        snprintf(courses[i].code, MAX_ID_LENGTH, "B%03d", i);
+        snprintf(courses[i].name, MAX_NAME_LENGTH, "Course %d", i);
+        courses[i].credits = 3 + i % 2;
+    }
+    // Program p requires 12 courses from row 15p and picks 3 of the next 6
+    programCount = 5;
+    for (int p = 0; p < programCount; p++) {
+        Program *program = &programs[p];
+        memset(program, 0, sizeof(Program));
+        snprintf(program->name, MAX_NAME_LENGTH, "%s", programNames[p]);
+        program->semesters = 8;
+        program->credits = 50;
+        program->picks = 3;
+        for (int k = 0; k < 18; k++) {
+            char *list = (k < 12) ? program->required : program->electives;
+            size_t length = strlen(list);
+            snprintf(list + length, MAX_NAME_LENGTH - length, "%sB%03d", length ? ";" : "", 15 * p + k);
+        }
+    }
+    unsigned seed = 12345;
+    for (int i = 0; i < rows; i++) {
+        int p = i % programCount;
+        memset(&data[i], 0, sizeof(Student));
+        snprintf(data[i].id, MAX_ID_LENGTH, "S%07d", i);
+        snprintf(data[i].program, MAX_NAME_LENGTH, "%s", programNames[p]);
+        seed = seed * 1103515245u + 12345u;
+        snprintf(data[i].semester, MAX_ID_LENGTH, "%d-%d", 2021 + (int)(seed >> 16) % 5, 1 + (int)(seed >> 8) % 2);
+        for (int k = 0; k < 18; k++) {
+            seed = seed * 1103515245u + 12345u;
+            if ((seed >> 16) % 3 == 0) continue; // Leaves about a third of the courses out
+            size_t length = strlen(data[i].completed);
+            snprintf(data[i].completed + length, MAX_NAME_LENGTH - length, "%sB%03d", length ? ";" : "", 15 * p + k);
+        }
+    }
+
+    double start = monotonicMillis();
+    int threads = auditStudents(data, rows, results);
+    double elapsed = monotonicMillis() - start;
+    int tally[AUDIT_STATUS_COUNT] = {0};
+    for (int i = 0; i < rows; i++) tally[results[i].status]++;
+    printf("Audited %d students on %d thread(s) in %.2f ms (%.0f students/s).\n",
+           rows, threads, elapsed, elapsed > 0 ? rows / elapsed * 1000.0 : 0.0);
+    for (int s = 0; s < AUDIT_STATUS_COUNT; s++) printf("  %-10s %d\n", auditStatusNames[s], tally[s]);
+    free(data);
+    free(results);
+    return 1;
+}
+
+// --- CLASS RANK (PARALLEL SORT AND TOP-N HEAPS) ---
+// Students are ranked within their program by GPA. Equal GPAs share a rank
+// ("1, 2, 2, 4"), and students with no GPA recorded are left out. There are
+// two ways to get a rank:
+//   - rankStudents() ranks a whole array at once. It sorts (program, GPA)
+//     keys in slices on one thread per processor, then merges the slices
+//     pairwise, with the merges of each round also spread over the threads.
+//     The --ranks report and the admin CSV export use it.
+//   - The live tables keep a ranking per program, updated as records change
+//     through statsRowChanged(). Each program has a Fenwick tree counting
+//     students per GPA value (in hundredths). A rank is then one prefix sum,
+//     and an edit is one point update, both O(log GPA_MAX), so a profile
+//     never re-sorts the cohort. Each program also has a bounded min-heap of
+//     its top HONOURS_LIST_SIZE students, with the weakest listed student at
+//     the root. 'floor' bounds everyone not on the list. A new or raised GPA
+//     enters the list in O(log N). If a listed student drops or leaves, the
+//     list is refilled from the table the next time it is read.
+// The live rankings are touched only by the menu thread.
+
+#define HONOURS_LIST_SIZE 10
+#define MAX_RANKED_PROGRAMS MAX_RECORDS
+
+typedef struct ProgramRanking {
+    char program[MAX_NAME_LENGTH];
+    int cohort;                          // Students with a GPA recorded
+    int tree[GPA_MAX + 2];               // Fenwick tree over GPA values 0..GPA_MAX, one-based
+    HonoursEntry top[HONOURS_LIST_SIZE]; // Min-heap: the weakest listed student at top[0]
+    int topCount;
+    HonoursEntry floor;                  // Nobody off the list ranks above this (gpa -1: nobody is off it)
+} ProgramRanking;
+
+static ProgramRanking *programRankings[MAX_RANKED_PROGRAMS];
+static int rankedProgramCount = 0;
+// Where honours lists are refilled from; the benchmark swaps in its own rows
+static const Student *rankRows = students;
+static const int *rankRowCount = &studentCount;
+
+// Better GPA first; equal GPAs in ID order, so every entry has one place
+static int honoursBetter(const HonoursEntry *a, const HonoursEntry *b) {
+    if (a->gpa != b->gpa) return a->gpa > b->gpa;
+    return strcmp(a->id, b->id) < 0;
+}
+
+static void honoursSiftUp(ProgramRanking *ranking, int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!honoursBetter(&ranking->top[parent], &ranking->top[i])) break;
+        HonoursEntry swap = ranking->top[parent];
+        ranking->top[parent] = ranking->top[i];
+        ranking->top[i] = swap;
+        i = parent;
+    }
+}
+
+static void honoursSiftDown(ProgramRanking *ranking, int i) {
+    while (1) {
+        int weakest = i;
+        for (int child = 2 * i + 1; child <= 2 * i + 2 && child < ranking->topCount; child++) {
+            if (honoursBetter(&ranking->top[weakest], &ranking->top[child])) weakest = child;
+        }
+        if (weakest == i) return;
+        HonoursEntry swap = ranking->top[weakest];
+        ranking->top[weakest] = ranking->top[i];
+        ranking->top[i] = swap;
+        i = weakest;
+    }
+}
+
+static void honoursOffer(ProgramRanking *ranking, const HonoursEntry *entry) {
+    if (ranking->topCount < HONOURS_LIST_SIZE) {
+        // A gap is only filled by someone known to beat everyone off the list
+        if (ranking->floor.gpa >= 0 && !honoursBetter(entry, &ranking->floor)) return;
+        ranking->top[ranking->topCount] = *entry;
+        honoursSiftUp(ranking, ranking->topCount++);
+    } else if (honoursBetter(entry, &ranking->top[0])) {
+        ranking->floor = ranking->top[0]; // Pushed off; it now heads everyone off the list
+        ranking->top[0] = *entry;
+        honoursSiftDown(ranking, 0);
+    } else if (ranking->floor.gpa < 0 || honoursBetter(entry, &ranking->floor)) {
+        ranking->floor = *entry;
+    }
+}
+
+static void honoursRemove(ProgramRanking *ranking, const char *id) {
+    for (int i = 0; i < ranking->topCount; i++) {
+        if (strcmp(ranking->top[i].id, id) != 0) continue;
+        ranking->top[i] = ranking->top[--ranking->topCount];
+        if (i < ranking->topCount) {
+            honoursSiftUp(ranking, i);
+            honoursSiftDown(ranking, i);
+        }
+        return;
+    }
+}
+
+// GPA g lives at index g + 1: a Fenwick tree has no index 0, and 0.00 is a GPA
+static void fenwickAdd(int *tree, int gpa, int delta) {
+    for (int i = gpa + 1; i <= GPA_MAX + 1; i += i & -i) tree[i] += delta;
+}
+
+// Students with a GPA of at most 'gpa' (none for a gpa below 0)
+static int fenwickCount(const int *tree, int gpa) {
+    int total = 0;
+    for (int i = gpa + 1; i > 0; i -= i & -i) total += tree[i];
+    return total;
+}
+
+static ProgramRanking* rankingFor(const char *program, int create) {
+    for (int i = 0; i < rankedProgramCount; i++) {
+        if (strcmp(programRankings[i]->program, program) == 0) return programRankings[i];
+    }
+    if (!create || rankedProgramCount == MAX_RANKED_PROGRAMS) return NULL;
+    ProgramRanking *ranking = (ProgramRanking *)calloc(1, sizeof(ProgramRanking));
+    if (ranking == NULL) return NULL;
+    snprintf(ranking->program, sizeof(ranking->program), "%s", program);
+    ranking->floor.gpa = -1;
+    programRankings[rankedProgramCount++] = ranking;
+    return ranking;
+}
+
+void resetClassRanks() {
+    for (int i = 0; i < rankedProgramCount; i++) free(programRankings[i]);
+    rankedProgramCount = 0;
+}
+
+void rankRowChanged(const Student *student, int delta) {
+    if (!hasGpa(student->gpa)) return;
+    ProgramRanking *ranking = rankingFor(student->program, delta > 0);
+    if (ranking == NULL) return;
+    fenwickAdd(ranking->tree, student->gpa, delta);
+    ranking->cohort += delta;
+    if (delta > 0) {
+        HonoursEntry entry;
+        entry.gpa = student->gpa;
+        snprintf(entry.id, sizeof(entry.id), "%s", student->id);
+        honoursOffer(ranking, &entry);
+    } else {
+        honoursRemove(ranking, student->id);
+    }
+}
+
+int classRankOf(const Student *student, ClassRank *out) {
+    ProgramRanking *ranking = rankingFor(student->program, 0);
+    if (ranking == NULL || ranking->cohort <= 0 || !hasGpa(student->gpa)) return 0;
+    int atOrBelow = fenwickCount(ranking->tree, student->gpa);
+    out->rank = ranking->cohort - atOrBelow + 1;
+    out->cohort = ranking->cohort;
+    out->percentile = 100.0 * fenwickCount(ranking->tree, student->gpa - 1) / ranking->cohort;
+    return 1;
+}
+
+static int compareHonours(const void *a, const void *b) {
+    const HonoursEntry *x = (const HonoursEntry *)a, *y = (const HonoursEntry *)b;
+    return honoursBetter(x, y) ? -1 : honoursBetter(y, x) ? 1 : 0;
+}
+
+// The program's top students, best first; refills the list if it has gaps
+int honoursList(const char *program, HonoursEntry *out, int max) {
+    ProgramRanking *ranking = rankingFor(program, 0);
+    if (ranking == NULL) return 0;
+    int expected = ranking->cohort < HONOURS_LIST_SIZE ? ranking->cohort : HONOURS_LIST_SIZE;
+    if (ranking->topCount < expected) {
+        ranking->topCount = 0;
+        ranking->floor.gpa = -1;
+        for (int i = 0; i < *rankRowCount; i++) {
+            const Student *row = &rankRows[i];
+            if (!hasGpa(row->gpa) || strcmp(row->program, program) != 0) continue;
+            HonoursEntry entry;
+            entry.gpa = row->gpa;
+            snprintf(entry.id, sizeof(entry.id), "%s", row->id);
+            honoursOffer(ranking, &entry);
+        }
+    }
+    int count = ranking->topCount < max ? ranking->topCount : max;
+    HonoursEntry sorted[HONOURS_LIST_SIZE];
+    memcpy(sorted, ranking->top, sizeof(HonoursEntry) * ranking->topCount);
+    qsort(sorted, ranking->topCount, sizeof(HonoursEntry), compareHonours);
+    memcpy(out, sorted, sizeof(HonoursEntry) * count);
+    return count;
+}
+
+// Names of the programs with at least one ranked student
+int rankedPrograms(const char **names, int max) {
+    int count = 0;
+    for (int i = 0; i < rankedProgramCount && count < max; i++) {
+        if (programRankings[i]->cohort > 0) names[count++] = programRankings[i]->program;
+    }
+    return count;
+}
+
+// --- Full ranking of an array (parallel sort) ---
+
+typedef struct RankKey {
+    const char *program;
+    int gpa;
+    int row;
+} RankKey;
+
+// Sorts src[begin, end) in place when middle < 0, else merges its two sorted halves into dst
+typedef struct RankTask {
+    RankKey *src;
+    RankKey *dst;
+    int begin, middle, end;
+} RankTask;
+
+typedef struct RankWorker {
+    const RankTask *tasks;
+    int count, first, stride;
+} RankWorker;
+
+// Program, then GPA descending, then row order
+static int compareRankKeys(const void *a, const void *b) {
+    const RankKey *x = (const RankKey *)a, *y = (const RankKey *)b;
+    int order = strcmp(x->program, y->program);
+    if (order != 0) return order;
+    if (x->gpa != y->gpa) return y->gpa - x->gpa;
+    return x->row - y->row;
+}
+
+static void runRankTasks(const RankWorker *worker) {
+    for (int t = worker->first; t < worker->count; t += worker->stride) {
+        const RankTask *task = &worker->tasks[t];
+        if (task->middle < 0) {
+            qsort(task->src + task->begin, task->end - task->begin, sizeof(RankKey), compareRankKeys);
+            continue;
+        }
+        int left = task->begin, right = task->middle, out = task->begin;
+        while (left < task->middle && right < task->end) {
+            if (compareRankKeys(&task->src[right], &task->src[left]) < 0) task->dst[out++] = task->src[right++];
+            else task->dst[out++] = task->src[left++];
+        }
+        while (left < task->middle) task->dst[out++] = task->src[left++];
+        while (right < task->end) task->dst[out++] = task->src[right++];
+    }
+}
+
+THREAD_FUNC(rankThreadMain, arg) {
+    runRankTasks((const RankWorker *)arg);
+    THREAD_RETURN;
+}
+
+// Spreads the tasks over up to 'threads' threads; the calling thread takes a share
+static void runRankTasksParallel(const RankTask *tasks, int count, int threads) {
+    if (threads > count) threads = count;
+    if (threads < 1) threads = 1;
+    RankWorker workers[MAX_AUDIT_THREADS];
+    Thread handles[MAX_AUDIT_THREADS];
+    int started[MAX_AUDIT_THREADS];
+    for (int t = 0; t < threads; t++) {
+        RankWorker worker = { tasks, count, t, threads };
+        workers[t] = worker;
+    }
+    for (int t = 1; t < threads; t++) {
+        started[t] = threadStart(&handles[t], rankThreadMain, &workers[t]);
+        if (!started[t]) runRankTasks(&workers[t]);
+    }
+    runRankTasks(&workers[0]);
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) threadJoin(handles[t]);
+    }
+}
+
+// Fills ranks[i] for rows[i] (rank 0 for students without a GPA).
+// Returns the number of threads used, or 0 if memory ran out.
+int rankStudents(const Student *rows, int count, ClassRank *ranks) {
+    RankKey *keys = (RankKey *)malloc(sizeof(RankKey) * (size_t)(count + 1));
+    RankKey *spare = (RankKey *)malloc(sizeof(RankKey) * (size_t)(count + 1));
+    if (keys == NULL || spare == NULL) {
+        free(keys);
+        free(spare);
+        return 0;
+    }
+    int ranked = 0;
+    for (int i = 0; i < count; i++) {
+        memset(&ranks[i], 0, sizeof(ClassRank));
+        if (!hasGpa(rows[i].gpa)) continue;
+        RankKey key = { rows[i].program, rows[i].gpa, i };
+        keys[ranked++] = key;
+    }
+
+    int threads = processorCount();
+    if (threads > MAX_AUDIT_THREADS) threads = MAX_AUDIT_THREADS;
+    if (threads > ranked / AUDIT_ROWS_PER_THREAD) threads = ranked / AUDIT_ROWS_PER_THREAD;
+    if (threads < 1) threads = 1;
+
+    // Sort one slice per thread, then merge neighbouring runs until one is left
+    RankTask tasks[MAX_AUDIT_THREADS];
+    int bounds[MAX_AUDIT_THREADS + 1];
+    int runs = threads;
+    for (int t = 0; t <= threads; t++) bounds[t] = (int)((long)ranked * t / threads);
+    for (int t = 0; t < threads; t++) {
+        RankTask task = { keys, NULL, bounds[t], -1, bounds[t + 1] };
+        tasks[t] = task;
+    }
+    runRankTasksParallel(tasks, threads, threads);
+    while (runs > 1) {
+        int merged = 0;
+        for (int r = 0; r + 1 < runs; r += 2) {
+            RankTask task = { keys, spare, bounds[r], bounds[r + 1], bounds[r + 2] };
+            tasks[merged] = task;
+            bounds[merged++] = bounds[r];
+        }
+        if (runs % 2) { // The odd run out is copied across unchanged
+            RankTask task = { keys, spare, bounds[runs - 1], bounds[runs], bounds[runs] };
+            tasks[merged] = task;
+            bounds[merged++] = bounds[runs - 1];
+        }
+        bounds[merged] = ranked;
+        runRankTasksParallel(tasks, merged, threads);
+        RankKey *swap = keys;
+        keys = spare;
+        spare = swap;
+        runs = merged;
+    }
+
+    // One pass over the sorted keys: ranks restart with each program
+    for (int begin = 0; begin < ranked; ) {
+        int end = begin;
+        while (end < ranked && strcmp(keys[end].program, keys[begin].program) == 0) end++;
+        int cohort = end - begin;
+        for (int tie = begin; tie < end; ) {
+            int tieEnd = tie;
+            while (tieEnd < end && keys[tieEnd].gpa == keys[tie].gpa) tieEnd++;
+            for (int k = tie; k < tieEnd; k++) {
+                ClassRank *rank = &ranks[keys[k].row];
+                rank->rank = tie - begin + 1;
+                rank->cohort = cohort;
+                rank->percentile = 100.0 * (end - tieEnd) / cohort;
+            }
+            tie = tieEnd;
+        }
+        begin = end;
+    }
+    free(keys);
+    free(spare);
+    return threads;
+}
+
+void writeRankCsv(FILE *out, const Student *rows, const ClassRank *ranks, int count) {
+    fprintf(out, "id,program,gpa,rank,cohort,percentile\n");
+    for (int i = 0; i < count; i++) {
+        char gpa[16];
+        if (ranks[i].rank == 0) continue;
+        formatGpa(rows[i].gpa, gpa, sizeof(gpa));
+        writeCsvField(out, rows[i].id);
+        fputc(',', out);
+        writeCsvField(out, rows[i].program);
+        fprintf(out, ",%s,%d,%d,%.1f\n", gpa, ranks[i].rank, ranks[i].cohort, ranks[i].percentile);
+    }
+}
+
+// Ranks 'rows' synthetic students both ways, then changes GPAs one at a time
+// and checks the live rankings against a fresh full ranking (nothing is saved)
+int benchmarkRanking(int rows) {
+    static const char *programNames[] = { "BSc CS", "BEng ME", "BTech IT", "BA Econ", "MSc Data" };
+    int updates = rows < 10000 ? rows : 10000;
+    Student *data = (Student *)malloc(sizeof(Student) * (size_t)rows);
+    ClassRank *ranks = (ClassRank *)malloc(sizeof(ClassRank) * (size_t)rows);
+    if (data == NULL || ranks == NULL) {
+        printf("Error: Not enough memory for %d rows.\n", rows);
+        free(data);
+        free(ranks);
+        return 0;
+    }
+    unsigned seed = 12345;
+    for (int i = 0; i < rows; i++) {
+        memset(&data[i], 0, sizeof(Student));
+        snprintf(data[i].id, MAX_ID_LENGTH, "S%07d", i);
+        snprintf(data[i].program, MAX_NAME_LENGTH, "%s", programNames[i % 5]);
+        seed = seed * 1103515245u + 12345u;
+        data[i].gpa = (int)((seed >> 16) % (GPA_MAX + 2)) - 1; // About one in a thousand has none, as many 0.00
+    }
+
+    double start = monotonicMillis();
+    int threads = rankStudents(data, rows, ranks);
+    double sortMillis = monotonicMillis() - start;
+
+    const Student *savedRows = rankRows;
+    const int *savedCount = rankRowCount;
+    rankRows = data;
+    rankRowCount = &rows;
+    resetClassRanks();
+    start = monotonicMillis();
+    for (int i = 0; i < rows; i++) rankRowChanged(&data[i], 1);
+    double buildMillis = monotonicMillis() - start;
+
+    // Each update is the -1/+1 pair the record editor makes, followed by the reads a profile makes
+    HonoursEntry top[HONOURS_LIST_SIZE];
+    ClassRank live;
+    start = monotonicMillis();
+    for (int u = 0; u < updates; u++) {
+        seed = seed * 1103515245u + 12345u;
+        Student *student = &data[(seed >> 8) % (unsigned)rows];
+        rankRowChanged(student, -1);
+        seed = seed * 1103515245u + 12345u;
+        student->gpa = (int)((seed >> 16) % (GPA_MAX + 2)) - 1;
+        rankRowChanged(student, 1);
+        classRankOf(student, &live);
+        honoursList(student->program, top, HONOURS_LIST_SIZE);
+    }
+    double updateMillis = monotonicMillis() - start;
+
+    // Every live rank and honours list must match a full ranking of the final data
+    int mismatches = 0;
+    rankStudents(data, rows, ranks);
+    for (int i = 0; i < rows; i++) {
+        int ranked = classRankOf(&data[i], &live);
+        if (ranked != (ranks[i].rank > 0) || (ranked && (live.rank != ranks[i].rank || live.cohort != ranks[i].cohort))) mismatches++;
+    }
+    for (int p = 0; p < 5 && p < rows; p++) {
+        int count = honoursList(programNames[p], top, HONOURS_LIST_SIZE);
+        int cohort = 0;
+        for (int k = 1; k < count; k++) {
+            if (honoursBetter(&top[k], &top[k - 1])) mismatches++;
+        }
+        // Nobody off the list may beat its last entry
+        for (int i = p; i < rows; i += 5) {
+            if (!hasGpa(data[i].gpa)) continue;
+            cohort++;
+            HonoursEntry entry;
+            entry.gpa = data[i].gpa;
+            snprintf(entry.id, sizeof(entry.id), "%s", data[i].id);
+            int listed = 0;
+            for (int k = 0; k < count; k++) listed |= strcmp(top[k].id, entry.id) == 0;
+            if (!listed && count > 0 && honoursBetter(&entry, &top[count - 1])) mismatches++;
+        }
+        if (count != (cohort < HONOURS_LIST_SIZE ? cohort : HONOURS_LIST_SIZE)) mismatches++;
+    }
+    resetClassRanks();
+    rankRows = savedRows;
+    rankRowCount = savedCount;
+
+    printf("Ranked %d students on %d thread(s) in %.2f ms (full parallel sort).\n", rows, threads, sortMillis);
+    printf("Built the live rankings in %.2f ms; %d GPA changes with rank and honours reads in %.2f ms (%.2f us each).\n",
+           buildMillis, updates, updateMillis, updates ? updateMillis * 1000.0 / updates : 0.0);
+    printf("%d mismatch(es) against a fresh full ranking.\n", mismatches);
+    free(data);
+    free(ranks);
+    return mismatches == 0;
+}
+
+// --- COURSE REGISTRATION (ATOMIC SEATS AND WAITLISTS) ---
+// Every course has a seat account: an atomic count of seats taken, checked
+// against the course's capacity with compare-and-swap, so requests for
+// different courses never wait on each other and those for one course only
+// retry a CAS. Only a full course takes its account's lock, to join the FIFO
+// waitlist. A dropped seat passes straight to the head of the waitlist under
+// that same lock, so the count never dips while anyone waits and a newcomer
+// cannot jump the queue. Who holds what is kept in a hash of registrations
+// split into REGISTRATION_STRIPES separately locked stripes; nothing is
+// locked globally. A student's own requests are expected one at a time (one
+// session per student); different students may race freely.
+//
+// Outcomes are journaled to registrations.dat (E enrolled, W waitlisted,
+// P promoted from the waitlist, D dropped, X left the waitlist). Workers push
+// them onto a lock-free list and flushRegistrationJournal() appends them.
+// Loading replays the journal, which restores the seats and the queue order,
+// then writes it compacted to a temp file that is renamed over the journal.
+// Instances serialize on registrations.lock (the journal itself is replaced
+// by the rename, so it cannot carry the lock) for the whole replay and
+// rewrite, and for every append. Several instances may share one db/: each
+// remembers how far into the journal it has read, and before deciding a
+// request it takes the lock and replays what the others appended since, so
+// the last seat goes to exactly one of them. A compaction stamps the new
+// journal, which tells the others to replay it from the top.
+
+#define REGISTRATION_STRIPES 64
+#define MAX_SEAT_ACCOUNTS (MAX_RECORDS * 2) // Deleted courses keep their accounts
+
+typedef enum { SEAT_PENDING, SEAT_ENROLLED, SEAT_WAITLISTED } SeatState;
+
+typedef struct Registration {
+    char student[MAX_ID_LENGTH];
+    int account;                      // Index into seatAccounts[]
+    atomic_int state;                 // SeatState
+    struct Registration *next;        // Chain within its stripe
+    struct Registration *nextWaiting; // Queue order within its account
+} Registration;
+
+typedef struct SeatAccount {
+    char code[MAX_ID_LENGTH];         // Course code; first, like record keys
+    atomic_int taken;                 // Seats held, never above a non-zero capacity
+    atomic_int capacity;              // 0 for unlimited
+    atomic_int waiting;
+    Mutex lock;                       // Guards the waitlist
+    Registration *waitHead, *waitTail;
+} SeatAccount;
+
+typedef struct RegistrationStripe {
+    Mutex lock;
+    Registration *head;
+} RegistrationStripe;
+
+typedef struct JournalEntry {
+    char line[2 * MAX_ID_LENGTH + 8];
+    struct JournalEntry *next;
+} JournalEntry;
+
+static SeatAccount seatAccounts[MAX_SEAT_ACCOUNTS];
+static int seatAccountCount = 0;      // Grows only on the menu thread, between requests
+static RegistrationStripe registrationStripes[REGISTRATION_STRIPES];
+static _Atomic(JournalEntry *) journalHead = NULL; // Newest first
+static int registrationsReady = 0;
+static long journalOffset = 0;        // Bytes of the journal applied here (menu thread)
+static char journalStamp[32] = "";    // The compaction those bytes belong to
+
+#define JOURNAL_STAMP_HEADER "#compacted="
+
+static const char* registrationsFile() {
+    static char path[MAX_LINE_LENGTH];
+    snprintf(path, sizeof(path), "%s/registrations.dat", dataDirectory);
+    return path;
+}
+
+// Takes the exclusive registrations lock; release it with closeTable()
+static FILE* lockRegistrations() {
+    char path[MAX_LINE_LENGTH];
+    snprintf(path, sizeof(path), "%s/registrations.lock", dataDirectory);
+    FILE *fp = fopen(path, "a");
+    if (fp && !lockFile(fp, 1)) {
+        fclose(fp);
+        return NULL;
+    }
+    return fp;
+}
+
+static void journalOutcome(char kind, const SeatAccount *account, const char *student) {
+    JournalEntry *entry = (JournalEntry *)malloc(sizeof(JournalEntry));
+    if (entry == NULL) return;
+    snprintf(entry->line, sizeof(entry->line), "%c,%s,%s\n", kind, account->code, student);
+    entry->next = atomic_load(&journalHead);
+    while (!atomic_compare_exchange_weak(&journalHead, &entry->next, entry)) {}
+}
+
+// Everything journaled so far, oldest first
+static JournalEntry* takeJournal() {
+    JournalEntry *entry = atomic_exchange(&journalHead, NULL), *ordered = NULL;
+    while (entry) {
+        JournalEntry *next = entry->next;
+        entry->next = ordered;
+        ordered = entry;
+        entry = next;
+    }
+    return ordered;
+}
+
+static void freeJournal(JournalEntry *entry) {
+    while (entry) {
+        JournalEntry *next = entry->next;
+        free(entry);
+        entry = next;
+    }
+}
+
+// Appends what was journaled since beginRegistrationChange() and releases
+// the lock it returned
+void flushRegistrationJournal(FILE *lock) {
+    JournalEntry *entries = takeJournal();
+    if (entries) {
+        FILE *fp = lock ? fopen(registrationsFile(), "a") : NULL;
+        if (fp == NULL) {
+            printf("Warning: Could not save registrations to %s.\n", registrationsFile());
+        } else {
+            for (JournalEntry *entry = entries; entry; entry = entry->next) fputs(entry->line, fp);
+            fflush(fp);
+            journalOffset = ftell(fp); // Caught up under this lock, so nothing of ours is replayed
+            fclose(fp);
+        }
+        freeJournal(entries);
+    }
+    if (lock) closeTable(lock);
+}
+
+static int seatAccountFor(const char *code) {
+    return findRowByKey(seatAccounts, sizeof(SeatAccount), seatAccountCount, code);
+}
+
+static RegistrationStripe* stripeFor(const char *student, int account) {
+    uint64_t h1, h2;
+    bloomHashes(student, &h1, &h2);
+    return &registrationStripes[(h1 + (uint64_t)account * h2) % REGISTRATION_STRIPES];
+}
+
+// Called with the stripe's lock held
+static Registration* findRegistration(RegistrationStripe *stripe, const char *student, int account) {
+    for (Registration *r = stripe->head; r; r = r->next) {
+        if (r->account == account && strcmp(r->student, student) == 0) return r;
+    }
+    return NULL;
+}
+
+// Called with the stripe's lock held
+static void unlinkRegistration(RegistrationStripe *stripe, Registration *target) {
+    for (Registration **link = &stripe->head; *link; link = &(*link)->next) {
+        if (*link == target) {
+            *link = target->next;
+            return;
+        }
+    }
+}
+
+static int tryTakeSeat(SeatAccount *account) {
+    int capacity = atomic_load(&account->capacity);
+    int taken = atomic_load(&account->taken);
+    while (capacity == 0 || taken < capacity) {
+        if (atomic_compare_exchange_weak(&account->taken, &taken, taken + 1)) return 1;
+    }
+    return 0;
+}
+
+// The waitlist helpers are called with the account's lock held
+static void appendWaiting(SeatAccount *account, Registration *r) {
+    r->nextWaiting = NULL;
+    if (account->waitTail) account->waitTail->nextWaiting = r;
+    else account->waitHead = r;
+    account->waitTail = r;
+    atomic_fetch_add(&account->waiting, 1);
+}
+
+static void unlinkWaiting(SeatAccount *account, Registration *target) {
+    Registration *previous = NULL;
+    for (Registration *r = account->waitHead; r; previous = r, r = r->nextWaiting) {
+        if (r != target) continue;
+        if (previous) previous->nextWaiting = r->nextWaiting;
+        else account->waitHead = r->nextWaiting;
+        if (account->waitTail == r) account->waitTail = previous;
+        atomic_fetch_sub(&account->waiting, 1);
+        return;
+    }
+}
+
+// Fills seats that opened up (a larger capacity) from the head of the waitlist
+static void promoteWaiting(SeatAccount *account) {
+    while (account->waitHead && tryTakeSeat(account)) {
+        Registration *r = account->waitHead;
+        unlinkWaiting(account, r);
+        atomic_store(&r->state, SEAT_ENROLLED);
+        journalOutcome('P', account, r->student);
+    }
+}
+
+// Finds or opens the account of a course and applies its capacity
+static int openSeatAccount(const char *code, int capacity) {
+    int index = seatAccountFor(code);
+    if (index < 0) {
+        if (seatAccountCount >= MAX_SEAT_ACCOUNTS) return -1;
+        index = seatAccountCount;
+        SeatAccount *account = &seatAccounts[index];
+        snprintf(account->code, MAX_ID_LENGTH, "%s", code);
+        atomic_init(&account->taken, 0);
+        atomic_init(&account->waiting, 0);
+        mutexInit(&account->lock);
+        account->waitHead = account->waitTail = NULL;
+        seatAccountCount++;
+    }
+    SeatAccount *account = &seatAccounts[index];
+    atomic_store(&account->capacity, capacity < 0 ? 0 : capacity);
+    mutexLock(&account->lock);
+    promoteWaiting(account);
+    mutexUnlock(&account->lock);
+    return index;
+}
+
+// Keeps the seat accounts in step with the course table
+void syncCourseSeats(TableID table) {
+    if (table != TABLE_COURSES || !registrationsReady) return;
+    for (int i = 0; i < courseCount; i++) {
+        if (openSeatAccount(courses[i].code, courses[i].capacity) < 0) {
+            printf("Warning: No seat account left for %s; registration for it is closed.\n", courses[i].code);
+        }
+    }
+}
+
+static void initRegistrationEngine() {
+    for (int s = 0; s < REGISTRATION_STRIPES; s++) mutexInit(&registrationStripes[s].lock);
+    registrationsReady = 1;
+    syncCourseSeats(TABLE_COURSES);
+}
+
+RegistrationResult registerForCourse(const char *student, const char *code) {
+    int index = seatAccountFor(code);
+    if (index < 0) return REG_UNKNOWN_COURSE;
+    SeatAccount *account = &seatAccounts[index];
+
+    RegistrationStripe *stripe = stripeFor(student, index);
+    mutexLock(&stripe->lock);
+    if (findRegistration(stripe, student, index)) {
+        mutexUnlock(&stripe->lock);
+        return REG_ALREADY;
+    }
+    Registration *r = (Registration *)calloc(1, sizeof(Registration));
+    if (r == NULL) {
+        mutexUnlock(&stripe->lock);
+        return REG_FAILED;
+    }
+    snprintf(r->student, MAX_ID_LENGTH, "%s", student);
+    r->account = index;
+    atomic_init(&r->state, SEAT_PENDING);
+    r->next = stripe->head;
+    stripe->head = r;
+    mutexUnlock(&stripe->lock);
+
+    if (tryTakeSeat(account)) { // Seats left: no lock at all
+        atomic_store(&r->state, SEAT_ENROLLED);
+        journalOutcome('E', account, student);
+        return REG_ENROLLED;
+    }
+    mutexLock(&account->lock);
+    RegistrationResult result = REG_WAITLISTED;
+    if (tryTakeSeat(account)) { // A seat was released before we got the lock
+        atomic_store(&r->state, SEAT_ENROLLED);
+        journalOutcome('E', account, student);
+        result = REG_ENROLLED;
+    } else {
+        appendWaiting(account, r);
+        atomic_store(&r->state, SEAT_WAITLISTED);
+        journalOutcome('W', account, student);
+    }
+    mutexUnlock(&account->lock);
+    return result;
+}
+
+RegistrationResult dropCourse(const char *student, const char *code) {
+    int index = seatAccountFor(code);
+    if (index < 0) return REG_UNKNOWN_COURSE;
+    SeatAccount *account = &seatAccounts[index];
+
+    RegistrationStripe *stripe = stripeFor(student, index);
+    mutexLock(&stripe->lock);
+    Registration *r = findRegistration(stripe, student, index);
+    if (r) unlinkRegistration(stripe, r);
+    mutexUnlock(&stripe->lock);
+    if (r == NULL) return REG_NOT_REGISTERED;
+
+    mutexLock(&account->lock);
+    if (atomic_load(&r->state) == SEAT_WAITLISTED) {
+        unlinkWaiting(account, r);
+        journalOutcome('X', account, student);
+    } else {
+        journalOutcome('D', account, student);
+        Registration *next = account->waitHead;
+        if (next) { // The seat passes on without the count ever dropping
+            unlinkWaiting(account, next);
+            atomic_store(&next->state, SEAT_ENROLLED);
+            journalOutcome('P', account, next->student);
+        } else {
+            atomic_fetch_sub(&account->taken, 1);
+        }
+    }
+    mutexUnlock(&account->lock);
+    free(r);
+    return REG_DROPPED;
+}
+
+// SeatState of a student's registration, or -1 when there is none. For a
+// waitlist place, 'position' (if not NULL) gets its 1-based place in the queue.
+int registrationState(const char *student, const char *code, int *position) {
+    int index = seatAccountFor(code);
+    if (index < 0) return -1;
+    SeatAccount *account = &seatAccounts[index];
+    RegistrationStripe *stripe = stripeFor(student, index);
+    mutexLock(&stripe->lock);
+    Registration *r = findRegistration(stripe, student, index);
+    int state = r ? atomic_load(&r->state) : -1;
+    mutexUnlock(&stripe->lock);
+
+    if (state == SEAT_WAITLISTED && position) {
+        *position = 0;
+        mutexLock(&account->lock);
+        int place = 1;
+        for (Registration *w = account->waitHead; w; w = w->nextWaiting, place++) {
+            if (strcmp(w->student, student) == 0) {
+                *position = place;
+                break;
+            }
+        }
+        mutexUnlock(&account->lock);
+    }
+    return state;
+}
+
+void seatCounts(const char *code, int *taken, int *capacity, int *waiting) {
+    int index = seatAccountFor(code);
+    *taken = index < 0 ? 0 : atomic_load(&seatAccounts[index].taken);
+    *capacity = index < 0 ? 0 : atomic_load(&seatAccounts[index].capacity);
+    *waiting = index < 0 ? 0 : atomic_load(&seatAccounts[index].waiting);
+}
+
+// Applies one journal line as recorded. Capacities are not rechecked: every
+// instance decides under the lock on a caught-up state, so the journal only
+// exceeds a capacity that was lowered later, and those seats are kept.
+static void replayOutcome(char kind, const char *code, const char *student) {
+    int index = seatAccountFor(code);
+    if (index < 0) index = openSeatAccount(code, 0); // A course deleted since
+    if (index < 0) return;
+    SeatAccount *account = &seatAccounts[index];
+    RegistrationStripe *stripe = stripeFor(student, index);
+    Registration *r = findRegistration(stripe, student, index);
+
+    if (kind == 'E' || kind == 'W') {
+        if (r) return;
+        r = (Registration *)calloc(1, sizeof(Registration));
+        if (r == NULL) return;
+        snprintf(r->student, MAX_ID_LENGTH, "%s", student);
+        r->account = index;
+        r->next = stripe->head;
+        stripe->head = r;
+        if (kind == 'E') {
+            atomic_init(&r->state, SEAT_ENROLLED);
+            atomic_fetch_add(&account->taken, 1);
+        } else {
+            atomic_init(&r->state, SEAT_WAITLISTED);
+            appendWaiting(account, r);
+        }
+    } else if (r && kind == 'P' && atomic_load(&r->state) == SEAT_WAITLISTED) {
+        unlinkWaiting(account, r);
+        atomic_store(&r->state, SEAT_ENROLLED);
+        atomic_fetch_add(&account->taken, 1);
+    } else if (r && (kind == 'D' || kind == 'X')) {
+        if (atomic_load(&r->state) == SEAT_WAITLISTED) unlinkWaiting(account, r);
+        else atomic_fetch_sub(&account->taken, 1);
+        unlinkRegistration(stripe, r);
+        free(r);
+    }
+}
+
+// Forgets every seat and waitlist place, before a full replay (menu thread)
+static void resetRegistrations() {
+    for (int s = 0; s < REGISTRATION_STRIPES; s++) {
+        Registration *r = registrationStripes[s].head;
+        while (r) {
+            Registration *next = r->next;
+            free(r);
+            r = next;
+        }
+        registrationStripes[s].head = NULL;
+    }
+    for (int a = 0; a < seatAccountCount; a++) {
+        atomic_store(&seatAccounts[a].taken, 0);
+        atomic_store(&seatAccounts[a].waiting, 0);
+        seatAccounts[a].waitHead = seatAccounts[a].waitTail = NULL;
+    }
+}
+
+// Applies the journal from journalOffset on. Called with the registrations
+// lock held; a journal compacted since (another stamp, or shorter than what
+// was read) is replayed from the top.
+static void replayJournal() {
+    FILE *fp = fopen(registrationsFile(), "r");
+    if (fp == NULL) return;
+    char line[MAX_LINE_LENGTH], stamp[sizeof(journalStamp)] = "";
+    size_t headerLength = strlen(JOURNAL_STAMP_HEADER);
+    if (fgets(line, sizeof(line), fp) && strncmp(line, JOURNAL_STAMP_HEADER, headerLength) == 0) {
+        line[strcspn(line, "\r\n")] = '\0';
+        snprintf(stamp, sizeof(stamp), "%.*s", (int)sizeof(stamp) - 1, line + headerLength);
+    }
+    fseek(fp, 0, SEEK_END);
+    if (strcmp(stamp, journalStamp) != 0 || ftell(fp) < journalOffset) {
+        resetRegistrations();
+        journalOffset = 0;
+        snprintf(journalStamp, sizeof(journalStamp), "%s", stamp);
+    }
+    fseek(fp, journalOffset, SEEK_SET);
+    while (fgets(line, sizeof(line), fp)) {
+        char *cursor = line;
+        char *kind = nextLineField(&cursor);
+        char *code = nextLineField(&cursor);
+        char *student = nextLineField(&cursor);
+        if (kind == NULL || code == NULL || student == NULL) continue;
+        normalizeString(student);
+        replayOutcome(kind[0], code, student);
+    }
+    journalOffset = ftell(fp);
+    fclose(fp);
+}
+
+// Takes the registrations lock and catches up with what other instances
+// journaled; decide requests, then hand the lock to flushRegistrationJournal()
+FILE* beginRegistrationChange() {
+    FILE *lock = lockRegistrations();
+    if (lock) replayJournal();
+    return lock;
+}
+
+// Writes the current seats and waitlists as a fresh, newly stamped journal.
+// Called with the registrations lock held; the old journal stays in place
+// until the new one is complete on disk.
+static void compactRegistrations() {
+    char tempPath[MAX_LINE_LENGTH + 8], stamp[sizeof(journalStamp)];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", registrationsFile());
+    snprintf(stamp, sizeof(stamp), "%lld", (long long)time(NULL) * 1000 + (long long)monotonicMillis() % 1000);
+    FILE *fp = fopen(tempPath, "w");
+    if (fp == NULL) return;
+    fprintf(fp, JOURNAL_STAMP_HEADER "%s\n", stamp);
+    for (int s = 0; s < REGISTRATION_STRIPES; s++) {
+        for (Registration *r = registrationStripes[s].head; r; r = r->next) {
+            if (atomic_load(&r->state) == SEAT_ENROLLED) fprintf(fp, "E,%s,%s\n", seatAccounts[r->account].code, r->student);
+        }
+    }
+    for (int a = 0; a < seatAccountCount; a++) {
+        for (Registration *r = seatAccounts[a].waitHead; r; r = r->nextWaiting) {
+            fprintf(fp, "W,%s,%s\n", seatAccounts[a].code, r->student);
+        }
+    }
+    int ok = fflush(fp) == 0 && !ferror(fp);
+    if (ok) syncFileToDisk(fp);
+    long size = ftell(fp);
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok || !replaceFile(tempPath, registrationsFile())) {
+        remove(tempPath); // The uncompacted journal is still complete
+        return;
+    }
+    snprintf(journalStamp, sizeof(journalStamp), "%s", stamp);
+    journalOffset = size;
+}
+
+// Opens the registration engine on first use (menu thread)
+void loadRegistrations() {
+    if (registrationsReady) return;
+    ensureTableLoaded(TABLE_COURSES);
+    initRegistrationEngine();
+
+    FILE *lock = lockRegistrations(); // No other instance may append until the rewrite is in place
+    FILE *fp = fopen(registrationsFile(), "r");
+    if (fp == NULL) {
+        if (lock) closeTable(lock);
+        return;
+    }
+    fclose(fp);
+    replayJournal();
+    // Capacities may have grown since the journal was written
+    for (int a = 0; a < seatAccountCount; a++) {
+        mutexLock(&seatAccounts[a].lock);
+        promoteWaiting(&seatAccounts[a]);
+        mutexUnlock(&seatAccounts[a].lock);
+    }
+    freeJournal(takeJournal()); // The compacted file already holds those promotions
+    compactRegistrations();
+    if (lock) closeTable(lock);
+}
+
+// --- Stress test (--stress-registration) ---
+
+typedef struct StressWorker {
+    int firstStudent;
+    int students;
+    int requests;
+    unsigned seed;
+} StressWorker;
+
+static atomic_int stressRunning;
+static atomic_int stressOversubscribed;
+
+THREAD_FUNC(stressWorkerMain, arg) {
+    StressWorker *worker = (StressWorker *)arg;
+    char student[MAX_ID_LENGTH];
+    for (int i = 0; i < worker->requests; i++) {
+        worker->seed = worker->seed * 1103515245u + 12345u;
+        unsigned pick = worker->seed >> 8;
+        snprintf(student, sizeof(student), "S%06d", worker->firstStudent + (int)(pick % (unsigned)worker->students));
+        const char *code = courses[(pick / 7) % (unsigned)courseCount].code;
+        // Students register, and about a third of repeat picks drop instead
+        if (registerForCourse(student, code) == REG_ALREADY && pick % 3 == 0) dropCourse(student, code);
+    }
+    THREAD_RETURN;
+}
+
+// Samples every seat count while the workers run
+THREAD_FUNC(stressMonitorMain, arg) {
+    (void)arg;
+    while (atomic_load(&stressRunning)) {
+        for (int a = 0; a < seatAccountCount; a++) {
+            int capacity = atomic_load(&seatAccounts[a].capacity);
+            if (capacity && atomic_load(&seatAccounts[a].taken) > capacity) atomic_fetch_add(&stressOversubscribed, 1);
+        }
+    }
+    THREAD_RETURN;
+}
+
+// Hammers synthetic courses from 'threads' threads, then checks that no
+// course was ever over capacity, that every count matches the registrations
+// behind it, that no seat sits free while someone waits, and that replaying
+// the journal gives the same counts. Nothing is saved.
+int stressRegistration(int requests, int threads) {
+    if (threads > MAX_AUDIT_THREADS) threads = MAX_AUDIT_THREADS;
+    courseCount = 20;
+    for (int i = 0; i < courseCount; i++) {
+        memset(&courses[i], 0, sizeof(Course));
+        snprintf(courses[i].code, MAX_ID_LENGTH, "R%02d", i);
+        courses[i].capacity = (i == 0) ? 0 : 5 * (1 + i % 4); // R00 is unlimited
+    }
+    initRegistrationEngine();
+
+    StressWorker workers[MAX_AUDIT_THREADS];
+    Thread handles[MAX_AUDIT_THREADS], monitor;
+    int started[MAX_AUDIT_THREADS];
+    atomic_store(&stressRunning, 1);
+    int monitoring = threadStart(&monitor, stressMonitorMain, NULL);
+    double start = monotonicMillis();
+    for (int t = 0; t < threads; t++) {
+        StressWorker worker = { t * 200, 200, requests / threads + (t < requests % threads), 2166136261u + (unsigned)t };
+        workers[t] = worker;
+        started[t] = threadStart(&handles[t], stressWorkerMain, &workers[t]);
+        if (!started[t]) stressWorkerMain(&workers[t]);
+    }
+    for (int t = 0; t < threads; t++) {
+        if (started[t]) threadJoin(handles[t]);
+    }
+    double elapsed = monotonicMillis() - start;
+    atomic_store(&stressRunning, 0);
+    if (monitoring) threadJoin(monitor);
+
+    // Replay the journal into plain counters
+    int replayTaken[MAX_SEAT_ACCOUNTS] = {0}, replayWaiting[MAX_SEAT_ACCOUNTS] = {0};
+    int outcomes[128] = {0};
+    JournalEntry *journal = takeJournal();
+    for (JournalEntry *entry = journal; entry; entry = entry->next) {
+        char kind = entry->line[0], code[MAX_ID_LENGTH];
+        sscanf(entry->line + 2, "%14[^,]", code);
+        int a = seatAccountFor(code);
+        outcomes[(unsigned char)kind]++;
+        if (kind == 'E' || kind == 'P') replayTaken[a]++;
+        if (kind == 'D') replayTaken[a]--;
+        if (kind == 'W') replayWaiting[a]++;
+        if (kind == 'P' || kind == 'X') replayWaiting[a]--;
+    }
+    freeJournal(journal);
+
+    int problems = 0, seats = 0, waiting = 0;
+    for (int a = 0; a < seatAccountCount; a++) {
+        SeatAccount *account = &seatAccounts[a];
+        int enrolled = 0, queued = 0, listed = 0;
+        for (int s = 0; s < REGISTRATION_STRIPES; s++) {
+            for (Registration *r = registrationStripes[s].head; r; r = r->next) {
+                if (r->account != a) continue;
+                if (atomic_load(&r->state) == SEAT_ENROLLED) enrolled++;
+                else if (atomic_load(&r->state) == SEAT_WAITLISTED) queued++;
+            }
+        }
+        for (Registration *r = account->waitHead; r; r = r->nextWaiting) listed++;
+        int taken = atomic_load(&account->taken), capacity = atomic_load(&account->capacity);
+        int ok = (capacity == 0 || taken <= capacity) && taken == enrolled && queued == listed &&
+                 listed == atomic_load(&account->waiting) && (listed == 0 || taken == capacity) &&
+                 replayTaken[a] == taken && replayWaiting[a] == listed;
+        if (!ok) {
+            printf("FAILED %s: %d/%d seats, %d enrolled, %d waiting (%d queued), journal %d/%d\n",
+                   account->code, taken, capacity, enrolled, queued, listed, replayTaken[a], replayWaiting[a]);
+            problems++;
+        }
+        seats += taken;
+        waiting += listed;
+    }
+    int oversubscribed = atomic_load(&stressOversubscribed);
+    printf("Processed %d requests on %d thread(s) in %.2f ms (%.0f requests/s).\n",
+           requests, threads, elapsed, elapsed > 0 ? requests / elapsed * 1000.0 : 0.0);
+    printf("Outcomes: %d enrolled, %d waitlisted, %d promoted, %d dropped, %d left a waitlist.\n",
+           outcomes['E'], outcomes['W'], outcomes['P'], outcomes['D'], outcomes['X']);
+    printf("Final state: %d seats held, %d students waiting across %d courses.\n", seats, waiting, seatAccountCount);
+    if (oversubscribed) printf("FAILED: a course was seen over capacity %d time(s).\n", oversubscribed);
+    if (problems || oversubscribed) return 0;
+    printf("Check passed: no course was oversubscribed and every count matches its registrations.\n");
+    return 1;
+}
+
+// --- ACADEMIC CALENDAR (DATE-INDEXED NOTICES) ---
+// notices.dat is append-only: 'N' lines post a notice and 'R' lines retract one,
+// so an edit never rewrites the file. Expired notices stay in the array as the
+// archive; the two sorted indexes let date queries binary-search past them.
+
+#define LEGACY_NOTICE_DAYS 365 // How long notices imported from notices.txt stay up
+
+const char* audienceToString(NoticeAudience audience) {
+    switch (audience) {
+        case AUDIENCE_STUDENT: return "student";
+        case AUDIENCE_ADMIN: return "admin";
+        default: return "all";
+    }
+}
+
+NoticeAudience audienceFromString(const char *str) {
+    if (strcmp(str, "student") == 0) return AUDIENCE_STUDENT;
+    if (strcmp(str, "admin") == 0) return AUDIENCE_ADMIN;
+    return AUDIENCE_ALL;
+}
+
+// Any edit to the calendar drops the pre-rendered board
+void invalidateNoticeBoard() {
+    invalidateView(VIEW_NOTICE_BOARD);
+}
+
+int findNoticeIndex(int id) {
+    for (int i = 0; i < noticeCount; i++) {
+        if (notices[i].id == id) return i;
+    }
+    return -1;
+}
+
+static int compareByPublish(const void *a, const void *b) {
+    const Notice *na = &notices[*(const int *)a];
+    const Notice *nb = &notices[*(const int *)b];
+    if (na->publishDate != nb->publishDate) return (na->publishDate < nb->publishDate) ? -1 : 1;
+    return na->id - nb->id;
+}
+
+static int compareByExpiry(const void *a, const void *b) {
+    const Notice *na = &notices[*(const int *)a];
+    const Notice *nb = &notices[*(const int *)b];
+    if (na->expiryDate != nb->expiryDate) return (na->expiryDate < nb->expiryDate) ? -1 : 1;
+    return na->id - nb->id;
+}
+
+void rebuildNoticeIndexes() {
+    for (int i = 0; i < noticeCount; i++) {
+        noticesByPublish[i] = i;
+        noticesByExpiry[i] = i;
+    }
+    qsort(noticesByPublish, noticeCount, sizeof(int), compareByPublish);
+    qsort(noticesByExpiry, noticeCount, sizeof(int), compareByExpiry);
+    invalidateNoticeBoard();
+}
+
+// First position in noticesByExpiry whose expiry is on or after 'date'
+int lowerBoundByExpiry(int date) {
+    int lo = 0, hi = noticeCount;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (notices[noticesByExpiry[mid]].expiryDate < date) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+// First position in noticesByPublish whose publish date is after 'date'
+int upperBoundByPublish(int date) {
+    int lo = 0, hi = noticeCount;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (notices[noticesByPublish[mid]].publishDate <= date) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+int noticeVisibleTo(const Notice *n, UserRole role) {
+    if (role == ROLE_ADMIN) return 1; // Admins see every audience
+    if (n->audience == AUDIENCE_ALL) return 1;
+    return (n->audience == AUDIENCE_STUDENT && role == ROLE_STUDENT);
+}
+
+// Removes a notice from an array (used for retractions)
+static void removeNoticeAt(Notice *list, int *count, int index) {
+    for (int i = index; i < *count - 1; i++) {
+        list[i] = list[i + 1];
+    }
+    (*count)--;
+}
+
+// Replays the append-only calendar file into 'dst'. Returns the number of live
+// notices (or -1 if the file cannot be opened) and sets the next free notice ID.
+int parseNoticeFile(const char *path, Notice *dst, int max, int *nextID, int *version) {
+    *nextID = 1;
+    *version = 0;
+    FILE *fp = openTableForRead(path);
+    if (fp == NULL) return -1;
+
+    int count = 0;
+    char line[MAX_LINE_LENGTH + 64];
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        normalizeString(line);
+        if (isHeaderLine(line, version) || line[0] == '\0') continue;
+
+        if (line[0] == 'R' && line[1] == ';') {
+            int id = atoi(line + 2);
+            for (int i = 0; i < count; i++) {
+                if (dst[i].id == id) { removeNoticeAt(dst, &count, i); break; }
+            }
+            continue;
+        }
+        if (line[0] != 'N' || line[1] != ';' || count >= max) continue;
+
+        // N;id;publish;expiry;audience;category;text (text may itself contain ';')
+        char *fields[6];
+        char *cursor = line + 2;
+        int ok = 1;
+        for (int f = 0; f < 5; f++) {
+            char *sep = strchr(cursor, ';');
+            if (sep == NULL) { ok = 0; break; }
+            *sep = '\0';
+            fields[f] = cursor;
+            cursor = sep + 1;
+        }
+        if (!ok) continue;
+        fields[5] = cursor;
+
+        Notice *n = &dst[count];
+        n->id = atoi(fields[0]);
+        n->publishDate = parseDate(fields[1]);
+        n->expiryDate = parseDate(fields[2]);
+        if (n->id <= 0 || n->publishDate == 0 || n->expiryDate == 0) continue;
+        n->audience = audienceFromString(fields[3]);
+        strncpy(n->category, fields[4], MAX_CATEGORY_LENGTH - 1); n->category[MAX_CATEGORY_LENGTH - 1] = '\0';
+        strncpy(n->text, fields[5], MAX_LINE_LENGTH - 1); n->text[MAX_LINE_LENGTH - 1] = '\0';
+
+        if (n->id >= *nextID) *nextID = n->id + 1;
+        count++;
+    }
+    closeTable(fp);
+    return count;
+}
+
+// "N;id;publish;expiry;audience;category;text\n", as stored in notices.dat
+static void formatNoticeLine(const Notice *n, char *line, size_t size) {
+    char publish[16], expiry[16];
+    formatDate(n->publishDate, publish, sizeof(publish));
+    formatDate(n->expiryDate, expiry, sizeof(expiry));
+    snprintf(line, size, "N;%d;%s;%s;%s;%s;%s\n", n->id, publish, expiry,
+             audienceToString(n->audience), n->category, n->text);
+}
+
+// Older versions kept the calendar as free text in notices.txt. Without a
+// notices.dat yet, each of its lines becomes a general notice for everyone,
+// published today; notices.txt itself is left in place.
+static void importLegacyNotices() {
+    char path[MAX_LINE_LENGTH];
+    snprintf(path, sizeof(path), "%s/notices.txt", dataDirectory);
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) return;
+
+    Notice n;
+    memset(&n, 0, sizeof(n));
+    n.publishDate = todayDate();
+    n.expiryDate = addDaysToDate(n.publishDate, LEGACY_NOTICE_DAYS);
+    n.audience = AUDIENCE_ALL;
+    snprintf(n.category, sizeof(n.category), "general");
+    TextBuffer body = {0};
+    char line[MAX_LINE_LENGTH], formatted[MAX_LINE_LENGTH + 96];
+    tbAppendf(&body, "# Academic Calendar File (append-only)\n");
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        normalizeString(line);
+        if (line[0] == '\0' || strncmp(line, "***", 3) == 0) continue; // The old title line
+        n.id++;
+        snprintf(n.text, sizeof(n.text), "%s", line);
+        formatNoticeLine(&n, formatted, sizeof(formatted));
+        tbAppendf(&body, "%s", formatted);
+    }
+    fclose(fp);
+    // Version 0 is an empty file: if another instance imported first, its copy stands
+    if (n.id > 0 && writeTableFile(TABLE_NOTICES, body.data, 0) == 1) {
+        fprintf(stderr, "Imported %d notice(s) from %s.\n", n.id, path); // Kept off CSV/JSON output
+    }
+    free(body.data);
+}
+
+// Loads the calendar file and builds both date indexes
+void loadNotices() {
+    noticeCount = parseNoticeFile(tableFiles[TABLE_NOTICES], notices, MAX_NOTICES, &nextNoticeID, &tableVersions[TABLE_NOTICES]);
+    if (noticeCount < 0) {
+        importLegacyNotices();
+        noticeCount = parseNoticeFile(tableFiles[TABLE_NOTICES], notices, MAX_NOTICES, &nextNoticeID, &tableVersions[TABLE_NOTICES]);
+    }
+    if (noticeCount < 0) noticeCount = 0;
+    rebuildNoticeIndexes();
+}
+
+// Appends a notice line; returns 1 on success. If another instance has
+// extended the calendar meanwhile, reloads it first and takes the next free ID.
+int appendNoticeToFile(Notice *n) {
+    for (int attempt = 0; attempt < MAX_SAVE_ATTEMPTS; attempt++) {
+        char line[MAX_LINE_LENGTH + 96];
+        formatNoticeLine(n, line, sizeof(line));
+        int result = appendTableLine(TABLE_NOTICES, line, tableVersions[TABLE_NOTICES]);
+        if (result == 1) return 1;
+        if (result < 0) break;
+        loadNotices();
+        n->id = nextNoticeID;
+    }
+    printf("Error: Could not write notices.dat.\n");
+    return 0;
+}
+
+int appendRetractionToFile(int id) {
+    char line[32];
+    snprintf(line, sizeof(line), "R;%d\n", id);
+    for (int attempt = 0; attempt < MAX_SAVE_ATTEMPTS; attempt++) {
+        int result = appendTableLine(TABLE_NOTICES, line, tableVersions[TABLE_NOTICES]);
+        if (result == 1) return 1;
+        if (result < 0) break;
+        loadNotices();
+        if (findNoticeIndex(id) == -1) return 1; // Already retracted by another instance
+    }
+    printf("Error: Could not write notices.dat.\n");
+    return 0;
+}
+
+static void renderNoticeLine(TextBuffer *tb, const Notice *n, int showExpiry) {
+    char date[16];
+    formatDate(showExpiry ? n->expiryDate : n->publishDate, date, sizeof(date));
+    tbAppendf(tb, "   [%s] %-8s %s\n", date, n->category, n->text);
+}
+
+// Writes the notice board for today as seen by 'role' (the view variant)
+static void buildNoticeBoard(TextBuffer *tb, int width, int role) {
+    (void)width; // Plain lines, nothing to fit
+    int today = todayDate();
+    int weekEnd = addDaysToDate(today, 7);
+    int shown;
+
+    // Active today: expiry >= today (binary search skips the archive), publish <= today
+    tbAppendf(tb, "--- Active Today ---\n");
+    shown = 0;
+    for (int pos = lowerBoundByExpiry(today); pos < noticeCount; pos++) {
+        const Notice *n = &notices[noticesByExpiry[pos]];
+        if (n->publishDate <= today && noticeVisibleTo(n, role)) {
+            renderNoticeLine(tb, n, 1);
+            shown++;
+        }
+    }
+    if (shown == 0) tbAppendf(tb, "   No active notices.\n");
+
+    // This week: notices that start within the next 7 days
+    tbAppendf(tb, "\n--- Coming Up This Week ---\n");
+    shown = 0;
+    for (int pos = upperBoundByPublish(today); pos < noticeCount; pos++) {
+        const Notice *n = &notices[noticesByPublish[pos]];
+        if (n->publishDate > weekEnd) break;
+        if (noticeVisibleTo(n, role)) {
+            renderNoticeLine(tb, n, 0);
+            shown++;
+        }
+    }
+    if (shown == 0) tbAppendf(tb, "   Nothing new this week.\n");
+
+    // Upcoming exams: exam notices are dated by their expiry (the exam day)
+    tbAppendf(tb, "\n--- Upcoming Exams ---\n");
+    shown = 0;
+    for (int pos = lowerBoundByExpiry(today); pos < noticeCount; pos++) {
+        const Notice *n = &notices[noticesByExpiry[pos]];
+        if (strcmp(n->category, "exam") == 0 && noticeVisibleTo(n, role)) {
+            renderNoticeLine(tb, n, 1);
+            shown++;
+        }
+    }
+    if (shown == 0) tbAppendf(tb, "   No exams scheduled.\n");
+}
+
+// Returns the cached notice board for today and the given role. It is only
+// re-rendered after an edit or when the date rolls over.
+const char* renderNoticeBoard(UserRole role) {
+    return cachedView(VIEW_NOTICE_BOARD, role, todayDate(), buildNoticeBoard);
+}
+
+
+// --- SLAB ALLOCATOR (SMALL FIXED-SIZE NODES) ---
+// Nodes are carved out of slabs that each hold SLAB_OBJECTS_PER_SLAB objects.
+// A single delete puts the node on the pool's free list, and the next
+// allocation reuses it. slabReset releases every node in O(1): it rewinds the
+// carving cursor to the first slab and keeps the slabs for the next load.
+// slabDestroy hands the slabs back to the C heap.
+
+static void* slabObjectAt(const SlabPool *pool, Slab *slab, size_t index) {
+    return (char *)slab + SLAB_HEADER_SIZE + index * pool->objectSize;
+}
+
+void slabInit(SlabPool *pool, const char *name, size_t objectSize) {
+    memset(pool, 0, sizeof(*pool));
+    pool->name = name;
+    // Every object must be able to hold the free-list link
+    if (objectSize < sizeof(void *)) objectSize = sizeof(void *);
+    pool->objectSize = (objectSize + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    pool->objectsPerSlab = SLAB_OBJECTS_PER_SLAB;
+}
+
+void* slabAlloc(SlabPool *pool) {
+    void *object;
+    if (pool->freeList) {
+        object = pool->freeList;
+        pool->freeList = *(void **)object;
+        pool->freeListLength--;
+        pool->reuses++;
+    } else {
+        if (pool->current == NULL || pool->currentUsed == pool->objectsPerSlab) {
+            Slab *next = pool->current ? pool->current->next : pool->first;
+            if (next == NULL) { // Every slab is in use; grow the pool
+                next = (Slab *)malloc(SLAB_HEADER_SIZE + pool->objectSize * pool->objectsPerSlab);
+                if (next == NULL) return NULL;
+                next->next = NULL;
+                if (pool->last) pool->last->next = next; else pool->first = next;
+                pool->last = next;
+                pool->slabCount++;
+            }
+            pool->current = next;
+            pool->currentUsed = 0;
+        }
+        object = slabObjectAt(pool, pool->current, pool->currentUsed++);
+    }
+    pool->allocations++;
+    pool->liveObjects++;
+    if (pool->liveObjects > pool->peakObjects) pool->peakObjects = pool->liveObjects;
+    return object;
+}
+
+void slabFree(SlabPool *pool, void *object) {
+    if (object == NULL) return;
+    *(void **)object = pool->freeList;
+    pool->freeList = object;
+    pool->freeListLength++;
+    pool->frees++;
+    pool->liveObjects--;
+}
+
+// Releases every object at once; the slabs stay allocated for reuse
+void slabReset(SlabPool *pool) {
+    pool->current = NULL; // slabAlloc starts again from pool->first
+    pool->currentUsed = 0;
+    pool->freeList = NULL;
+    pool->freeListLength = 0;
+    pool->liveObjects = 0;
+    pool->resets++;
+}
+
+void slabDestroy(SlabPool *pool) {
+    Slab *slab = pool->first;
+    while (slab) {
+        Slab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    slabInit(pool, pool->name, pool->objectSize);
+}
+
+void printSlabStats(const SlabPool *pool) {
+    size_t capacity = pool->slabCount * pool->objectsPerSlab;
+    size_t reserved = pool->slabCount * (SLAB_HEADER_SIZE + pool->objectSize * pool->objectsPerSlab);
+    printf("Pool:                 %s\n", pool->name);
+    printf("Object size:          %zu bytes (%zu per slab)\n", pool->objectSize, pool->objectsPerSlab);
+    printf("Slabs:                %zu (%zu bytes reserved)\n", pool->slabCount, reserved);
+    printf("Live objects:         %zu of %zu slots (%.1f%% used, peak %zu)\n", pool->liveObjects, capacity,
+           capacity ? 100.0 * pool->liveObjects / capacity : 0.0, pool->peakObjects);
+    printf("Free list:            %zu objects\n", pool->freeListLength);
+    printf("Allocations / frees:  %zu / %zu (%zu served from the free list)\n",
+           pool->allocations, pool->frees, pool->reuses);
+    printf("Bulk releases:        %zu\n", pool->resets);
+}
+
+// --- SPATIAL GRID INDEX (NEAREST LOCATIONS) ---
+// Locations may carry campus coordinates in metres ("x,y" as an optional sixth
+// field in university_data.txt). The level comes from the floor name (Ground =
+// 0, "2nd" = 2, Basement = -1) unless it is given as "x,y,level". Positioned
+// nodes are indexed in a uniform grid of GRID_CELL_METERS squares. Cells are
+// hashed into GRID_BUCKETS buckets, so the campus needs no fixed bounds. Each
+// insert and delete touches a single bucket.
+//
+// k-nearest searches ring by ring outward from the query cell and stops once
+// the next ring cannot hold anything closer than the current k-th result.
+// Radius queries visit only the cells that overlap the circle. Distances are
+// 3-D, with LEVEL_HEIGHT_METERS per floor, so the same spot two floors up
+// counts as farther away.
+
+static int gridCellOf(double coordinate) {
+    int cell = (int)(coordinate / GRID_CELL_METERS);
+    if (coordinate < 0 && cell * GRID_CELL_METERS != coordinate) cell--; // Round toward -infinity
+    return cell;
+}
+
+static GridBucket* gridBucketFor(SpatialGrid *grid, int cellX, int cellY) {
+    unsigned int hash = ((unsigned int)cellX * 73856093u) ^ ((unsigned int)cellY * 19349663u);
+    return &grid->buckets[hash % GRID_BUCKETS];
+}
+
+// Newton's method; avoids a libm dependency so a plain "gcc university_guide.c" still links
+static double squareRoot(double value) {
+    if (value <= 0) return 0;
+    double guess = value > 1 ? value : 1;
+    for (int i = 0; i < 64; i++) {
+        double next = 0.5 * (guess + value / guess);
+        if (next >= guess) break;
+        guess = next;
+    }
+    return guess;
+}
+
+static double squaredDistance(const LocationPosition *a, const LocationPosition *b) {
+    double dx = a->x - b->x, dy = a->y - b->y;
+    double dz = (a->level - b->level) * LEVEL_HEIGHT_METERS;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// "Ground"/"G" = 0, "Basement"/"B" = -1, otherwise the leading number ("2nd" = 2)
+int floorLevel(const char *floor) {
+    while (isspace((unsigned char)*floor)) floor++;
+    if (isdigit((unsigned char)*floor) || *floor == '-') return atoi(floor);
+    if (lowerChar(*floor) == 'b') return -1;
+    return 0;
+}
+
+// Parses "x,y" or "x,y,level"; the level defaults to the one named by 'floor'
+int parsePosition(const char *text, const char *floor, LocationPosition *out) {
+    char *end;
+    out->x = strtod(text, &end);
+    if (end == text || *end != ',') return 0;
+    text = end + 1;
+    out->y = strtod(text, &end);
+    if (end == text) return 0;
+    out->level = floorLevel(floor);
+    if (*end == ',') {
+        text = end + 1;
+        out->level = (int)strtol(text, &end, 10);
+        if (end == text) return 0;
+    }
+    while (isspace((unsigned char)*end)) end++;
+    return *end == '\0';
+}
+
+// The optional file field: ";x,y", plus ",level" when the floor name does not imply it
+void formatPositionField(const LocationPosition *position, const char *floor, char *out, size_t size) {
+    if (position == NULL) snprintf(out, size, "%s", "");
+    else if (position->level == floorLevel(floor)) snprintf(out, size, ";%.10g,%.10g", position->x, position->y);
+    else snprintf(out, size, ";%.10g,%.10g,%d", position->x, position->y, position->level);
+}
+
+void formatPosition(const LocationNode *node, char *out, size_t size) {
+    if (!node->hasPosition) snprintf(out, size, "-");
+    else snprintf(out, size, "%g,%g,%d", node->position.x, node->position.y, node->position.level);
+}
+
+void gridInsert(SpatialGrid *grid, LocationNode *node) {
+    if (!node->hasPosition) return;
+    int cellX = gridCellOf(node->position.x), cellY = gridCellOf(node->position.y);
+    GridBucket *bucket = gridBucketFor(grid, cellX, cellY);
+    if (bucket->count == bucket->capacity) {
+        int newCapacity = bucket->capacity ? bucket->capacity * 2 : 4;
+        GridEntry *grown = (GridEntry *)realloc(bucket->entries, sizeof(GridEntry) * newCapacity);
+        if (grown == NULL) return;
+        bucket->entries = grown;
+        bucket->capacity = newCapacity;
+    }
+    bucket->entries[bucket->count++] = (GridEntry){ cellX, cellY, node };
+    if (grid->points++ == 0) {
+        grid->minCellX = grid->maxCellX = cellX;
+        grid->minCellY = grid->maxCellY = cellY;
+    } else {
+        if (cellX < grid->minCellX) grid->minCellX = cellX;
+        if (cellX > grid->maxCellX) grid->maxCellX = cellX;
+        if (cellY < grid->minCellY) grid->minCellY = cellY;
+        if (cellY > grid->maxCellY) grid->maxCellY = cellY;
+    }
+}
+
+void gridRemove(SpatialGrid *grid, LocationNode *node) {
+    if (!node->hasPosition) return;
+    GridBucket *bucket = gridBucketFor(grid, gridCellOf(node->position.x), gridCellOf(node->position.y));
+    for (int i = 0; i < bucket->count; i++) {
+        if (bucket->entries[i].node == node) {
+            bucket->entries[i] = bucket->entries[--bucket->count]; // Order within a bucket does not matter
+            grid->points--;
+            return;
+        }
+    }
+}
+
+// Empties the grid but keeps bucket storage for the next load
+void gridClear(SpatialGrid *grid) {
+    for (int b = 0; b < GRID_BUCKETS; b++) grid->buckets[b].count = 0;
+    grid->points = 0;
+}
+
+void gridFree(SpatialGrid *grid) {
+    for (int b = 0; b < GRID_BUCKETS; b++) free(grid->buckets[b].entries);
+    memset(grid, 0, sizeof(*grid));
+}
+
+// Lowercased filter matched against key, room and description; empty matches all
+static int locationMatchesFilter(const LocationNode *node, const char *filter, size_t filterLength) {
+    return filterLength == 0 || containsIgnoreCase(node->key, filter, filterLength) ||
+           containsIgnoreCase(node->room, filter, filterLength) ||
+           containsIgnoreCase(node->description, filter, filterLength);
+}
+
+// Keeps the best 'limit' hits sorted by distance (insertion into a short array)
+static void offerNearest(NearestHit *hits, int *count, int limit, LocationNode *node, double squared) {
+    if (*count == limit && squared >= hits[limit - 1].distance) return;
+    int pos = (*count < limit) ? (*count)++ : limit - 1;
+    while (pos > 0 && hits[pos - 1].distance > squared) {
+        hits[pos] = hits[pos - 1];
+        pos--;
+    }
+    hits[pos].node = node;
+    hits[pos].distance = squared;
+}
+
+static void visitCell(SpatialGrid *grid, int cellX, int cellY, const LocationPosition *from,
+                      const char *filter, size_t filterLength, NearestHit *hits, int *count, int limit,
+                      double radiusSquared) {
+    GridBucket *bucket = gridBucketFor(grid, cellX, cellY);
+    for (int i = 0; i < bucket->count; i++) {
+        GridEntry *entry = &bucket->entries[i];
+        if (entry->cellX != cellX || entry->cellY != cellY) continue; // Another cell sharing the bucket
+        double squared = squaredDistance(from, &entry->node->position);
+        if (squared > radiusSquared || !locationMatchesFilter(entry->node, filter, filterLength)) continue;
+        offerNearest(hits, count, limit, entry->node, squared);
+    }
+}
+
+// Fills 'hits' with up to 'limit' matching locations nearest to 'from',
+// optionally no farther than 'radius' metres (radius <= 0: unlimited).
+// Returns the number of hits, closest first, with distances in metres.
+int gridNearest(SpatialGrid *grid, const LocationPosition *from, const char *filter,
+                int limit, double radius, NearestHit *hits) {
+    char needle[MAX_NAME_LENGTH];
+    size_t filterLength = 0;
+    int count = 0;
+    if (grid->points == 0 || limit <= 0) return 0;
+    for (; filter && filter[filterLength] && filterLength < sizeof(needle) - 1; filterLength++) {
+        needle[filterLength] = (char)lowerChar(filter[filterLength]);
+    }
+    needle[filterLength] = '\0';
+
+    double radiusSquared = radius > 0 ? radius * radius : 1e300;
+    int centerX = gridCellOf(from->x), centerY = gridCellOf(from->y);
+    // Farthest ring that can still contain points
+    int maxRing = 0, spans[4] = { centerX - grid->minCellX, grid->maxCellX - centerX,
+                                  centerY - grid->minCellY, grid->maxCellY - centerY };
+    for (int i = 0; i < 4; i++) if (spans[i] > maxRing) maxRing = spans[i];
+    if (radius > 0 && (int)(radius / GRID_CELL_METERS) + 1 < maxRing) maxRing = (int)(radius / GRID_CELL_METERS) + 1;
+
+    for (int ring = 0; ring <= maxRing; ring++) {
+        // Everything in this ring is at least (ring - 1) cells away
+        double nearestPossible = (ring - 1) * GRID_CELL_METERS;
+        if (nearestPossible > 0 && count == limit && nearestPossible * nearestPossible > hits[count - 1].distance) break;
+        if (nearestPossible > 0 && nearestPossible * nearestPossible > radiusSquared) break;
+
+        for (int dx = -ring; dx <= ring; dx++) {
+            int edge = (dx == -ring || dx == ring);
+            for (int dy = -ring; dy <= ring; dy += edge ? 1 : 2 * ring) {
+                visitCell(grid, centerX + dx, centerY + dy, from, needle, filterLength, hits, &count, limit, radiusSquared);
+                if (ring == 0) break;
+            }
+        }
+    }
+    for (int i = 0; i < count; i++) hits[i].distance = squareRoot(hits[i].distance);
+    return count;
+}
+
+// Self-check and timing for --bench-nearest: random points, grid answers
+// compared against a brute-force scan
+int benchmarkNearest(int points) {
+    LocationTable *table = (LocationTable *)malloc(sizeof(LocationTable));
+    if (table == NULL) return 0;
+    initLocationTable(table);
+    srand(12345);
+    for (int i = 0; i < points; i++) {
+        char key[MAX_ID_LENGTH];
+        LocationPosition position = { (rand() % 200000) / 100.0, (rand() % 150000) / 100.0, rand() % 5 };
+        snprintf(key, sizeof(key), "p%d", i);
+        insertLocationInto(table, key, "Bench", "0", "R", (i % 7 == 0) ? "Washroom" : "Lab", &position);
+    }
+
+    const int queries = 2000, checked = 200, k = 5;
+    NearestHit hits[MAX_NEAREST], brute[MAX_NEAREST];
+    int mismatches = 0;
+    double knnTime = 0, radiusTime, start;
+    for (int q = 0; q < queries; q++) {
+        LocationPosition from = { (rand() % 200000) / 100.0, (rand() % 150000) / 100.0, rand() % 5 };
+        const char *filter = (q % 2) ? "wash" : "";
+        start = monotonicMillis();
+        int found = gridNearest(&table->grid, &from, filter, k, 0, hits);
+        knnTime += monotonicMillis() - start;
+        if (q < checked) {
+            int expected = 0;
+            for (int b = 0; b < HASH_SIZE; b++) {
+                for (LocationNode *node = table->buckets[b]; node; node = node->next) {
+                    if (!filter[0] || strcmp(node->description, "Washroom") == 0) {
+                        offerNearest(brute, &expected, k, node, squaredDistance(&from, &node->position));
+                    }
+                }
+            }
+            if (expected != found) mismatches++;
+            for (int i = 0; i < found && i < expected; i++) {
+                double diff = hits[i].distance - squareRoot(brute[i].distance);
+                if (diff > 1e-6 || diff < -1e-6) { mismatches++; break; }
+            }
+        }
+    }
+
+    start = monotonicMillis();
+    int within = 0;
+    for (int q = 0; q < queries; q++) {
+        LocationPosition from = { (rand() % 200000) / 100.0, (rand() % 150000) / 100.0, 0 };
+        within += gridNearest(&table->grid, &from, "", MAX_NEAREST, 50.0, hits);
+    }
+    radiusTime = monotonicMillis() - start;
+
+    printf("%d points: %d k-nearest queries (k=%d) in %.1f ms (%.1f us each); %d of %d checked queries disagreed with a full scan.\n",
+           points, queries, k, knnTime, knnTime * 1000.0 / queries, mismatches, checked);
+    printf("%d radius queries (50 m) in %.1f ms (%.1f us each), %d hits.\n",
+           queries, radiusTime, radiusTime * 1000.0 / queries, within);
+    destroyLocationTable(table);
+    free(table);
+    return mismatches == 0;
+}
+
+// --- HASH TABLE (LOCATION GUIDE) IMPLEMENTATION ---
+
+// Simple custom hash function for strings
+int hashFunction(const char *key) {
+    int hash = 0;
+    for (int i = 0; key[i] != '\0'; i++) {
+        hash = (hash * 31 + key[i]) % HASH_SIZE;
+    }
+    return hash;
+}
+
+void initLocationTable(LocationTable *table) {
+    memset(table, 0, sizeof(*table));
+    slabInit(&table->nodes, "LocationNode", sizeof(LocationNode));
+}
+
+// Inserts a new location into the given table; 'position' may be NULL.
+// Returns the new node, or NULL if it could not be allocated.
+LocationNode* insertLocationInto(LocationTable *table, const char *key, const char *building, const char *floor, const char *room, const char *desc, const LocationPosition *position) {
+    int index = hashFunction(key);
+    LocationNode *newNode = (LocationNode *)slabAlloc(&table->nodes);
+    if (newNode == NULL) {
+        printf("Memory allocation failed.\n");
+        return NULL;
+    }
+
+    // Copy data to the new node
+    strncpy(newNode->key, key, MAX_ID_LENGTH - 1); newNode->key[MAX_ID_LENGTH - 1] = '\0';
+    strncpy(newNode->building, building, MAX_NAME_LENGTH - 1); newNode->building[MAX_NAME_LENGTH - 1] = '\0';
+    strncpy(newNode->floor, floor, MAX_ID_LENGTH - 1); newNode->floor[MAX_ID_LENGTH - 1] = '\0';
+    strncpy(newNode->room, room, MAX_ID_LENGTH - 1); newNode->room[MAX_ID_LENGTH - 1] = '\0';
+    strncpy(newNode->description, desc, MAX_NAME_LENGTH - 1); newNode->description[MAX_NAME_LENGTH - 1] = '\0';
+    newNode->hasPosition = (position != NULL);
+    if (position) newNode->position = *position;
+
+    // Insert node at the head of the linked list (Separate Chaining)
+    newNode->next = table->buckets[index];
+    table->buckets[index] = newNode;
+    gridInsert(&table->grid, newNode);
+    return newNode;
+}
+
+// Inserts a new location into the hash table
+void insertLocation(const char *key, const char *building, const char *floor, const char *room, const char *desc, const LocationPosition *position) {
+    LocationNode *node = insertLocationInto(&hashTable, key, building, floor, room, desc, position);
+    if (node) statsRowChanged(TABLE_LOCATIONS, node, 1);
+    keyFilterAdd(TABLE_LOCATIONS, key);
+    publishTable(TABLE_LOCATIONS);
+}
+
+// Empties the table in one step; its slabs are kept for the next load
+void freeLocationTable(LocationTable *table) {
+    memset(table->buckets, 0, sizeof(table->buckets));
+    slabReset(&table->nodes);
+    gridClear(&table->grid);
+}
+
+// Empties the table and returns its memory to the system
+void destroyLocationTable(LocationTable *table) {
+    memset(table->buckets, 0, sizeof(table->buckets));
+    slabDestroy(&table->nodes);
+    gridFree(&table->grid);
+}
+
+// Reads the location file into an (empty) table; returns the number of
+// locations read, or -1 if the file cannot be opened
+// Adds one "key;building;floor;room;description[;x,y[,level]]" line to 'table'
+static int parseLocationLine(char *line, LocationTable *table) {
+    // Tokenize line using ';' delimiter
+    char *cursor = line;
+    char *key = nextToken(&cursor, ';');
+    char *building = nextToken(&cursor, ';');
+    char *floor = nextToken(&cursor, ';');
+    char *room = nextToken(&cursor, ';');
+    char *description = nextToken(&cursor, ';');
+    char *coordinates = nextToken(&cursor, ';'); // Optional
+
+    if (!(key && building && floor && room && description)) return 0;
+    LocationPosition position;
+    normalizeString(key);
+    normalizeString(building);
+    normalizeString(floor);
+    normalizeString(room);
+    normalizeString(description);
+    if (coordinates) normalizeString(coordinates);
+    int positioned = coordinates && parsePosition(coordinates, floor, &position);
+    insertLocationInto(table, key, building, floor, room, description, positioned ? &position : NULL);
+    return 1;
+}
+
+int parseLocationFile(const char *path, LocationTable *table, int *version) {
+    FILE *fp = openTableForRead(path);
+    if (fp == NULL) return -1;
+
+    int count = 0;
+    char line[MAX_LINE_LENGTH];
+    *version = 0;
+    while (fgets(line, MAX_LINE_LENGTH, fp) != NULL) {
+        // Skip comment lines or empty lines
+        if (isHeaderLine(line, version) || strlen(line) < 5) continue;
+
+        if (parseLocationLine(line, table)) count++;
+    }
+    closeTable(fp);
+    return count;
+}
+
+// Reads data from the file into the Hash Table
+void loadLocationData() {
+    // Release existing hash table data first
+    freeLocationTable(&hashTable);
+
+    if (parseLocationFile(tableFiles[TABLE_LOCATIONS], &hashTable, &tableVersions[TABLE_LOCATIONS]) < 0) {
+        printf("Warning: 'university_data.txt' not found or could not be opened. Location features will be empty.\n");
+    }
+    rebuildKeyFilter(TABLE_LOCATIONS);
+    rebuildTableStats(TABLE_LOCATIONS);
+    publishTable(TABLE_LOCATIONS);
+}
+
+static LocationNode* findLocationIn(LocationTable *table, const char *key) {
+    LocationNode *current = table->buckets[hashFunction(key)];
+    while (current && strcmp(current->key, key) != 0) current = current->next;
+    return current;
+}
+
+// Appends a new location to the data file and adds it to the hash table.
+// If another instance changed the file meanwhile, the table is reloaded first
+// so that instance's edits are kept; returns 0 if it already added this key.
+int saveLocationToFile(const char *key, const char *building, const char *floor, const char *room, const char *desc, const LocationPosition *position) {
+    char line[MAX_LINE_LENGTH * 2], coordinates[64];
+    formatPositionField(position, floor, coordinates, sizeof(coordinates));
+    snprintf(line, sizeof(line), "%s;%s;%s;%s;%s%s\n", key, building, floor, room, desc, coordinates);
+
+    drainPersistence(TABLE_LOCATIONS); // The append must follow any rewrite still queued
+    for (int attempt = 0; attempt < MAX_SAVE_ATTEMPTS; attempt++) {
+        int result = appendTableLine(TABLE_LOCATIONS, line, tableVersions[TABLE_LOCATIONS]);
+        if (result == 1) {
+            insertLocation(key, building, floor, room, desc, position);
+            return 1;
+        }
+        if (result < 0) break;
+        loadLocationData();
+        if (findLocationIn(&hashTable, key) != NULL) {
+            printf("Error: Location '%s' was just added by another instance.\n", key);
+            return 0;
+        }
+    }
+    printf("Error: Could not open university_data.txt for writing.\n");
+    return 0;
+}
+
+static void removeLocationFrom(LocationTable *table, const char *key) {
+    int index = hashFunction(key);
+    LocationNode *current = table->buckets[index];
+    LocationNode *prev = NULL;
+    while (current) {
+        if (strcmp(current->key, key) == 0) {
+            if (prev == NULL) table->buckets[index] = current->next; else prev->next = current->next;
+            gridRemove(&table->grid, current);
+            slabFree(&table->nodes, current);
+            return;
+        }
+        prev = current;
+        current = current->next;
+    }
+}
+
+// Location counterpart of mergeStaleArrayTable: adopt the newer file and
+// replay the locations this instance added or deleted
+static void mergeStaleLocationTable() {
+    LocationTable disk;
+    int diskVersion = 0;
+    initLocationTable(&disk);
+    if (parseLocationFile(tableFiles[TABLE_LOCATIONS], &disk, &diskVersion) < 0) {
+        destroyLocationTable(&disk);
+        return;
+    }
+
+    DirtySet *set = &dirtyRecords[TABLE_LOCATIONS];
+    if (set->overflow) {
+        printf("Warning: Too many local edits to merge; locations from another instance will be overwritten.\n");
+        destroyLocationTable(&disk);
+    } else {
+        for (int k = 0; k < set->count; k++) {
+            LocationNode *ours = findLocationIn(&hashTable, set->keys[k]);
+            removeLocationFrom(&disk, set->keys[k]);
+            if (ours) insertLocationInto(&disk, ours->key, ours->building, ours->floor, ours->room, ours->description,
+                                         ours->hasPosition ? &ours->position : NULL);
+        }
+        destroyLocationTable(&hashTable);
+        hashTable = disk; // The merged table's nodes and slabs now belong to hashTable
+        rebuildKeyFilter(TABLE_LOCATIONS);
+        rebuildTableStats(TABLE_LOCATIONS);
+        printf("(Locations were changed by another instance; your edits were merged.)\n");
+    }
+    tableVersions[TABLE_LOCATIONS] = diskVersion;
+}
+
+// One location in the file's format, without the line break
+static void formatLocationLine(TextBuffer *tb, const LocationNode *node) {
+    char coordinates[64];
+    formatPositionField(node->hasPosition ? &node->position : NULL, node->floor,
+                        coordinates, sizeof(coordinates));
+    tbAppendf(tb, "%s;%s;%s;%s;%s%s",
+              node->key,
+              node->building,
+              node->floor,
+              node->room,
+              node->description,
+              coordinates);
+}
+
+// The whole location file body (everything after the version header)
+static void serializeLocationTable(const LocationTable *table, TextBuffer *body) {
+    tbAppendf(body, "# Location Data File\n");
+    tbAppendf(body, "# Format: key;building;floor;room;description[;x,y[,level]]\n");
+    for (int i = 0; i < HASH_SIZE; i++) {
+        for (LocationNode *current = table->buckets[i]; current; current = current->next) {
+            formatLocationLine(body, current);
+            tbAppendBytes(body, "\n", 1);
+        }
+    }
+}
+
+// Rewrites the entire location file from the current Hash Table state
+// (written behind, like the array tables)
+void rewriteLocationFile() {
+    TextBuffer body = {0};
+    serializeLocationTable(&hashTable, &body);
+    queueTableWrite(TABLE_LOCATIONS, &body);
+    publishTable(TABLE_LOCATIONS);
+}
+
+// --- OCCUPANCY TIME SERIES (RING BUFFERS) ---
+// Each location that has seen a check-in or a headcount gets a ring of
+// OCCUPANCY_BUCKETS five-minute buckets (the last 24 hours), allocated once,
+// so history never grows however long the program runs. Each bucket keeps the
+// level it closed at, its peak and its check-ins. The aggregates are kept up
+// to date as samples arrive, never recomputed from the ring:
+//   - the running sums of levels and check-ins over the last hour's buckets;
+//   - a monotonic queue of bucket numbers whose peaks decrease from front to
+//     back, so the 24-hour peak is always at its front.
+// Time only moves forward one bucket at a time, and each step costs O(1), so
+// "how busy is the library" is O(1) after a quiet spell of any length (a gap
+// longer than the ring just refills it once). Like hashTable, the series are
+// touched only by the menu thread.
+
+#define OCCUPANCY_BUCKET_SECONDS 300
+#define OCCUPANCY_BUCKETS 288        // 24 hours of buckets
+#define OCCUPANCY_HOUR_BUCKETS 12
+#define MAX_OCCUPANCY_SERIES 256
+
+typedef struct OccupancyBucket {
+    int level;                       // Occupancy when the bucket closed (or now)
+    int peak;
+    int checkIns;
+} OccupancyBucket;
+
+typedef struct OccupancySeries {
+    char key[MAX_ID_LENGTH];         // Location Task Key
+    int current;
+    long long first, newest;         // Bucket numbers (seconds / OCCUPANCY_BUCKET_SECONDS)
+    OccupancyBucket ring[OCCUPANCY_BUCKETS];
+    long long peakQueue[OCCUPANCY_BUCKETS]; // Bucket numbers, peaks decreasing
+    int peakStart, peakCount;
+    long long hourLevels;            // Sum of 'level' over the last hour's buckets
+    int hourCheckIns;
+    int next;                        // Chain in occupancyIndex, -1 at the end
+} OccupancySeries;
+
+static OccupancySeries *occupancySeries[MAX_OCCUPANCY_SERIES];
+static int occupancySeriesCount = 0;
+static int occupancyIndex[HASH_SIZE]; // First series of each chain, -1 if none
+static int occupancyIndexReady = 0;
+
+static OccupancyBucket* occupancyBucket(OccupancySeries *series, long long bucket) {
+    return &series->ring[bucket % OCCUPANCY_BUCKETS];
+}
+
+static long long* peakQueueAt(OccupancySeries *series, int i) {
+    return &series->peakQueue[(series->peakStart + i) % OCCUPANCY_BUCKETS];
+}
+
+// Pushes the newest bucket after dropping the buckets it out-peaks
+static void peakQueuePush(OccupancySeries *series, long long bucket) {
+    int peak = occupancyBucket(series, bucket)->peak;
+    while (series->peakCount > 0) {
+        long long back = *peakQueueAt(series, series->peakCount - 1);
+        if (back != bucket && occupancyBucket(series, back)->peak > peak) break;
+        series->peakCount--;
+    }
+    *peakQueueAt(series, series->peakCount) = bucket;
+    series->peakCount++;
+}
+
+// Number of the last hour's buckets that the series has been around for
+static int hourBuckets(const OccupancySeries *series) {
+    long long age = series->newest - series->first + 1;
+    return age < OCCUPANCY_HOUR_BUCKETS ? (int)age : OCCUPANCY_HOUR_BUCKETS;
+}
+
+// Brings the series up to 'bucket'. The level did not change while no samples
+// came in, so each new bucket opens (and so far closes) at the current level.
+static void advanceOccupancy(OccupancySeries *series, long long bucket) {
+    if (bucket <= series->newest) return; // Late samples count towards the newest bucket
+    if (bucket - series->newest >= OCCUPANCY_BUCKETS) {
+        // Quiet for a whole day: every bucket in the window is the same
+        OccupancyBucket flat = { series->current, series->current, 0 };
+        for (int i = 0; i < OCCUPANCY_BUCKETS; i++) series->ring[i] = flat;
+        if (series->first < bucket - OCCUPANCY_BUCKETS + 1) series->first = bucket - OCCUPANCY_BUCKETS + 1;
+        series->newest = bucket;
+        series->hourLevels = (long long)series->current * hourBuckets(series);
+        series->hourCheckIns = 0;
+        series->peakStart = 0;
+        series->peakCount = 0;
+        peakQueuePush(series, bucket);
+        return;
+    }
+    while (series->newest < bucket) {
+        long long leaving = ++series->newest - OCCUPANCY_HOUR_BUCKETS;
+        if (leaving >= series->first) {
+            series->hourLevels -= occupancyBucket(series, leaving)->level;
+            series->hourCheckIns -= occupancyBucket(series, leaving)->checkIns;
+        }
+        // The front falls out of the window when its slot is reused
+        if (series->peakCount > 0 && *peakQueueAt(series, 0) <= series->newest - OCCUPANCY_BUCKETS) {
+            series->peakStart = (series->peakStart + 1) % OCCUPANCY_BUCKETS;
+            series->peakCount--;
+        }
+        OccupancyBucket fresh = { series->current, series->current, 0 };
+        *occupancyBucket(series, series->newest) = fresh;
+        series->hourLevels += series->current;
+        peakQueuePush(series, series->newest);
+    }
+}
+
+static OccupancySeries* findOccupancySeries(const char *key, long long bucket, int create) {
+    if (!occupancyIndexReady) {
+        for (int i = 0; i < HASH_SIZE; i++) occupancyIndex[i] = -1;
+        occupancyIndexReady = 1;
+    }
+    int chain = hashFunction(key);
+    for (int s = occupancyIndex[chain]; s >= 0; s = occupancySeries[s]->next) {
+        if (strcmp(occupancySeries[s]->key, key) == 0) return occupancySeries[s];
+    }
+    if (!create || occupancySeriesCount >= MAX_OCCUPANCY_SERIES) return NULL;
+    OccupancySeries *series = (OccupancySeries *)calloc(1, sizeof(OccupancySeries));
+    if (series == NULL) return NULL;
+    snprintf(series->key, MAX_ID_LENGTH, "%s", key);
+    series->first = series->newest = bucket;
+    peakQueuePush(series, bucket);
+    series->next = occupancyIndex[chain];
+    occupancyIndex[chain] = occupancySeriesCount;
+    occupancySeries[occupancySeriesCount++] = series;
+    return series;
+}
+
+// Records one sample for a location at time 'at': a check-in, a check-out,
+// or a headcount that replaces the level. Returns the new occupancy, or -1
+// when no more locations can be tracked.
+int recordOccupancy(const char *key, OccupancySample kind, int count, time_t at) {
+    long long bucket = (long long)at / OCCUPANCY_BUCKET_SECONDS;
+    OccupancySeries *series = findOccupancySeries(key, bucket, 1);
+    if (series == NULL) return -1;
+    advanceOccupancy(series, bucket);
+
+    OccupancyBucket *now = occupancyBucket(series, series->newest);
+    int level = series->current;
+    if (kind == OCCUPANCY_CHECK_IN) {
+        level++;
+        now->checkIns++;
+        series->hourCheckIns++;
+    } else if (kind == OCCUPANCY_CHECK_OUT) {
+        if (level > 0) level--;
+    } else if (count >= 0) {
+        level = count;
+    }
+    series->hourLevels += level - now->level;
+    series->current = now->level = level;
+    if (level > now->peak) {
+        now->peak = level;
+        peakQueuePush(series, series->newest);
+    }
+    return level;
+}
+
+// The rolling aggregates of a location as of time 'at'; 0 if it has no samples
+int occupancySummary(const char *key, time_t at, OccupancySummary *out) {
+    long long bucket = (long long)at / OCCUPANCY_BUCKET_SECONDS;
+    OccupancySeries *series = findOccupancySeries(key, bucket, 0);
+    if (series == NULL) return 0;
+    advanceOccupancy(series, bucket);
+    long long peakBucket = *peakQueueAt(series, 0);
+    out->current = series->current;
+    out->hourAverage = (double)series->hourLevels / hourBuckets(series);
+    out->peak = occupancyBucket(series, peakBucket)->peak;
+    out->peakAt = (time_t)(peakBucket * OCCUPANCY_BUCKET_SECONDS);
+    out->checkInsLastHour = series->hourCheckIns;
+    return 1;
+}
+
+// Levels of the last 'count' buckets (oldest first) as of time 'at'; returns
+// how many exist
+int occupancyRecent(const char *key, time_t at, int *levels, int count) {
+    long long bucket = (long long)at / OCCUPANCY_BUCKET_SECONDS;
+    OccupancySeries *series = findOccupancySeries(key, bucket, 0);
+    if (series == NULL) return 0;
+    advanceOccupancy(series, bucket);
+    long long age = series->newest - series->first + 1;
+    if (count > OCCUPANCY_BUCKETS) count = OCCUPANCY_BUCKETS;
+    if (count > age) count = (int)age;
+    for (int i = 0; i < count; i++) levels[i] = occupancyBucket(series, series->newest - count + 1 + i)->level;
+    return count;
+}
+
+// Keys of every tracked location, for listings
+int occupancyKeys(const char **keys, int max) {
+    int n = 0;
+    for (int s = 0; s < occupancySeriesCount && n < max; s++) keys[n++] = occupancySeries[s]->key;
+    return n;
+}
+
+// Replays random check-ins, check-outs and headcounts over three simulated
+// days against a full event log, then compares the ring aggregates with
+// what rescanning the log gives
+int benchmarkOccupancy(int samples) {
+    enum { LOCATIONS = 40, CHECKED = 2000 };
+    typedef struct { long long bucket; int level; int checkIn; } LoggedLevel;
+    LoggedLevel *logs[LOCATIONS];
+    int logged[LOCATIONS] = {0};
+    long long reached[LOCATIONS] = {0}; // Newest bucket each series was brought up to
+    for (int l = 0; l < LOCATIONS; l++) {
+        logs[l] = (LoggedLevel *)malloc(sizeof(LoggedLevel) * (size_t)samples);
+        if (logs[l] == NULL) {
+            while (l-- > 0) free(logs[l]);
+            return 0;
+        }
+    }
+
+    srand(4242);
+    const time_t start = 1700000000;
+    const long long span = 3LL * 24 * 3600;
+    double recordTime = 0, queryTime = 0;
+    int mismatches = 0, queries = 0;
+    char key[MAX_ID_LENGTH];
+    for (int i = 0; i < samples; i++) {
+        time_t at = start + (time_t)(span * i / samples);
+        int l = rand() % LOCATIONS, roll = rand() % 100;
+        snprintf(key, sizeof(key), "bench_%d", l);
+        OccupancySample kind = roll < 55 ? OCCUPANCY_CHECK_IN : roll < 98 ? OCCUPANCY_CHECK_OUT : OCCUPANCY_HEADCOUNT;
+        double started = monotonicMillis();
+        int level = recordOccupancy(key, kind, rand() % 50, at);
+        recordTime += monotonicMillis() - started;
+        long long bucket = (long long)at / OCCUPANCY_BUCKET_SECONDS;
+        if (bucket > reached[l]) reached[l] = bucket;
+        LoggedLevel entry = { reached[l], level, kind == OCCUPANCY_CHECK_IN };
+        logs[l][logged[l]++] = entry;
+
+        if (i % (samples / CHECKED + 1) != 0) continue;
+        // Ask a random location, sometimes after a quiet spell
+        int q = rand() % LOCATIONS;
+        time_t asked = at + ((rand() % 4 == 0) ? (rand() % 7200) : (rand() % 200 == 0) ? 90000 : 0);
+        OccupancySummary summary;
+        snprintf(key, sizeof(key), "bench_%d", q);
+        started = monotonicMillis();
+        int found = occupancySummary(key, asked, &summary);
+        queryTime += monotonicMillis() - started;
+        queries++;
+        if (!found) continue;
+        if ((long long)asked / OCCUPANCY_BUCKET_SECONDS > reached[q]) reached[q] = (long long)asked / OCCUPANCY_BUCKET_SECONDS;
+
+        // Rescan: each bucket closes at the last level logged up to it and peaks
+        // at the most it reached, starting from the level carried in
+        long long now = reached[q], firstBucket = logs[q][0].bucket;
+        long long sum = 0, peak = -1;
+        int hourCount = 0, checkIns = 0, e = 0;
+        level = 0;
+        for (long long b = firstBucket; b <= now; b++) {
+            int bucketPeak = level;
+            while (e < logged[q] && logs[q][e].bucket <= b) {
+                if (logs[q][e].checkIn && b > now - OCCUPANCY_HOUR_BUCKETS) checkIns++;
+                level = logs[q][e++].level;
+                if (level > bucketPeak) bucketPeak = level;
+            }
+            if (b > now - OCCUPANCY_HOUR_BUCKETS) {
+                sum += level;
+                hourCount++;
+            }
+            if (b > now - OCCUPANCY_BUCKETS && bucketPeak > peak) peak = bucketPeak;
+        }
+        double average = (double)sum / hourCount, diff = average - summary.hourAverage;
+        if (summary.current != level || summary.peak != peak || summary.checkInsLastHour != checkIns ||
+            diff > 1e-9 || diff < -1e-9) mismatches++;
+    }
+
+    printf("%d samples over 3 simulated days at %d locations: recorded in %.1f ms (%.0f ns each).\n",
+           samples, LOCATIONS, recordTime, recordTime * 1e6 / samples);
+    printf("%d summaries in %.2f ms (%.0f ns each); %d disagreed with a rescan of the full log.\n",
+           queries, queryTime, queries ? queryTime * 1e6 / queries : 0.0, mismatches);
+    printf("History per location: %zu bytes, fixed.\n", sizeof(OccupancySeries));
+    for (int l = 0; l < LOCATIONS; l++) free(logs[l]);
+    return mismatches == 0;
+}
+
+// --- WRITE-BEHIND PERSISTENCE ---
+// A save only serialises its table into a snapshot and hands it to a writer
+// thread, so the menu comes back without waiting on the disk. Snapshots of one
+// table queued within PERSIST_COALESCE_MS replace each other and reach the file
+// as a single write. The writer never touches the in-memory tables: its results
+// (the new version, a file that another instance changed first, an error) are
+// applied by the main thread at the next menu boundary, where a conflict is
+// merged and saved again just as a synchronous save would have done.
+
+static PersistJob persistJobs[TABLE_COUNT];
+static Mutex persistMutex;
+static CondVar persistWake;       // Writer: a snapshot was queued or a barrier started
+static CondVar persistDone;       // Barriers: a write finished
+static int persistThreadRunning = 0;
+static int persistBarriers = 0;   // While non-zero, pending snapshots skip the coalescing delay
+
+// Must run before the first save
+void initPersistence() {
+    mutexInit(&persistMutex);
+    condInit(&persistWake);
+    condInit(&persistDone);
+}
+
+// Takes the pending snapshot of 'table' and writes it. Called with
+// persistMutex held; the lock is released for the file write itself.
+static void writePendingSnapshot(TableID table) {
+    PersistJob *job = &persistJobs[table];
+    TextBuffer body = job->body;
+    unsigned long generation = job->queued;
+    int expectedVersion = job->baseVersion;
+    memset(&job->body, 0, sizeof(job->body));
+    job->pending = 0;
+    job->writing = 1;
+    mutexUnlock(&persistMutex);
+
+    int result = writeTableFile(table, body.data ? body.data : "", expectedVersion);
+    free(body.data);
+
+    mutexLock(&persistMutex);
+    job->writing = 0;
+    if (result == 1) {
+        job->baseVersion = expectedVersion + 1;
+        job->written = generation;
+    } else if (result == 0) {
+        job->conflict = 1; // Snapshots queued meanwhile are stale too; the merge replaces them
+    } else {
+        job->failed = 1;
+    }
+    condBroadcast(&persistDone);
+}
+
+THREAD_FUNC(persistThreadMain, arg) {
+    (void)arg;
+    mutexLock(&persistMutex);
+    while (1) {
+        double now = monotonicMillis();
+        double nextDue = -1;
+        int ready = -1;
+        for (int t = 0; t < TABLE_COUNT && ready < 0; t++) {
+            PersistJob *job = &persistJobs[t];
+            if (!job->pending || job->conflict) continue;
+            if (persistBarriers > 0 || job->dueAt <= now) ready = t;
+            else if (nextDue < 0 || job->dueAt < nextDue) nextDue = job->dueAt;
+        }
+        if (ready >= 0) {
+            writePendingSnapshot((TableID)ready);
+        } else if (nextDue >= 0) {
+            condWaitMillis(&persistWake, &persistMutex, (int)(nextDue - now) + 1);
+        } else {
+            condWait(&persistWake, &persistMutex);
+        }
+    }
+    THREAD_RETURN;
+}
+
+// Until the writer runs (and if it cannot start), saves are written inline
+void startPersistenceThread() {
+    Thread writer;
+    if (threadStart(&writer, persistThreadMain, NULL)) {
+        threadDetach(writer);
+        persistThreadRunning = 1;
+    }
+}
+
+// Hands a serialised table to the writer; takes ownership of 'body'
+void queueTableWrite(TableID table, TextBuffer *body) {
+    PersistJob *job = &persistJobs[table];
+    mutexLock(&persistMutex);
+    if (!job->versionOwned) {
+        job->baseVersion = tableVersions[table];
+        job->versionOwned = 1;
+    }
+    if (!job->pending) job->dueAt = monotonicMillis() + PERSIST_COALESCE_MS;
+    free(job->body.data); // An older snapshot that was never written is superseded
+    job->body = *body;
+    memset(body, 0, sizeof(*body));
+    job->pending = 1;
+    job->queued++;
+    if (persistThreadRunning) {
+        condBroadcast(&persistWake);
+    } else if (!job->conflict) {
+        writePendingSnapshot(table);
+    }
+    mutexUnlock(&persistMutex);
+}
+
+// A newer file beat our write: merge it in and save again
+static int resaveAfterConflict(TableID table) {
+    PersistJob *job = &persistJobs[table];
+    if (++job->conflictStreak >= MAX_SAVE_ATTEMPTS) {
+        printf("Error: %s keeps changing on disk; your edit was not saved.\n", tableFiles[table]);
+        job->conflictStreak = 0;
+        return 0;
+    }
+    if (recordSchema(table)) {
+        mergeStaleArrayTable(table);
+        saveRecordTable(table);
+    } else if (table == TABLE_LOCATIONS) {
+        mergeStaleLocationTable();
+        rewriteLocationFile();
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+// Main thread: adopts finished writes and resolves conflicts. Returns the
+// number of tables that were merged and queued again.
+int applyPersistResults() {
+    int requeued = 0;
+    for (int t = 0; t < TABLE_COUNT; t++) {
+        TableID table = (TableID)t;
+        PersistJob *job = &persistJobs[t];
+        mutexLock(&persistMutex);
+        int conflict = job->conflict;
+        int failed = job->failed;
+        if (conflict) {
+            // The queued snapshot predates the newer file; the merge saves afresh
+            free(job->body.data);
+            memset(&job->body, 0, sizeof(job->body));
+            job->pending = 0;
+            job->conflict = 0;
+            job->versionOwned = 0;
+        } else if (job->versionOwned && !job->pending && !job->writing) {
+            tableVersions[table] = job->baseVersion;
+            if (job->written == job->queued) {
+                dirtyRecords[table].count = 0;
+                dirtyRecords[table].overflow = 0;
+                job->conflictStreak = 0;
+            }
+            job->versionOwned = 0;
+        }
+        job->failed = 0;
+        mutexUnlock(&persistMutex);
+
+        if (failed) printf("Error: Could not open %s for writing.\n", tableFiles[table]);
+        if (conflict && resaveAfterConflict(table)) requeued++;
+    }
+    return requeued;
+}
+
+// True while a save of 'table' is queued, being written, or not yet applied
+int persistInFlight(TableID table) {
+    mutexLock(&persistMutex);
+    int busy = persistJobs[table].versionOwned;
+    mutexUnlock(&persistMutex);
+    return busy;
+}
+
+static int persistBusy(int table) {
+    for (int t = 0; t < TABLE_COUNT; t++) {
+        const PersistJob *job = &persistJobs[t];
+        if ((table < 0 || t == table) && ((job->pending && !job->conflict) || job->writing)) return 1;
+    }
+    return 0;
+}
+
+// Blocks until the saves of 'table' (or of every table, for -1) are on disk
+// and applied, including any save repeated after a merge. Used before a
+// file is read or appended to directly.
+void drainPersistence(int table) {
+    do {
+        mutexLock(&persistMutex);
+        persistBarriers++;
+        condBroadcast(&persistWake);
+        while (persistBusy(table)) condWait(&persistDone, &persistMutex);
+        persistBarriers--;
+        mutexUnlock(&persistMutex);
+    } while (applyPersistResults() > 0);
+}
+
+// Shutdown barrier: everything saved so far is written, and synced as the
+// durability policy asks; this thread's logged changes are written too
+void flushPersistence() {
+    drainPersistence(-1);
+    syncWrittenTables();
+    flushChangeLog();
+    flushShipLog();
+}
+
+// --- TABLE SNAPSHOTS (EPOCH-BASED RECLAMATION) ---
+// The main thread edits its working tables (students[], courses[], faculty[],
+// hashTable) and, after every load, save or reload, publishes an immutable copy
+// with one atomic pointer swap. A reader on any thread enters an epoch, loads
+// the current pointer and keeps using that version without a lock, however
+// many edits or reloads are published meanwhile. A replaced snapshot is retired
+// with the epoch it was unlinked in and freed once no reader that entered at
+// or before that epoch is still inside.
+
+typedef struct RetiredSnapshot {
+    TableSnapshot *snapshot;
+    unsigned long epoch;              // Epoch in which it was unlinked
+    struct RetiredSnapshot *next;
+} RetiredSnapshot;
+
+static atomic_ulong globalEpoch = 1;
+static atomic_ulong readerEpochs[EPOCH_READER_SLOTS];  // Epoch each reader entered in, 0 = free slot
+static _Atomic(TableSnapshot *) publishedTables[TABLE_COUNT];
+static atomic_ulong publishGeneration = 0;
+static RetiredSnapshot *retiredSnapshots = NULL;
+static Mutex retireMutex;
+
+void initSnapshots() {
+    mutexInit(&retireMutex);
+}
+
+// Enters a read-side section; pass the returned slot to epochExit
+int epochEnter() {
+    while (1) {
+        for (int s = 0; s < EPOCH_READER_SLOTS; s++) {
+            unsigned long freeSlot = 0;
+            if (atomic_compare_exchange_strong(&readerEpochs[s], &freeSlot, atomic_load(&globalEpoch))) return s;
+        }
+        sleepMillis(1); // Every slot is taken: wait for a reader to leave
+    }
+}
+
+void epochExit(int slot) {
+    atomic_store(&readerEpochs[slot], 0);
+}
+
+static void freeTableSnapshot(TableSnapshot *snapshot) {
+    if (snapshot->locations) {
+        destroyLocationTable(snapshot->locations);
+        free(snapshot->locations);
+    }
+    free((void *)snapshot->rows);
+    free(snapshot);
+}
+
+// Frees the retired snapshots that no reader can still hold
+void epochReclaim() {
+    // Hold the list first: anything on it was unlinked before the readers are scanned
+    mutexLock(&retireMutex);
+    unsigned long oldest = (unsigned long)-1;
+    for (int s = 0; s < EPOCH_READER_SLOTS; s++) {
+        unsigned long epoch = atomic_load(&readerEpochs[s]);
+        if (epoch != 0 && epoch < oldest) oldest = epoch;
+    }
+    RetiredSnapshot **link = &retiredSnapshots;
+    while (*link) {
+        RetiredSnapshot *retired = *link;
+        if (retired->epoch < oldest) {
+            *link = retired->next;
+            freeTableSnapshot(retired->snapshot);
+            free(retired);
+        } else {
+            link = &retired->next;
+        }
+    }
+    mutexUnlock(&retireMutex);
+}
+
+// insertLocationInto pushes onto the chain head, so copy each chain back to front
+static void cloneLocationChain(LocationTable *copy, const LocationNode *node, int *count) {
+    if (node == NULL) return;
+    cloneLocationChain(copy, node->next, count);
+    insertLocationInto(copy, node->key, node->building, node->floor, node->room, node->description,
+                       node->hasPosition ? &node->position : NULL);
+    (*count)++;
+}
+
+// Publishes a copy of the working table and retires the version it replaces
+void publishTable(TableID table) {
+    TableSnapshot *snapshot = (TableSnapshot *)calloc(1, sizeof(TableSnapshot));
+    if (snapshot == NULL) return;
+    snapshot->table = table;
+
+    const RecordSchema *schema = recordSchema(table);
+    if (schema) {
+        snapshot->count = *schema->count;
+        void *copy = malloc(schema->rowSize * (snapshot->count > 0 ? snapshot->count : 1));
+        if (copy == NULL) {
+            free(snapshot);
+            return;
+        }
+        memcpy(copy, schema->rows, schema->rowSize * snapshot->count);
+        snapshot->rows = copy;
+    } else if (table == TABLE_LOCATIONS) {
+        snapshot->locations = (LocationTable *)malloc(sizeof(LocationTable));
+        if (snapshot->locations == NULL) {
+            free(snapshot);
+            return;
+        }
+        initLocationTable(snapshot->locations);
+        for (int i = 0; i < HASH_SIZE; i++) {
+            cloneLocationChain(snapshot->locations, hashTable.buckets[i], &snapshot->count);
+        }
+    } else {
+        free(snapshot); // Notices are served from the cached notice board
+        return;
+    }
+    snapshot->generation = atomic_fetch_add(&publishGeneration, 1) + 1;
+
+    TableSnapshot *previous = atomic_exchange(&publishedTables[table], snapshot);
+    if (previous) {
+        RetiredSnapshot *retired = (RetiredSnapshot *)malloc(sizeof(RetiredSnapshot));
+        if (retired == NULL) return; // Leaking it is safe; freeing it under a reader is not
+        retired->snapshot = previous;
+        retired->epoch = atomic_fetch_add(&globalEpoch, 1);
+        mutexLock(&retireMutex);
+        retired->next = retiredSnapshots;
+        retiredSnapshots = retired;
+        mutexUnlock(&retireMutex);
+    }
+    epochReclaim();
+}
+
+// Current version of a table (loading it first if needed). Call between
+// epochEnter and epochExit; the snapshot stays valid until epochExit.
+const TableSnapshot* currentSnapshot(TableID table) {
+    ensureTableLoaded(table);
+    return atomic_load(&publishedTables[table]);
+}
+
+// --- HOT RELOAD (FILE WATCHER) ---
+// A background thread notices when another process rewrites a db file and
+// parses just that table into a private staging copy. The main thread swaps
+// the staged copy in at the next menu boundary, so a screen always works on
+// either the old table or the new one, never a half-loaded mix. The login
+// prefetch stages each table's first load through the same slots.
+
+typedef struct FileStamp {
+    long long mtimeNs;
+    long long size;
+} FileStamp;
+
+typedef struct StagedTable {
+    int pending;
+    FileStamp stamp; // Stamp of the file contents that were parsed
+    int count;
+    int nextID;      // Notices only
+    int version;     // Version header of the parsed file
+    void *rows;      // Student/Course/Faculty/Notice array, or a LocationTable
+} StagedTable;
+
+static Mutex reloadMutex;
+static int reloadMutexReady = 0;
+static FileStamp syncedStamps[TABLE_COUNT]; // Last file state this process loaded or wrote
+static StagedTable stagedTables[TABLE_COUNT];
+
+static int readFileStamp(const char *path, FileStamp *stamp) {
+    struct stat st;
+    if (stat(path, &st) != 0) return 0;
+    #ifdef __linux__
+        stamp->mtimeNs = (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    #else
+        stamp->mtimeNs = (long long)st.st_mtime * 1000000000LL;
+    #endif
+    stamp->size = (long long)st.st_size;
+    return 1;
+}
+
+static int sameStamp(const FileStamp *a, const FileStamp *b) {
+    return a->mtimeNs == b->mtimeNs && a->size == b->size;
+}
+
+static void freeStagedRows(TableID table, void *rows) {
+    if (rows == NULL) return;
+    if (table == TABLE_LOCATIONS) destroyLocationTable((LocationTable *)rows);
+    free(rows);
+}
+
+// Records the current on-disk state of a table as "ours" so the watcher
+// does not reload a file this process has just loaded or written itself
+void markTableSynced(TableID table) {
+    FileStamp stamp = {0, 0};
+    readFileStamp(tableFiles[table], &stamp);
+    if (reloadMutexReady) mutexLock(&reloadMutex);
+    syncedStamps[table] = stamp;
+    if (reloadMutexReady) mutexUnlock(&reloadMutex);
+}
+
+// Parses a table file into a fresh staging copy. The watcher stages tables
+// that are already loaded (reloads); the prefetch thread stages the rest.
+static void stageTable(TableID table, int prefetch) {
+    FileStamp stamp;
+    if (isTableLoaded(table) == prefetch) return;
+    if (!readFileStamp(tableFiles[table], &stamp)) return;
+
+    mutexLock(&reloadMutex);
+    int unchanged = (!prefetch && sameStamp(&stamp, &syncedStamps[table])) ||
+                    (stagedTables[table].pending && sameStamp(&stamp, &stagedTables[table].stamp));
+    mutexUnlock(&reloadMutex);
+    if (unchanged) return;
+
+    void *rows = NULL;
+    int count = -1, nextID = 0, version = 0;
+    const RecordSchema *schema = recordSchema(table);
+    if (schema) {
+        rows = malloc(schema->rowSize * MAX_RECORDS);
+        if (rows) count = schema->parseFile(tableFiles[table], rows, MAX_RECORDS, &version);
+    } else if (table == TABLE_LOCATIONS) {
+        rows = malloc(sizeof(LocationTable));
+        if (rows) {
+            initLocationTable((LocationTable *)rows);
+            count = parseLocationFile(tableFiles[table], (LocationTable *)rows, &version);
+        }
+    } else if (table == TABLE_NOTICES) {
+        rows = malloc(sizeof(Notice) * MAX_NOTICES);
+        if (rows) count = parseNoticeFile(tableFiles[table], (Notice *)rows, MAX_NOTICES, &nextID, &version);
+    }
+    if (count < 0) { // File vanished mid-rewrite; the next event will retry
+        freeStagedRows(table, rows);
+        return;
+    }
+
+    mutexLock(&reloadMutex);
+    void *replaced = stagedTables[table].pending ? stagedTables[table].rows : NULL;
+    stagedTables[table].rows = rows;
+    stagedTables[table].count = count;
+    stagedTables[table].nextID = nextID;
+    stagedTables[table].version = version;
+    stagedTables[table].stamp = stamp;
+    stagedTables[table].pending = 1;
+    mutexUnlock(&reloadMutex);
+    freeStagedRows(table, replaced);
+}
+
+static void stageTableReload(TableID table) {
+    stageTable(table, 0);
+}
+
+void stageTablePrefetch(TableID table) {
+    if (reloadMutexReady) stageTable(table, 1);
+}
+
+// Takes the staged copy of a table, if there is one
+static int takeStagedTable(TableID table, StagedTable *staged, FileStamp *synced) {
+    mutexLock(&reloadMutex);
+    *staged = stagedTables[table];
+    *synced = syncedStamps[table];
+    stagedTables[table].pending = 0;
+    stagedTables[table].rows = NULL;
+    mutexUnlock(&reloadMutex);
+    return staged->pending;
+}
+
+// Main thread: swaps a staged copy into the live table and republishes it.
+// The copy is dropped (returning 0) if the file has changed again since it
+// was parsed, or if it is a reload of a file we have since written ourselves.
+static int installStagedTable(TableID table, StagedTable *staged, const FileStamp *synced) {
+    FileStamp current;
+    if ((isTableLoaded(table) && sameStamp(&staged->stamp, synced)) ||
+        !readFileStamp(tableFiles[table], &current) || !sameStamp(&current, &staged->stamp)) {
+        freeStagedRows(table, staged->rows);
+        return 0;
+    }
+
+    const RecordSchema *schema = recordSchema(table);
+    if (schema) {
+        memcpy(schema->rows, staged->rows, schema->rowSize * staged->count);
+        *schema->count = staged->count;
+        if (schema->view >= 0) invalidateView((ViewID)schema->view);
+    } else if (table == TABLE_LOCATIONS) {
+        // Swap whole tables: the old nodes go out with the staged copy in one release
+        LocationTable previous = hashTable;
+        hashTable = *(LocationTable *)staged->rows;
+        *(LocationTable *)staged->rows = previous;
+    } else if (table == TABLE_NOTICES) {
+        memcpy(notices, staged->rows, sizeof(Notice) * staged->count);
+        noticeCount = staged->count;
+        nextNoticeID = staged->nextID;
+        rebuildNoticeIndexes();
+    }
+    freeStagedRows(table, staged->rows);
+    tableVersions[table] = staged->version;
+    rebuildKeyFilter(table);
+    rebuildTableStats(table);
+    rebuildRequisiteGraph(table);
+    syncCourseSeats(table);
+    publishTable(table);
+
+    mutexLock(&reloadMutex);
+    syncedStamps[table] = staged->stamp;
+    mutexUnlock(&reloadMutex);
+    return 1;
+}
+
+// Main thread, first use of a table: install the prefetched copy if it is ready
+int adoptPrefetchedTable(TableID table) {
+    StagedTable staged;
+    FileStamp synced;
+    if (!reloadMutexReady || !takeStagedTable(table, &staged, &synced)) return 0;
+    return installStagedTable(table, &staged, &synced);
+}
+
+// Main thread, called at menu boundaries: publish any staged tables, both
+// reloads of changed files and tables the prefetch thread has finished parsing
+void applyPendingReloads() {
+    if (!reloadMutexReady) return;
+
+    for (int t = 0; t < TABLE_COUNT; t++) {
+        TableID table = (TableID)t;
+        if (persistInFlight(table)) continue; // Our pending save will merge the newer file instead
+        StagedTable staged;
+        FileStamp synced;
+        if (!takeStagedTable(table, &staged, &synced)) continue;
+
+        int firstLoad = !isTableLoaded(table);
+        if (!installStagedTable(table, &staged, &synced)) continue;
+        if (firstLoad) {
+            markTableLoaded(table);
+        } else {
+            printf("(%s data was changed on disk and has been reloaded.)\n", tableNames[table]);
+        }
+    }
+}
+
+static int tableForFileName(const char *name) {
+    for (int t = 0; t < TABLE_COUNT; t++) {
+        const char *base = strrchr(tableFiles[t], '/');
+        base = base ? base + 1 : tableFiles[t];
+        if (strcmp(base, name) == 0) return t;
+    }
+    return -1;
+}
+
+// Portable fallback: compare file stamps on a fixed interval
+THREAD_FUNC(pollWatcherMain, arg) {
+    (void)arg;
+    while (1) {
+        sleepMillis(WATCH_POLL_INTERVAL_MS);
+        for (int t = 0; t < TABLE_COUNT; t++) stageTableReload((TableID)t);
+    }
+    THREAD_RETURN;
+}
+
+#ifdef __linux__
+// inotify watch on the db directory; IN_MOVED_TO also catches write-then-rename saves
+THREAD_FUNC(inotifyWatcherMain, arg) {
+    int fd = (int)(long)arg;
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    while (1) {
+        ssize_t length = read(fd, events, sizeof(events));
+        if (length <= 0) break;
+        for (char *ptr = events; ptr < events + length; ) {
+            const struct inotify_event *event = (const struct inotify_event *)ptr;
+            if (event->len > 0) {
+                int table = tableForFileName(event->name);
+                if (table >= 0) stageTableReload((TableID)table);
+            }
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    close(fd);
+    THREAD_RETURN;
+}
+#endif
+
+void startFileWatcher() {
+    mutexInit(&reloadMutex);
+    reloadMutexReady = 1;
+
+    Thread watcher;
+    #ifdef __linux__
+        int fd = inotify_init();
+        if (fd >= 0 && inotify_add_watch(fd, dataDirectory, IN_CLOSE_WRITE | IN_MOVED_TO) >= 0 &&
+            threadStart(&watcher, inotifyWatcherMain, (void *)(long)fd)) {
+            threadDetach(watcher);
+            return;
+        }
+        if (fd >= 0) close(fd);
+    #endif
+    if (threadStart(&watcher, pollWatcherMain, NULL)) {
+        threadDetach(watcher);
+    } else {
+        printf("Warning: File watcher could not be started. External edits need a restart.\n");
+    }
+}
+
+// --- ON-DISK B+TREE INDEX (STUDENT ID / COURSE CODE) ---
+// students.idx and courses.idx map a record key to the byte offset of its line
+// in the .dat file. The index is made of fixed-size pages and is read through a
+// small buffer pool, so a point lookup or range scan touches only the pages on
+// its path no matter how many records the archive holds. Page 0 is the meta
+// page; every other page is a leaf or an internal node.
+
+#define BPT_PAGE_SIZE 4096
+#define BPT_KEY_SIZE 16
+#define BPT_POOL_FRAMES 16
+#define BPT_MAGIC 0x31545042u // "BPT1"
+#define BPT_LEAF_ORDER ((BPT_PAGE_SIZE - sizeof(BptNodeHeader)) / (BPT_KEY_SIZE + sizeof(int64_t)))
+#define BPT_INTERNAL_ORDER ((BPT_PAGE_SIZE - sizeof(BptNodeHeader) - sizeof(uint32_t)) / (BPT_KEY_SIZE + sizeof(uint32_t)))
+
+typedef struct BptMeta {
+    uint32_t magic;
+    uint32_t rootPage;
+    uint32_t pageCount;
+    uint32_t height;
+    uint64_t keyCount;
+    int32_t dataVersion; // Version header of the .dat file the offsets point into
+} BptMeta;
+
+typedef struct BptNodeHeader {
+    uint16_t isLeaf;
+    uint16_t numKeys;
+    uint32_t nextLeaf; // Leaves only: right sibling for range scans (0 = none)
+} BptNodeHeader;
+
+typedef struct BptFrame {
+    uint32_t pageNo;
+    int valid;
+    int dirty;
+    int pins;
+    unsigned long lastUsed;
+    char *data;
+} BptFrame;
+
+typedef struct BPlusTree {
+    FILE *fp;
+    BptMeta meta;
+    BptFrame frames[BPT_POOL_FRAMES];
+    unsigned long clock;
+    unsigned long pageReads;  // Pages fetched from disk (buffer pool misses)
+    unsigned long pageWrites;
+    unsigned long poolHits;
+} BPlusTree;
+
+BPlusTree *recordIndexes[TABLE_COUNT]; // Only the array tables are indexed
+
+static BptNodeHeader* bptHeader(char *page) { return (BptNodeHeader *)page; }
+static char* bptKey(char *page, int i) { return page + sizeof(BptNodeHeader) + (size_t)i * BPT_KEY_SIZE; }
+static int64_t* bptValues(char *page) { return (int64_t *)(page + sizeof(BptNodeHeader) + BPT_LEAF_ORDER * BPT_KEY_SIZE); }
+static uint32_t* bptChildren(char *page) { return (uint32_t *)(page + sizeof(BptNodeHeader) + BPT_INTERNAL_ORDER * BPT_KEY_SIZE); }
+
+static int bptCompare(const char *a, const char *b) {
+    return strncmp(a, b, BPT_KEY_SIZE);
+}
+
+static void bptMakeKey(char *out, const char *key) {
+    memset(out, 0, BPT_KEY_SIZE);
+    strncpy(out, key, BPT_KEY_SIZE - 1);
+}
+
+static void bptWriteFrame(BPlusTree *tree, BptFrame *frame) {
+    fseek64(tree->fp, (int64_t)frame->pageNo * BPT_PAGE_SIZE, SEEK_SET);
+    fwrite(frame->data, BPT_PAGE_SIZE, 1, tree->fp);
+    frame->dirty = 0;
+    tree->pageWrites++;
+}
+
+// Returns the page's frame, reading it from disk (and evicting the least
+// recently used unpinned frame) on a miss. The caller must bptUnpin it.
+static char* bptPin(BPlusTree *tree, uint32_t pageNo) {
+    BptFrame *victim = NULL;
+    for (int i = 0; i < BPT_POOL_FRAMES; i++) {
+        BptFrame *frame = &tree->frames[i];
+        if (frame->valid && frame->pageNo == pageNo) {
+            frame->pins++;
+            frame->lastUsed = ++tree->clock;
+            tree->poolHits++;
+            return frame->data;
+        }
+        if (frame->pins == 0 && (victim == NULL || !frame->valid ||
+                                 (victim->valid && frame->lastUsed < victim->lastUsed))) {
+            victim = frame;
+        }
+    }
+    if (victim == NULL) return NULL; // Every frame is pinned
+
+    if (victim->valid && victim->dirty) bptWriteFrame(tree, victim);
+    if (victim->data == NULL) victim->data = (char *)malloc(BPT_PAGE_SIZE);
+    if (victim->data == NULL) return NULL;
+
+    memset(victim->data, 0, BPT_PAGE_SIZE);
+    if (pageNo < tree->meta.pageCount) {
+        fseek64(tree->fp, (int64_t)pageNo * BPT_PAGE_SIZE, SEEK_SET);
+        if (fread(victim->data, BPT_PAGE_SIZE, 1, tree->fp) != 1) memset(victim->data, 0, BPT_PAGE_SIZE);
+        tree->pageReads++;
+    }
+    victim->pageNo = pageNo;
+    victim->valid = 1;
+    victim->dirty = 0;
+    victim->pins = 1;
+    victim->lastUsed = ++tree->clock;
+    return victim->data;
+}
+
+static void bptUnpin(BPlusTree *tree, uint32_t pageNo, int dirty) {
+    for (int i = 0; i < BPT_POOL_FRAMES; i++) {
+        BptFrame *frame = &tree->frames[i];
+        if (frame->valid && frame->pageNo == pageNo) {
+            if (frame->pins > 0) frame->pins--;
+            if (dirty) frame->dirty = 1;
+            return;
+        }
+    }
+}
+
+// Appends a fresh zeroed page and returns it pinned
+static char* bptAllocPage(BPlusTree *tree, uint32_t *pageNo, int isLeaf) {
+    *pageNo = tree->meta.pageCount++;
+    char *page = bptPin(tree, *pageNo);
+    if (page == NULL) return NULL;
+    bptHeader(page)->isLeaf = (uint16_t)isLeaf;
+    return page;
+}
+
+void bptFlush(BPlusTree *tree) {
+    for (int i = 0; i < BPT_POOL_FRAMES; i++) {
+        if (tree->frames[i].valid && tree->frames[i].dirty) bptWriteFrame(tree, &tree->frames[i]);
+    }
+    char metaPage[BPT_PAGE_SIZE] = {0};
+    memcpy(metaPage, &tree->meta, sizeof(BptMeta));
+    fseek64(tree->fp, 0, SEEK_SET);
+    fwrite(metaPage, BPT_PAGE_SIZE, 1, tree->fp);
+    fflush(tree->fp);
+}
+
+void bptClose(BPlusTree *tree) {
+    if (tree == NULL) return;
+    bptFlush(tree);
+    fclose(tree->fp);
+    for (int i = 0; i < BPT_POOL_FRAMES; i++) free(tree->frames[i].data);
+    free(tree);
+}
+
+// Opens an index file, or creates an empty one (a single empty leaf) if 'create' is set
+BPlusTree* bptOpen(const char *path, int create) {
+    BPlusTree *tree = (BPlusTree *)calloc(1, sizeof(BPlusTree));
+    if (tree == NULL) return NULL;
+
+    tree->fp = create ? fopen(path, "w+b") : fopen(path, "r+b");
+    if (tree->fp == NULL) {
+        free(tree);
+        return NULL;
+    }
+
+    if (create) {
+        tree->meta.magic = BPT_MAGIC;
+        tree->meta.pageCount = 1; // Page 0 is the meta page
+        tree->meta.height = 1;
+        uint32_t root;
+        if (bptAllocPage(tree, &root, 1) == NULL) {
+            fclose(tree->fp);
+            free(tree);
+            return NULL;
+        }
+        bptUnpin(tree, root, 1);
+        tree->meta.rootPage = root;
+        bptFlush(tree);
+    } else {
+        char metaPage[BPT_PAGE_SIZE];
+        if (fread(metaPage, BPT_PAGE_SIZE, 1, tree->fp) != 1) {
+            fclose(tree->fp);
+            free(tree);
+            return NULL;
+        }
+        memcpy(&tree->meta, metaPage, sizeof(BptMeta));
+        if (tree->meta.magic != BPT_MAGIC) {
+            fclose(tree->fp);
+            free(tree);
+            return NULL;
+        }
+    }
+    return tree;
+}
+
+// First slot whose key is >= key (leaf search position)
+static int bptLowerBound(char *page, const char *key) {
+    int lo = 0, hi = bptHeader(page)->numKeys;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (bptCompare(bptKey(page, mid), key) < 0) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+// Child slot to descend into: number of separator keys <= key
+static int bptChildSlot(char *page, const char *key) {
+    int lo = 0, hi = bptHeader(page)->numKeys;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (bptCompare(bptKey(page, mid), key) <= 0) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+// Recursive insert. Returns 1 if 'pageNo' split, with the separator key and
+// the new right sibling passed back up for the parent to absorb.
+static int bptInsertInto(BPlusTree *tree, uint32_t pageNo, const char *key, int64_t value,
+                         char *upKey, uint32_t *upPage) {
+    char *page = bptPin(tree, pageNo);
+    if (page == NULL) return 0;
+    BptNodeHeader *header = bptHeader(page);
+
+    if (header->isLeaf) {
+        int n = header->numKeys;
+        int pos = bptLowerBound(page, key);
+        int64_t *values = bptValues(page);
+        if (pos < n && bptCompare(bptKey(page, pos), key) == 0) {
+            values[pos] = value; // Existing key: just repoint it
+            bptUnpin(tree, pageNo, 1);
+            return 0;
+        }
+        tree->meta.keyCount++;
+
+        if ((size_t)n < BPT_LEAF_ORDER) {
+            memmove(bptKey(page, pos + 1), bptKey(page, pos), (size_t)(n - pos) * BPT_KEY_SIZE);
+            memmove(&values[pos + 1], &values[pos], (size_t)(n - pos) * sizeof(int64_t));
+            memcpy(bptKey(page, pos), key, BPT_KEY_SIZE);
+            values[pos] = value;
+            header->numKeys++;
+            bptUnpin(tree, pageNo, 1);
+            return 0;
+        }
+
+        // Full leaf: gather n+1 entries, keep the lower half, move the rest right
+        char keys[BPT_LEAF_ORDER + 1][BPT_KEY_SIZE];
+        int64_t vals[BPT_LEAF_ORDER + 1];
+        for (int i = 0, j = 0; i <= n; i++) {
+            if (i == pos) {
+                memcpy(keys[i], key, BPT_KEY_SIZE);
+                vals[i] = value;
+            } else {
+                memcpy(keys[i], bptKey(page, j), BPT_KEY_SIZE);
+                vals[i] = values[j];
+                j++;
+            }
+        }
+        uint32_t rightNo;
+        char *right = bptAllocPage(tree, &rightNo, 1);
+        if (right == NULL) {
+            bptUnpin(tree, pageNo, 0);
+            return 0;
+        }
+        int leftCount = (n + 1) / 2;
+        int rightCount = n + 1 - leftCount;
+        for (int i = 0; i < leftCount; i++) {
+            memcpy(bptKey(page, i), keys[i], BPT_KEY_SIZE);
+            values[i] = vals[i];
+        }
+        for (int i = 0; i < rightCount; i++) {
+            memcpy(bptKey(right, i), keys[leftCount + i], BPT_KEY_SIZE);
+            bptValues(right)[i] = vals[leftCount + i];
+        }
+        header->numKeys = (uint16_t)leftCount;
+        bptHeader(right)->numKeys = (uint16_t)rightCount;
+        bptHeader(right)->nextLeaf = header->nextLeaf;
+        header->nextLeaf = rightNo;
+
+        memcpy(upKey, bptKey(right, 0), BPT_KEY_SIZE);
+        *upPage = rightNo;
+        bptUnpin(tree, rightNo, 1);
+        bptUnpin(tree, pageNo, 1);
+        return 1;
+    }
+
+    // Internal node: descend without holding this page pinned
+    int slot = bptChildSlot(page, key);
+    uint32_t child = bptChildren(page)[slot];
+    bptUnpin(tree, pageNo, 0);
+
+    char childKey[BPT_KEY_SIZE];
+    uint32_t childPage;
+    if (!bptInsertInto(tree, child, key, value, childKey, &childPage)) return 0;
+
+    page = bptPin(tree, pageNo);
+    if (page == NULL) return 0;
+    header = bptHeader(page);
+    uint32_t *children = bptChildren(page);
+    int n = header->numKeys;
+
+    if ((size_t)n < BPT_INTERNAL_ORDER) {
+        memmove(bptKey(page, slot + 1), bptKey(page, slot), (size_t)(n - slot) * BPT_KEY_SIZE);
+        memmove(&children[slot + 2], &children[slot + 1], (size_t)(n - slot) * sizeof(uint32_t));
+        memcpy(bptKey(page, slot), childKey, BPT_KEY_SIZE);
+        children[slot + 1] = childPage;
+        header->numKeys++;
+        bptUnpin(tree, pageNo, 1);
+        return 0;
+    }
+
+    // Full internal node: split around the middle key, which moves up
+    char keys[BPT_INTERNAL_ORDER + 1][BPT_KEY_SIZE];
+    uint32_t kids[BPT_INTERNAL_ORDER + 2];
+    for (int i = 0, j = 0; i <= n; i++) {
+        if (i == slot) memcpy(keys[i], childKey, BPT_KEY_SIZE);
+        else memcpy(keys[i], bptKey(page, j++), BPT_KEY_SIZE);
+    }
+    for (int i = 0, j = 0; i <= n + 1; i++) {
+        if (i == slot + 1) kids[i] = childPage;
+        else kids[i] = children[j++];
+    }
+    uint32_t rightNo;
+    char *right = bptAllocPage(tree, &rightNo, 0);
+    if (right == NULL) {
+        bptUnpin(tree, pageNo, 0);
+        return 0;
+    }
+    int mid = (n + 1) / 2;
+    for (int i = 0; i < mid; i++) memcpy(bptKey(page, i), keys[i], BPT_KEY_SIZE);
+    for (int i = 0; i <= mid; i++) children[i] = kids[i];
+    header->numKeys = (uint16_t)mid;
+
+    int rightCount = n - mid; // n+1 keys total, one moves up
+    for (int i = 0; i < rightCount; i++) memcpy(bptKey(right, i), keys[mid + 1 + i], BPT_KEY_SIZE);
+    for (int i = 0; i <= rightCount; i++) bptChildren(right)[i] = kids[mid + 1 + i];
+    bptHeader(right)->numKeys = (uint16_t)rightCount;
+
+    memcpy(upKey, keys[mid], BPT_KEY_SIZE);
+    *upPage = rightNo;
+    bptUnpin(tree, rightNo, 1);
+    bptUnpin(tree, pageNo, 1);
+    return 1;
+}
+
+void bptInsert(BPlusTree *tree, const char *rawKey, int64_t value) {
+    char key[BPT_KEY_SIZE], upKey[BPT_KEY_SIZE];
+    uint32_t upPage;
+    bptMakeKey(key, rawKey);
+    if (!bptInsertInto(tree, tree->meta.rootPage, key, value, upKey, &upPage)) return;
+
+    // The root split: grow the tree by one level
+    uint32_t rootNo;
+    char *root = bptAllocPage(tree, &rootNo, 0);
+    if (root == NULL) return;
+    memcpy(bptKey(root, 0), upKey, BPT_KEY_SIZE);
+    bptChildren(root)[0] = tree->meta.rootPage;
+    bptChildren(root)[1] = upPage;
+    bptHeader(root)->numKeys = 1;
+    bptUnpin(tree, rootNo, 1);
+    tree->meta.rootPage = rootNo;
+    tree->meta.height++;
+}
+
+// Walks from the root to the leaf that would hold 'key'; returns it pinned
+static char* bptFindLeaf(BPlusTree *tree, const char *key, uint32_t *leafNo) {
+    uint32_t pageNo = tree->meta.rootPage;
+    while (1) {
+        char *page = bptPin(tree, pageNo);
+        if (page == NULL) return NULL;
+        if (bptHeader(page)->isLeaf) {
+            *leafNo = pageNo;
+            return page;
+        }
+        uint32_t child = bptChildren(page)[bptChildSlot(page, key)];
+        bptUnpin(tree, pageNo, 0);
+        pageNo = child;
+    }
+}
+
+// Point lookup; returns 1 and the stored offset if the key exists
+int bptSearch(BPlusTree *tree, const char *rawKey, int64_t *value) {
+    char key[BPT_KEY_SIZE];
+    uint32_t leafNo;
+    bptMakeKey(key, rawKey);
+    char *leaf = bptFindLeaf(tree, key, &leafNo);
+    if (leaf == NULL) return 0;
+    int pos = bptLowerBound(leaf, key);
+    int found = pos < bptHeader(leaf)->numKeys && bptCompare(bptKey(leaf, pos), key) == 0;
+    if (found) *value = bptValues(leaf)[pos];
+    bptUnpin(tree, leafNo, 0);
+    return found;
+}
+
+// Visits every key in [low, high] in order by following the leaf chain.
+// The visitor returns 0 to stop early. Returns the number of keys visited.
+int bptRangeScan(BPlusTree *tree, const char *rawLow, const char *rawHigh,
+                 int (*visit)(const char *key, int64_t value, void *ctx), void *ctx) {
+    char low[BPT_KEY_SIZE], high[BPT_KEY_SIZE];
+    uint32_t leafNo;
+    bptMakeKey(low, rawLow);
+    bptMakeKey(high, rawHigh);
+    char *leaf = bptFindLeaf(tree, low, &leafNo);
+    int visited = 0;
+    int pos = leaf ? bptLowerBound(leaf, low) : 0;
+
+    while (leaf) {
+        int n = bptHeader(leaf)->numKeys;
+        for (; pos < n; pos++) {
+            if (bptCompare(bptKey(leaf, pos), high) > 0) {
+                bptUnpin(tree, leafNo, 0);
+                return visited;
+            }
+            visited++;
+            if (!visit(bptKey(leaf, pos), bptValues(leaf)[pos], ctx)) {
+                bptUnpin(tree, leafNo, 0);
+                return visited;
+            }
+        }
+        uint32_t next = bptHeader(leaf)->nextLeaf;
+        bptUnpin(tree, leafNo, 0);
+        if (next == 0) break;
+        leafNo = next;
+        leaf = bptPin(tree, leafNo);
+        pos = 0;
+    }
+    return visited;
+}
+
+// --- RECORD INDEXES OVER THE ARRAY TABLES (students.dat, courses.dat, faculty.dat) ---
+
+static const char* indexPathFor(TableID table) {
+    static char paths[TABLE_COUNT][MAX_LINE_LENGTH];
+    snprintf(paths[table], MAX_LINE_LENGTH, "%s/%s.idx", dataDirectory, recordSchema(table)->rowsName);
+    return paths[table];
+}
+
+// Reads just the version header of a table file
+int readTableFileVersion(TableID table) {
+    int version = 0;
+    FILE *fp = openTableForRead(tableFiles[table]);
+    if (fp == NULL) return -1;
+    char line[MAX_LINE_LENGTH];
+    if (fgets(line, MAX_LINE_LENGTH, fp)) isHeaderLine(line, &version);
+    closeTable(fp);
+    return version;
+}
+
+// Index keys hold BPT_KEY_SIZE - 1 characters; a table keyed by longer text
+// (programs, by name) would have its keys cut short, so it is scanned instead
+int recordIndexable(TableID table) {
+    const RecordSchema *schema = recordSchema(table);
+    return schema != NULL && schema->fields[0].size <= BPT_KEY_SIZE;
+}
+
+// Streams the .dat file once, inserting every key with its line offset.
+// Memory use is bounded by the buffer pool, not by the number of records.
+int buildRecordIndex(TableID table) {
+    if (!recordIndexable(table)) return -1;
+    drainPersistence(table); // Index the file as this process last saved it
+    if (recordIndexes[table]) {
+        bptClose(recordIndexes[table]);
+        recordIndexes[table] = NULL;
+    }
+    FILE *data = openTableForRead(tableFiles[table]);
+    if (data == NULL) return -1;
+    BPlusTree *tree = bptOpen(indexPathFor(table), 1);
+    if (tree == NULL) {
+        closeTable(data);
+        return -1;
+    }
+
+    char line[MAX_LINE_LENGTH];
+    int version = 0;
+    int64_t offset = ftell64(data);
+    while (fgets(line, MAX_LINE_LENGTH, data)) {
+        if (!isHeaderLine(line, &version)) {
+            char *comma = strchr(line, ',');
+            if (comma && comma != line) {
+                *comma = '\0';
+                bptInsert(tree, line, offset);
+            }
+        }
+        offset = ftell64(data);
+    }
+    closeTable(data);
+
+    tree->meta.dataVersion = version;
+    bptFlush(tree);
+    recordIndexes[table] = tree;
+    return (int)tree->meta.keyCount;
+}
+
+// Returns an index that matches the current .dat file, rebuilding it if the
+// file has been rewritten since the index was built
+BPlusTree* openRecordIndex(TableID table) {
+    if (!recordIndexable(table)) return NULL;
+    drainPersistence(table);
+    int dataVersion = readTableFileVersion(table);
+    if (dataVersion < 0) return NULL;
+
+    BPlusTree *tree = recordIndexes[table];
+    if (tree == NULL) tree = recordIndexes[table] = bptOpen(indexPathFor(table), 0);
+    if (tree && tree->meta.dataVersion == dataVersion) return tree;
+
+    if (buildRecordIndex(table) < 0) return NULL;
+    return recordIndexes[table];
+}
+
+// True if a table line is the record for 'key' (every line starts "key,")
+static int recordLineHasKey(const char *line, const char *key) {
+    size_t length = strlen(key);
+    return strncmp(line, key, length) == 0 && line[length] == ',';
+}
+
+// Reads the single record line stored at 'offset' in a table file. Fails if the
+// line there is not 'key's: another instance may have rewritten the file since
+// the index was read, moving the offset onto a different record.
+int readRecordLineAt(TableID table, int64_t offset, const char *key, char *line, int size) {
+    FILE *fp = openTableForRead(tableFiles[table]);
+    if (fp == NULL) return 0;
+    int ok = fseek64(fp, offset, SEEK_SET) == 0 && fgets(line, size, fp) != NULL;
+    closeTable(fp);
+    return ok && recordLineHasKey(line, key);
+}
+
+// Index lookup for one key. The version header and the record line are read
+// under one shared lock, so the offset cannot be from an older file than the line.
+// Returns 1 with the line, 0 if the key is not in the table, -1 if the index is stale.
+static int readIndexedLine(TableID table, const char *key, char *line, int size) {
+    BPlusTree *tree = openRecordIndex(table);
+    if (tree == NULL) return -1;
+    int64_t offset;
+    int indexed = bptSearch(tree, key, &offset);
+    FILE *fp = openTableForRead(tableFiles[table]);
+    if (fp == NULL) return 0;
+    int version = 0;
+    if (fgets(line, size, fp)) isHeaderLine(line, &version);
+    int current = version == (int)tree->meta.dataVersion;
+    int ok = current && indexed && fseek64(fp, offset, SEEK_SET) == 0 && fgets(line, size, fp) != NULL;
+    closeTable(fp);
+    if (!current) return -1;
+    if (!indexed) return 0;
+    return ok && recordLineHasKey(line, key) ? 1 : -1;
+}
+
+// Linear fallback: streams the table file for the key's line
+static int scanRecordLine(TableID table, const char *key, char *line, int size) {
+    FILE *fp = openTableForRead(tableFiles[table]);
+    if (fp == NULL) return 0;
+    int found = 0;
+    while (!found && fgets(line, size, fp)) {
+        found = !isHeaderLine(line, NULL) && recordLineHasKey(line, key);
+    }
+    closeTable(fp);
+    return found;
+}
+
+// Reads one record by key straight from the table file; 'out' is the table's record type
+int indexLookupRecord(TableID table, const char *key, void *out) {
+    char line[MAX_LINE_LENGTH];
+    int found = -1;
+    // A rewrite between opening the index and reading the line just means one more try
+    for (int attempt = 0; attempt < MAX_SAVE_ATTEMPTS && found < 0 && recordIndexable(table); attempt++) {
+        found = readIndexedLine(table, key, line, MAX_LINE_LENGTH);
+    }
+    if (found < 0) found = scanRecordLine(table, key, line, MAX_LINE_LENGTH);
+    return found && recordSchema(table)->parseLine(line, out);
+}
+
+// --- FILTER QUERIES (COMPILED PREDICATES) ---
+// A query names a table and an optional filter:
+//     students where program = "BSc CS" and email endswith "@uni.edu"
+//     courses where credits >= 4 or (name contains lab and not semester < 2023-1)
+// The filter is parsed once into a postfix program. Each instruction compares
+// one field at a fixed struct offset against a constant, or combines the two
+// results on top of a small boolean stack. Running it per record is a tight
+// loop with no parsing or name lookups.
+//
+// =, !=, <, <=, >, >= compare exactly (numerically for numeric fields);
+// contains, startswith and endswith ignore case. When the top level of the
+// filter is a chain of 'and's that pins the key (id/code/key), the matching
+// index is used instead of a scan: the B+tree for the array tables, the
+// hash table for locations.
+
+#define MAX_QUERY_OPS 64
+#define MAX_QUERY_ERROR 128
+#define QUERY_KEY_MAX "\x7f" // Sorts after every printable key (open-ended ranges)
+
+typedef struct QuerySource {
+    const char *name;       // As written in queries
+    TableID table;
+    size_t rowSize;
+    const RecordField *fields;
+    int fieldCount;         // Field 0 is always the key
+} QuerySource;
+
+static const RecordField locationFields[] = {
+    { "key", FIELD_STRING, offsetof(LocationNode, key), MAX_ID_LENGTH, "Key", NULL },
+    { "building", FIELD_STRING, offsetof(LocationNode, building), MAX_NAME_LENGTH, "Building", NULL },
+    { "floor", FIELD_STRING, offsetof(LocationNode, floor), MAX_ID_LENGTH, "Floor", NULL },
+    { "room", FIELD_STRING, offsetof(LocationNode, room), MAX_ID_LENGTH, "Room", NULL },
+    { "description", FIELD_STRING, offsetof(LocationNode, description), MAX_NAME_LENGTH, "Description", NULL }
+};
+
+// The array tables come straight from their schemas
+#define QUERY_SOURCE_ENTRY(Type, prefix, rows, table, FIELDS, view, onAdd) \
+    { #rows, table, sizeof(Type), prefix##Fields, (int)(sizeof(prefix##Fields) / sizeof(prefix##Fields[0])) },
+static const QuerySource querySources[] = {
+    RECORD_TABLES(QUERY_SOURCE_ENTRY)
+    { "locations", TABLE_LOCATIONS, sizeof(LocationNode), locationFields, 5 }
+};
+#define QUERY_SOURCE_COUNT ((int)(sizeof(querySources) / sizeof(querySources[0])))
+
+typedef enum { QOP_COMPARE, QOP_AND, QOP_OR, QOP_NOT } QueryOpcode;
+typedef enum { CMP_EQ, CMP_NE, CMP_LT, CMP_LE, CMP_GT, CMP_GE, CMP_CONTAINS, CMP_STARTS, CMP_ENDS } CompareOp;
+
+typedef struct QueryInstr {
+    unsigned char op;           // QueryOpcode
+    unsigned char cmp;          // CompareOp (QOP_COMPARE only)
+    unsigned char type;         // FieldType of the field
+    size_t offset;              // Field offset within the row
+    long number;                // Constant for FIELD_INT
+    size_t textLength;
+    char text[MAX_NAME_LENGTH]; // Constant for FIELD_STRING (lowercased for text search)
+} QueryInstr;
+
+typedef struct QueryProgram {
+    const QuerySource *source;
+    int count;
+    QueryInstr code[MAX_QUERY_OPS];
+    // Key constraints from the top-level 'and' chain, for index access
+    int keyPinned;              // An exact "key = value" was found
+    char keyEquals[MAX_NAME_LENGTH]; // Sized for the longest key field (program names)
+    int keyBounded;             // A lower and/or upper bound was found
+    char keyLow[MAX_NAME_LENGTH];
+    char keyHigh[MAX_NAME_LENGTH];
+    char error[MAX_QUERY_ERROR];
+} QueryProgram;
+
+typedef struct QueryParser {
+    const char *cursor;
+    char token[MAX_NAME_LENGTH];
+    int quoted;                 // The current token was a quoted string
+    int depth;                  // > 0 inside parentheses or 'not'
+    int topLevelOr;             // An 'or' at depth 0 means the key hints are unusable
+    QueryProgram *program;
+} QueryParser;
+
+// Matching rows, copied out of the table (or read from disk via an index)
+typedef struct QueryResult {
+    char *rows;
+    int count;
+    int capacity;
+    size_t rowSize;
+    const char *plan;           // How the rows were found
+} QueryResult;
+
+static int startsWithIgnoreCase(const char *text, const char *prefix, size_t prefixLength) {
+    for (size_t i = 0; i < prefixLength; i++) {
+        if (text[i] == '\0' || lowerChar(text[i]) != prefix[i]) return 0;
+    }
+    return 1;
+}
+
+static int endsWithIgnoreCase(const char *text, const char *suffix, size_t suffixLength) {
+    size_t length = strlen(text);
+    return length >= suffixLength && startsWithIgnoreCase(text + length - suffixLength, suffix, suffixLength);
+}
+
+static int evalCompare(const QueryInstr *in, const char *row) {
+    int order;
+    if (in->type == FIELD_INT || in->type == FIELD_GPA) {
+        long value = *(const int *)(row + in->offset);
+        if (in->type == FIELD_GPA && !hasGpa((int)value)) return in->cmp == CMP_NE; // No GPA compares with nothing
+        order = (value > in->number) - (value < in->number);
+    } else {
+        const char *value = row + in->offset;
+        switch (in->cmp) {
+            case CMP_CONTAINS: return containsIgnoreCase(value, in->text, in->textLength);
+            case CMP_STARTS: return startsWithIgnoreCase(value, in->text, in->textLength);
+            case CMP_ENDS: return endsWithIgnoreCase(value, in->text, in->textLength);
+            default: order = strcmp(value, in->text); break;
+        }
+    }
+    switch (in->cmp) {
+        case CMP_EQ: return order == 0;
+        case CMP_NE: return order != 0;
+        case CMP_LT: return order < 0;
+        case CMP_LE: return order <= 0;
+        case CMP_GT: return order > 0;
+        case CMP_GE: return order >= 0;
+        default: return 0;
+    }
+}
+
+// Runs the compiled predicate against one row
+int queryMatches(const QueryProgram *program, const void *row) {
+    unsigned char stack[MAX_QUERY_OPS];
+    int top = 0;
+    if (program->count == 0) return 1; // No filter
+    for (int pc = 0; pc < program->count; pc++) {
+        const QueryInstr *in = &program->code[pc];
+        switch (in->op) {
+            case QOP_COMPARE: stack[top++] = (unsigned char)evalCompare(in, (const char *)row); break;
+            case QOP_AND: top--; stack[top - 1] = stack[top - 1] && stack[top]; break;
+            case QOP_OR: top--; stack[top - 1] = stack[top - 1] || stack[top]; break;
+            case QOP_NOT: stack[top - 1] = !stack[top - 1]; break;
+        }
+    }
+    return stack[0];
+}
+
+// Reads the next token into parser->token; returns 0 at the end of the input
+static int queryNextToken(QueryParser *p) {
+    const char *s = p->cursor;
+    size_t n = 0;
+    while (isspace((unsigned char)*s)) s++;
+    p->quoted = 0;
+    p->token[0] = '\0';
+    if (*s == '\0') {
+        p->cursor = s;
+        return 0;
+    }
+
+    if (*s == '"' || *s == '\'') {
+        char quote = *s++;
+        while (*s && *s != quote && n < sizeof(p->token) - 1) p->token[n++] = *s++;
+        if (*s == quote) s++;
+        p->quoted = 1;
+    } else if (strchr("()", *s)) {
+        p->token[n++] = *s++;
+    } else if (strchr("=!<>", *s)) {
+        p->token[n++] = *s++;
+        if (*s == '=' || (p->token[0] == '<' && *s == '>')) p->token[n++] = *s++;
+    } else {
+        while (*s && !isspace((unsigned char)*s) && !strchr("()=!<>\"'", *s) && n < sizeof(p->token) - 1) {
+            p->token[n++] = *s++;
+        }
+    }
+    p->token[n] = '\0';
+    p->cursor = s;
+    return 1;
+}
+
+static int tokenIs(const QueryParser *p, const char *word) {
+    if (p->quoted) return 0;
+    for (const char *t = p->token; ; t++, word++) {
+        if (lowerChar(*t) != *word) return 0;
+        if (*t == '\0') return 1;
+    }
+}
+
+static int queryEmit(QueryParser *p, QueryOpcode op) {
+    QueryProgram *program = p->program;
+    if (program->count >= MAX_QUERY_OPS) {
+        snprintf(program->error, MAX_QUERY_ERROR, "Filter is too long (at most %d terms).", MAX_QUERY_OPS / 2);
+        return 0;
+    }
+    memset(&program->code[program->count], 0, sizeof(QueryInstr));
+    program->code[program->count].op = (unsigned char)op;
+    program->count++;
+    return 1;
+}
+
+static int parseQueryOr(QueryParser *p);
+
+// Narrows the key hints with a comparison made at the top level of the filter
+static void noteKeyConstraint(QueryProgram *program, CompareOp cmp, const char *value) {
+    switch (cmp) {
+        case CMP_EQ:
+            program->keyPinned = 1;
+            snprintf(program->keyEquals, sizeof(program->keyEquals), "%s", value);
+            break;
+        case CMP_GT: case CMP_GE:
+            if (!program->keyBounded || strcmp(value, program->keyLow) > 0) snprintf(program->keyLow, sizeof(program->keyLow), "%s", value);
+            if (!program->keyBounded) strcpy(program->keyHigh, QUERY_KEY_MAX);
+            program->keyBounded = 1;
+            break;
+        case CMP_LT: case CMP_LE:
+            if (!program->keyBounded || strcmp(value, program->keyHigh) < 0) snprintf(program->keyHigh, sizeof(program->keyHigh), "%s", value);
+            program->keyBounded = 1;
+            break;
+        default:
+            break;
+    }
+}
+
+// comparison := field op value | '(' expr ')' | 'not' comparison
+static int parseQueryTerm(QueryParser *p) {
+    QueryProgram *program = p->program;
+    if (tokenIs(p, "not")) {
+        p->depth++;
+        if (!queryNextToken(p) || !parseQueryTerm(p)) return 0;
+        p->depth--;
+        return queryEmit(p, QOP_NOT);
+    }
+    if (tokenIs(p, "(")) {
+        p->depth++;
+        if (!queryNextToken(p) || !parseQueryOr(p)) return 0;
+        if (!tokenIs(p, ")")) {
+            snprintf(program->error, MAX_QUERY_ERROR, "Missing ')'.");
+            return 0;
+        }
+        p->depth--;
+        queryNextToken(p);
+        return 1;
+    }
+
+    const RecordField *field = NULL;
+    for (int f = 0; f < program->source->fieldCount; f++) {
+        if (tokenIs(p, program->source->fields[f].name)) field = &program->source->fields[f];
+    }
+    if (field == NULL) {
+        snprintf(program->error, MAX_QUERY_ERROR, "Unknown field '%.40s' for %s.", p->token, program->source->name);
+        return 0;
+    }
+
+    static const char *opNames[] = { "=", "!=", "<", "<=", ">", ">=", "contains", "startswith", "endswith" };
+    int cmp = -1;
+    queryNextToken(p);
+    for (int c = 0; c < 9; c++) if (tokenIs(p, opNames[c])) cmp = c;
+    if (tokenIs(p, "==")) cmp = CMP_EQ;
+    if (tokenIs(p, "<>")) cmp = CMP_NE;
+    if (cmp < 0) {
+        snprintf(program->error, MAX_QUERY_ERROR, "Expected an operator after '%s'.", field->name);
+        return 0;
+    }
+    if (!queryNextToken(p)) {
+        snprintf(program->error, MAX_QUERY_ERROR, "Missing value after '%s'.", opNames[cmp]);
+        return 0;
+    }
+
+    if (!queryEmit(p, QOP_COMPARE)) return 0;
+    QueryInstr *in = &program->code[program->count - 1];
+    in->cmp = (unsigned char)cmp;
+    in->type = (unsigned char)field->type;
+    in->offset = field->offset;
+    if (field->type == FIELD_INT) {
+        char *end;
+        in->number = strtol(p->token, &end, 10);
+        if (end == p->token || *end != '\0' || cmp >= CMP_CONTAINS) {
+            snprintf(program->error, MAX_QUERY_ERROR, "'%s' takes a number and =, !=, <, <=, > or >=.", field->name);
+            return 0;
+        }
+    } else if (field->type == FIELD_GPA) {
+        int gpa;
+        if (!parseGpa(p->token, &gpa) || cmp >= CMP_CONTAINS) {
+            snprintf(program->error, MAX_QUERY_ERROR, "'%s' takes a GPA from 0 to 10 and =, !=, <, <=, > or >=.", field->name);
+            return 0;
+        }
+        in->number = gpa;
+    } else {
+        strcpy(in->text, p->token);
+        in->textLength = strlen(in->text);
+        if (cmp >= CMP_CONTAINS) {
+            for (size_t i = 0; i < in->textLength; i++) in->text[i] = (char)lowerChar(in->text[i]);
+        }
+        if (field == &program->source->fields[0] && p->depth == 0) noteKeyConstraint(program, (CompareOp)cmp, in->text);
+    }
+    queryNextToken(p);
+    return 1;
+}
+
+static int parseQueryAnd(QueryParser *p) {
+    if (!parseQueryTerm(p)) return 0;
+    while (tokenIs(p, "and")) {
+        if (!queryNextToken(p) || !parseQueryTerm(p) || !queryEmit(p, QOP_AND)) return 0;
+    }
+    return 1;
+}
+
+static int parseQueryOr(QueryParser *p) {
+    if (!parseQueryAnd(p)) return 0;
+    while (tokenIs(p, "or")) {
+        if (p->depth == 0) p->topLevelOr = 1;
+        if (!queryNextToken(p) || !parseQueryAnd(p) || !queryEmit(p, QOP_OR)) return 0;
+    }
+    return 1;
+}
+
+// Compiles "<table> [where <filter>]"; on failure returns 0 with program->error set
+int compileQuery(const char *text, QueryProgram *program) {
+    QueryParser parser = { text, "", 0, 0, 0, program };
+    memset(program, 0, sizeof(*program));
+
+    if (!queryNextToken(&parser)) {
+        snprintf(program->error, MAX_QUERY_ERROR, "Empty query. Start with students, courses, faculty, programs or locations.");
+        return 0;
+    }
+    for (int s = 0; s < QUERY_SOURCE_COUNT; s++) {
+        const char *name = querySources[s].name;
+        size_t length = strlen(parser.token);
+        // Accept the singular too ("student", "course", "location")
+        if (tokenIs(&parser, name) || (length + 1 == strlen(name) && strncmp(name, parser.token, length) == 0)) {
+            program->source = &querySources[s];
+        }
+    }
+    if (program->source == NULL) {
+        snprintf(program->error, MAX_QUERY_ERROR, "Unknown table '%.40s'.", parser.token);
+        return 0;
+    }
+
+    if (queryNextToken(&parser)) {
+        if (!tokenIs(&parser, "where") || !queryNextToken(&parser)) {
+            snprintf(program->error, MAX_QUERY_ERROR, "Expected 'where <filter>' after the table name.");
+            return 0;
+        }
+        if (!parseQueryOr(&parser)) return 0;
+        if (parser.token[0] != '\0') {
+            snprintf(program->error, MAX_QUERY_ERROR, "Unexpected '%.40s'.", parser.token);
+            return 0;
+        }
+    }
+    if (parser.topLevelOr) program->keyPinned = program->keyBounded = 0;
+    return 1;
+}
+
+static void queryResultAdd(QueryResult *result, const void *row) {
+    if (result->count == result->capacity) {
+        int newCapacity = result->capacity ? result->capacity * 2 : 64;
+        char *grown = (char *)realloc(result->rows, result->rowSize * newCapacity);
+        if (grown == NULL) return;
+        result->rows = grown;
+        result->capacity = newCapacity;
+    }
+    memcpy(result->rows + result->rowSize * result->count++, row, result->rowSize);
+}
+
+void freeQueryResult(QueryResult *result) {
+    free(result->rows);
+    memset(result, 0, sizeof(*result));
+}
+
+// Tight scan over a contiguous row array; 'result' may be NULL to only count
+int queryScanRows(const QueryProgram *program, const void *rows, int count, QueryResult *result) {
+    const char *row = (const char *)rows;
+    size_t rowSize = program->source->rowSize;
+    int matches = 0;
+    for (int i = 0; i < count; i++, row += rowSize) {
+        if (queryMatches(program, row)) {
+            matches++;
+            if (result) queryResultAdd(result, row);
+        }
+    }
+    return matches;
+}
+
+typedef struct QueryRangeContext {
+    const QueryProgram *program;
+    QueryResult *result;
+} QueryRangeContext;
+
+static int queryRangeVisit(const char *key, int64_t offset, void *ctx) {
+    QueryRangeContext *range = (QueryRangeContext *)ctx;
+    TableID table = range->program->source->table;
+    char line[MAX_LINE_LENGTH];
+    AnyRecord row;
+    if (!readRecordLineAt(table, offset, key, line, MAX_LINE_LENGTH)) return 1;
+    if (!recordSchema(table)->parseLine(line, &row)) return 1;
+    if (queryMatches(range->program, &row)) queryResultAdd(range->result, &row);
+    return 1;
+}
+
+// Finds the matching rows, through an index when the filter allows it
+void runQuery(const QueryProgram *program, QueryResult *result) {
+    TableID table = program->source->table;
+    memset(result, 0, sizeof(*result));
+    result->rowSize = program->source->rowSize;
+
+    if (recordIndexable(table)) {
+        AnyRecord row;
+        if (program->keyPinned) {
+            int found = indexLookupRecord(table, program->keyEquals, &row);
+            if (found && queryMatches(program, &row)) queryResultAdd(result, &row);
+            if (openRecordIndex(table) != NULL) {
+                result->plan = "B+tree index lookup";
+                return;
+            }
+            result->count = 0; // No usable index; fall through to a scan
+        } else if (program->keyBounded && !isTableLoaded(table)) {
+            // Reading ranged rows from disk beats loading the whole table first
+            BPlusTree *tree = openRecordIndex(table);
+            if (tree) {
+                QueryRangeContext range = { program, result };
+                bptRangeScan(tree, program->keyLow, program->keyHigh, queryRangeVisit, &range);
+                result->plan = "B+tree range scan";
+                return;
+            }
+        }
+    }
+
+    // Scans read the published snapshot; matching rows are copied out before it is released
+    int slot = epochEnter();
+    const TableSnapshot *snapshot = currentSnapshot(table);
+    result->plan = "full scan";
+    if (snapshot == NULL) {
+        // Nothing published (the table has no snapshot form)
+    } else if (table == TABLE_LOCATIONS) {
+        if (program->keyPinned) {
+            LocationNode *node = findLocationIn(snapshot->locations, program->keyEquals);
+            if (node && queryMatches(program, node)) queryResultAdd(result, node);
+            result->plan = "hash table lookup";
+        } else {
+            for (int i = 0; i < HASH_SIZE; i++) {
+                for (LocationNode *node = snapshot->locations->buckets[i]; node; node = node->next) {
+                    if (queryMatches(program, node)) queryResultAdd(result, node);
+                }
+            }
+        }
+    } else {
+        queryScanRows(program, snapshot->rows, snapshot->count, result);
+    }
+    epochExit(slot);
+}
+
+void printQueryTable(const QuerySource *source, const QueryResult *result) {
+    TableView view;
+    const char *headers[MAX_TABLE_COLUMNS];
+    const char *cellPointers[MAX_TABLE_COLUMNS];
+    char cells[MAX_TABLE_COLUMNS][MAX_NAME_LENGTH];
+    for (int f = 0; f < source->fieldCount; f++) headers[f] = source->fields[f].name;
+    tvInitColumns(&view, source->fieldCount, headers);
+    for (int f = 0; f < source->fieldCount; f++) {
+        if (source->fields[f].type == FIELD_INT || source->fields[f].type == FIELD_GPA) tvAlignRight(&view, f);
+    }
+    for (int r = 0; r < result->count; r++) {
+        const char *row = result->rows + result->rowSize * r;
+        for (int f = 0; f < source->fieldCount; f++) {
+            cellPointers[f] = formatRecordCell(&source->fields[f], row, cells[f], MAX_NAME_LENGTH);
+        }
+        tvAddRowCells(&view, cellPointers);
+    }
+    tvRender(&view, stdout);
+}
+
+// RFC 4180 style: quote fields that contain a comma, quote or line break
+void writeCsvField(FILE *out, const char *text) {
+    if (strpbrk(text, ",\"\r\n") == NULL) {
+        fputs(text, out);
+        return;
+    }
+    fputc('"', out);
+    for (; *text; text++) {
+        if (*text == '"') fputc('"', out);
+        fputc(*text, out);
+    }
+    fputc('"', out);
+}
+
+// 'campus' (may be NULL) is written as an extra first column
+static void writeQueryCsvRows(const QuerySource *source, const QueryResult *result, const char *campus, FILE *out) {
+    char cell[MAX_NAME_LENGTH];
+    for (int r = 0; r < result->count; r++) {
+        const char *row = result->rows + result->rowSize * r;
+        if (campus) {
+            writeCsvField(out, campus);
+            fputc(',', out);
+        }
+        for (int f = 0; f < source->fieldCount; f++) {
+            if (f) fputc(',', out);
+            writeCsvField(out, formatRecordCell(&source->fields[f], row, cell, sizeof(cell)));
+        }
+        fputc('\n', out);
+    }
+}
+
+static void writeQueryCsvHeader(const QuerySource *source, int withCampus, FILE *out) {
+    if (withCampus) fputs("campus,", out);
+    for (int f = 0; f < source->fieldCount; f++) {
+        if (f) fputc(',', out);
+        fputs(source->fields[f].name, out);
+    }
+    fputc('\n', out);
+}
+
+void writeQueryCsv(const QuerySource *source, const QueryResult *result, FILE *out) {
+    writeQueryCsvHeader(source, 0, out);
+    writeQueryCsvRows(source, result, NULL, out);
+}
+
+// Times the compiled scan over 'rows' synthetic students (not persisted)
+int benchmarkQuery(const char *text, int rows) {
+    QueryProgram program;
+    if (!compileQuery(text, &program)) {
+        printf("Query error: %s\n", program.error);
+        return 0;
+    }
+    if (program.source->table != TABLE_STUDENTS) {
+        printf("The benchmark generates student rows; query 'students where ...'.\n");
+        return 0;
+    }
+    static const char *programs[] = { "BSc CS", "BEng ME", "BTech IT", "BA Econ", "MSc Data" };
+    static const char *domains[] = { "@uni.edu", "@alumni.uni.edu", "@mail.com" };
+    Student *data = (Student *)malloc(sizeof(Student) * (size_t)rows);
+    if (data == NULL) {
+        printf("Error: Not enough memory for %d rows.\n", rows);
+        return 0;
+    }
+    for (int i = 0; i < rows; i++) {
+        snprintf(data[i].id, MAX_ID_LENGTH, "S%07d", i);
+        snprintf(data[i].name, MAX_NAME_LENGTH, "Student %d", i);
+        strcpy(data[i].program, programs[i % 5]);
+        snprintf(data[i].email, MAX_NAME_LENGTH, "s%d%s", i, domains[(i / 5) % 3]);
+        snprintf(data[i].semester, MAX_ID_LENGTH, "%d-%d", 2015 + i % 10, 1 + i % 2);
+    }
+
+    double start = monotonicMillis();
+    int matches = queryScanRows(&program, data, rows, NULL);
+    double elapsed = monotonicMillis() - start;
+    printf("Scanned %d rows in %.2f ms (%.1f M rows/s); %d matched.\n",
+           rows, elapsed, elapsed > 0 ? rows / elapsed / 1000.0 : 0.0, matches);
+    free(data);
+    return 1;
+}
+
+// --- Fan-out over every campus (--campus all --query) ---
+// Each shard gets its own thread, which reads that campus's copy of the table
+// into private memory and scans it. Nothing loaded in this process is touched,
+// so the shards are queried side by side without locks.
+
+typedef struct CampusQuery {
+    const QueryProgram *program;
+    char campus[MAX_ID_LENGTH];
+    QueryResult result;
+    int failed;                 // The shard's table file could not be read
+} CampusQuery;
+
+THREAD_FUNC(campusQueryMain, arg) {
+    CampusQuery *job = (CampusQuery *)arg;
+    const QuerySource *source = job->program->source;
+    const RecordSchema *schema = recordSchema(source->table);
+    char directory[MAX_LINE_LENGTH], path[MAX_LINE_LENGTH * 2];
+    int version = 0;
+    campusDirectory(job->campus, directory, sizeof(directory));
+    snprintf(path, sizeof(path), "%s/%s", directory, tableFileNames[source->table]);
+    job->result.rowSize = source->rowSize;
+    job->result.plan = "full scan";
+
+    if (schema) {
+        void *rows = malloc(schema->rowSize * MAX_RECORDS);
+        int count = rows ? schema->parseFile(path, rows, MAX_RECORDS, &version) : -1;
+        if (count < 0) job->failed = 1;
+        else queryScanRows(job->program, rows, count, &job->result);
+        free(rows);
+    } else {
+        LocationTable *locations = (LocationTable *)malloc(sizeof(LocationTable));
+        if (locations == NULL) {
+            job->failed = 1;
+            THREAD_RETURN;
+        }
+        initLocationTable(locations);
+        if (parseLocationFile(path, locations, &version) < 0) {
+            job->failed = 1;
+        } else {
+            for (int i = 0; i < HASH_SIZE; i++) {
+                for (LocationNode *node = locations->buckets[i]; node; node = node->next) {
+                    if (queryMatches(job->program, node)) queryResultAdd(&job->result, node);
+                }
+            }
+        }
+        destroyLocationTable(locations);
+        free(locations);
+    }
+    THREAD_RETURN;
+}
+
+// Runs one query against every registered campus and prints the matches as
+// CSV, campus first, in registry order
+int runCampusQuery(const char *text) {
+    char campuses[MAX_CAMPUSES][MAX_ID_LENGTH];
+    int campusCount = loadCampusList(campuses, MAX_CAMPUSES);
+    QueryProgram program;
+    if (!compileQuery(text, &program)) {
+        printf("Query error: %s\n", program.error);
+        return 0;
+    }
+    if (campusCount == 0) {
+        printf("Error: No campuses are registered in %s.\n", CAMPUSES_FILE);
+        return 0;
+    }
+
+    CampusQuery *jobs = (CampusQuery *)calloc((size_t)campusCount, sizeof(CampusQuery));
+    Thread *threads = (Thread *)calloc((size_t)campusCount, sizeof(Thread));
+    int started[MAX_CAMPUSES];
+    if (jobs == NULL || threads == NULL) {
+        printf("Error: Not enough memory for %d campuses.\n", campusCount);
+        free(jobs);
+        free(threads);
+        return 0;
+    }
+    for (int c = 0; c < campusCount; c++) {
+        jobs[c].program = &program;
+        strcpy(jobs[c].campus, campuses[c]);
+        started[c] = threadStart(&threads[c], campusQueryMain, &jobs[c]);
+        if (!started[c]) campusQueryMain(&jobs[c]); // Could not spawn: scan this shard here
+    }
+    for (int c = 0; c < campusCount; c++) {
+        if (started[c]) threadJoin(threads[c]);
+    }
+
+    int ok = 1;
+    writeQueryCsvHeader(program.source, 1, stdout);
+    for (int c = 0; c < campusCount; c++) {
+        if (jobs[c].failed) {
+            fprintf(stderr, "Warning: Could not read %s for campus %s.\n", program.source->name, jobs[c].campus);
+            ok = 0;
+        }
+        writeQueryCsvRows(program.source, &jobs[c].result, jobs[c].campus, stdout);
+        freeQueryResult(&jobs[c].result);
+    }
+    free(jobs);
+    free(threads);
+    return ok;
+}
+
+
+// --- SEMESTER ARCHIVE (COMPRESSED READ-ONLY SEGMENTS) ---
+// Records older than a cutoff semester are moved out of the live .dat files
+// into numbered, immutable segment files. Inside a segment, records are sorted
+// by key and front coded (each key stores only the suffix it does not share
+// with the previous one), and repeated strings such as programs, email domains
+// and semesters are replaced by indexes into a per-segment dictionary. Every
+// SEGMENT_RESTART_INTERVAL records the key is stored in full and its offset is
+// kept in a restart table, so a lookup binary-searches the restarts and then
+// decodes a single small block without loading the segment into memory.
+//
+// Layout: SegmentHeader | record blocks | dictionary | restart offsets
+
+#define SEGMENT_MAGIC "UGSEG02" // 02: records carry their course lists
+#define SEGMENT_RESTART_INTERVAL 16
+#define MAX_ARCHIVE_SEGMENTS 999
+
+typedef struct SegmentHeader {
+    char magic[8];
+    uint32_t table;
+    uint32_t recordCount;
+    uint32_t dictionaryCount;
+    uint32_t restartCount;
+    uint32_t dataOffset;
+    uint32_t dataLength;
+    uint32_t dictionaryOffset;
+    uint32_t restartOffset;
+    uint32_t rawBytes;       // What the same records take up in .dat form
+    char cutoff[16];         // Records are from semesters before this one
+} SegmentHeader;
+
+typedef struct StringDictionary {
+    int count;
+    int capacity;
+    char **entries;
+} StringDictionary;
+
+typedef struct ArchiveSegment {
+    FILE *fp;
+    SegmentHeader header;
+    char **dictionary;
+    uint32_t *restarts;
+} ArchiveSegment;
+
+static void segmentFileName(TableID table, int number, char *out, size_t size) {
+    snprintf(out, size, "archive_%s_%03d.seg", table == TABLE_STUDENTS ? "students" : "courses", number);
+}
+
+static void segmentPath(TableID table, int number, char *out, size_t size) {
+    char name[64];
+    segmentFileName(table, number, name, sizeof(name));
+    snprintf(out, size, "%s/%s", dataDirectory, name);
+}
+
+static int dictionaryIntern(StringDictionary *dict, const char *str) {
+    for (int i = 0; i < dict->count; i++) {
+        if (strcmp(dict->entries[i], str) == 0) return i;
+    }
+    if (dict->count == dict->capacity) {
+        int newCapacity = dict->capacity ? dict->capacity * 2 : 32;
+        char **grown = (char **)realloc(dict->entries, sizeof(char *) * newCapacity);
+        if (grown == NULL) return 0;
+        dict->entries = grown;
+        dict->capacity = newCapacity;
+    }
+    dict->entries[dict->count] = strdup(str);
+    return dict->count++;
+}
+
+static void dictionaryFree(StringDictionary *dict) {
+    for (int i = 0; i < dict->count; i++) free(dict->entries[i]);
+    free(dict->entries);
+    memset(dict, 0, sizeof(*dict));
+}
+
+// LEB128-style variable length integers: small numbers take one byte
+static void putVarint(TextBuffer *out, uint32_t value) {
+    unsigned char bytes[5];
+    int n = 0;
+    do {
+        bytes[n] = value & 0x7F;
+        value >>= 7;
+        if (value) bytes[n] |= 0x80;
+        n++;
+    } while (value);
+    tbAppendBytes(out, bytes, n);
+}
+
+static int getVarint(const unsigned char **cursor, const unsigned char *end, uint32_t *value) {
+    uint32_t result = 0;
+    for (int shift = 0; *cursor < end && shift <= 28; shift += 7) {
+        unsigned char byte = *(*cursor)++;
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void putString(TextBuffer *out, const char *str) {
+    size_t length = strlen(str);
+    putVarint(out, (uint32_t)length);
+    tbAppendBytes(out, str, length);
+}
+
+static int getString(const unsigned char **cursor, const unsigned char *end, char *dest, size_t size) {
+    uint32_t length;
+    if (!getVarint(cursor, end, &length) || (size_t)(end - *cursor) < length || length >= size) return 0;
+    memcpy(dest, *cursor, length);
+    dest[length] = '\0';
+    *cursor += length;
+    return 1;
+}
+
+// Front codes 'key' against the previous key; restart records store it whole
+static void putFrontCodedKey(TextBuffer *out, const char *key, const char *previous, int restart) {
+    uint32_t shared = 0;
+    if (!restart) {
+        while (key[shared] && key[shared] == previous[shared]) shared++;
+    }
+    putVarint(out, shared);
+    putString(out, key + shared);
+}
+
+static int getFrontCodedKey(const unsigned char **cursor, const unsigned char *end, char *key) {
+    uint32_t shared;
+    if (!getVarint(cursor, end, &shared) || shared >= MAX_ID_LENGTH) return 0;
+    return getString(cursor, end, key + shared, MAX_ID_LENGTH - shared);
+}
+
+// Students: key, name, program#, email local part, email domain#, semester#, completed
+static void encodeStudent(TextBuffer *out, StringDictionary *dict, const Student *s) {
+    char local[MAX_NAME_LENGTH];
+    const char *at = strchr(s->email, '@');
+    size_t localLength = at ? (size_t)(at - s->email) : strlen(s->email);
+    memcpy(local, s->email, localLength);
+    local[localLength] = '\0';
+
+    putString(out, s->name);
+    putVarint(out, dictionaryIntern(dict, s->program));
+    putString(out, local);
+    putVarint(out, dictionaryIntern(dict, at ? at : ""));
+    putVarint(out, dictionaryIntern(dict, s->semester));
+    putString(out, s->completed);
+}
+
+static int decodeStudent(const unsigned char **cursor, const unsigned char *end, char **dict, uint32_t dictCount, Student *s) {
+    uint32_t program, domain, semester;
+    char local[MAX_NAME_LENGTH];
+    if (!getString(cursor, end, s->name, MAX_NAME_LENGTH) || !getVarint(cursor, end, &program) ||
+        !getString(cursor, end, local, MAX_NAME_LENGTH) || !getVarint(cursor, end, &domain) ||
+        !getVarint(cursor, end, &semester) || !getString(cursor, end, s->completed, MAX_NAME_LENGTH)) return 0;
+    if (program >= dictCount || domain >= dictCount || semester >= dictCount) return 0;
+    strncpy(s->program, dict[program], MAX_NAME_LENGTH - 1); s->program[MAX_NAME_LENGTH - 1] = '\0';
+    snprintf(s->email, MAX_NAME_LENGTH, "%s%s", local, dict[domain]);
+    strncpy(s->semester, dict[semester], MAX_ID_LENGTH - 1); s->semester[MAX_ID_LENGTH - 1] = '\0';
+    s->gpa = GPA_NONE; // Segments do not keep GPAs
+    return 1;
+}
+
+// Courses: key, name, credits, semester#, prerequisites, corequisites
+static void encodeCourse(TextBuffer *out, StringDictionary *dict, const Course *c) {
+    putString(out, c->name);
+    putVarint(out, (uint32_t)c->credits);
+    putVarint(out, dictionaryIntern(dict, c->semester));
+    putString(out, c->prerequisites);
+    putString(out, c->corequisites);
+}
+
+static int decodeCourse(const unsigned char **cursor, const unsigned char *end, char **dict, uint32_t dictCount, Course *c) {
+    uint32_t credits, semester;
+    if (!getString(cursor, end, c->name, MAX_NAME_LENGTH) || !getVarint(cursor, end, &credits) ||
+        !getVarint(cursor, end, &semester) || semester >= dictCount ||
+        !getString(cursor, end, c->prerequisites, MAX_NAME_LENGTH) || !getString(cursor, end, c->corequisites, MAX_NAME_LENGTH)) return 0;
+    c->credits = (int)credits;
+    c->capacity = 0; // Seats are not kept for past semesters
+    strncpy(c->semester, dict[semester], MAX_ID_LENGTH - 1); c->semester[MAX_ID_LENGTH - 1] = '\0';
+    return 1;
+}
+
+static int compareRowKeys(const void *a, const void *b) {
+    return strcmp((const char *)a, (const char *)b); // Keys are the first member of every record
+}
+
+// Writes 'count' records (Student or Course rows) as a new segment.
+// Returns the segment number, or -1 on failure.
+int writeArchiveSegment(TableID table, void *rows, int count, const char *cutoff) {
+    size_t rowSize = recordSchema(table)->rowSize;
+    qsort(rows, count, rowSize, compareRowKeys);
+
+    TextBuffer data = {0}, tail = {0};
+    StringDictionary dict = {0};
+    uint32_t *restarts = (uint32_t *)malloc(sizeof(uint32_t) * (count / SEGMENT_RESTART_INTERVAL + 1));
+    uint32_t restartCount = 0, rawBytes = 0;
+    const char *previous = "";
+    if (restarts == NULL) return -1;
+
+    for (int i = 0; i < count; i++) {
+        const char *row = (const char *)rows + i * rowSize;
+        int restart = (i % SEGMENT_RESTART_INTERVAL) == 0;
+        if (restart) restarts[restartCount++] = (uint32_t)data.length;
+        putFrontCodedKey(&data, row, previous, restart);
+        if (table == TABLE_STUDENTS) {
+            const Student *s = (const Student *)row;
+            encodeStudent(&data, &dict, s);
+            rawBytes += strlen(s->id) + strlen(s->name) + strlen(s->program) + strlen(s->email) + strlen(s->semester) + strlen(s->completed) + 6;
+        } else {
+            const Course *c = (const Course *)row;
+            encodeCourse(&data, &dict, c);
+            rawBytes += strlen(c->code) + strlen(c->name) + strlen(c->semester) + strlen(c->prerequisites) + strlen(c->corequisites) + 8;
+        }
+        previous = row;
+    }
+
+    SegmentHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SEGMENT_MAGIC, sizeof(header.magic));
+    header.table = (uint32_t)table;
+    header.recordCount = (uint32_t)count;
+    header.dictionaryCount = (uint32_t)dict.count;
+    header.restartCount = restartCount;
+    header.dataOffset = sizeof(SegmentHeader);
+    header.dataLength = (uint32_t)data.length;
+    header.rawBytes = rawBytes;
+    strncpy(header.cutoff, cutoff, sizeof(header.cutoff) - 1);
+
+    for (int i = 0; i < dict.count; i++) putString(&tail, dict.entries[i]);
+    header.dictionaryOffset = header.dataOffset + header.dataLength;
+    header.restartOffset = header.dictionaryOffset + (uint32_t)tail.length;
+    tbAppendBytes(&tail, restarts, sizeof(uint32_t) * restartCount);
+
+    // Pick the next free segment number, write to a temp file, then rename into place
+    char path[MAX_LINE_LENGTH], tempPath[MAX_LINE_LENGTH + 8];
+    int number = 1;
+    struct stat st;
+    for (; number <= MAX_ARCHIVE_SEGMENTS; number++) {
+        segmentPath(table, number, path, sizeof(path));
+        if (stat(path, &st) != 0) break;
+    }
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+
+    int ok = 0;
+    FILE *fp = (number <= MAX_ARCHIVE_SEGMENTS) ? fopen(tempPath, "wb") : NULL;
+    if (fp) {
+        ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+             (data.length == 0 || fwrite(data.data, data.length, 1, fp) == 1) &&
+             (tail.length == 0 || fwrite(tail.data, tail.length, 1, fp) == 1);
+        ok = (fclose(fp) == 0) && ok;
+        ok = ok && rename(tempPath, path) == 0;
+        if (!ok) remove(tempPath);
+    }
+
+    free(restarts);
+    free(data.data);
+    free(tail.data);
+    dictionaryFree(&dict);
+    return ok ? number : -1;
+}
+
+void closeArchiveSegment(ArchiveSegment *seg) {
+    if (seg == NULL) return;
+    if (seg->fp) fclose(seg->fp);
+    if (seg->dictionary) {
+        for (uint32_t i = 0; i < seg->header.dictionaryCount; i++) free(seg->dictionary[i]);
+        free(seg->dictionary);
+    }
+    free(seg->restarts);
+    free(seg);
+}
+
+// Opens a segment, keeping only its dictionary and restart table in memory
+ArchiveSegment* openArchiveSegment(TableID table, int number) {
+    char path[MAX_LINE_LENGTH];
+    segmentPath(table, number, path, sizeof(path));
+    ArchiveSegment *seg = (ArchiveSegment *)calloc(1, sizeof(ArchiveSegment));
+    if (seg == NULL) return NULL;
+    seg->fp = fopen(path, "rb");
+    if (seg->fp == NULL || fread(&seg->header, sizeof(SegmentHeader), 1, seg->fp) != 1 ||
+        memcmp(seg->header.magic, SEGMENT_MAGIC, sizeof(seg->header.magic)) != 0) {
+        closeArchiveSegment(seg);
+        return NULL;
+    }
+
+    uint32_t dictBytes = seg->header.restartOffset - seg->header.dictionaryOffset;
+    unsigned char *dictData = (unsigned char *)malloc(dictBytes + 1);
+    seg->dictionary = (char **)calloc(seg->header.dictionaryCount + 1, sizeof(char *));
+    seg->restarts = (uint32_t *)malloc(sizeof(uint32_t) * (seg->header.restartCount + 1));
+    int ok = dictData && seg->dictionary && seg->restarts &&
+             fseek(seg->fp, seg->header.dictionaryOffset, SEEK_SET) == 0 &&
+             (dictBytes == 0 || fread(dictData, dictBytes, 1, seg->fp) == 1) &&
+             (seg->header.restartCount == 0 ||
+              fread(seg->restarts, sizeof(uint32_t) * seg->header.restartCount, 1, seg->fp) == 1);
+
+    const unsigned char *cursor = dictData, *end = dictData + dictBytes;
+    for (uint32_t i = 0; ok && i < seg->header.dictionaryCount; i++) {
+        char entry[MAX_LINE_LENGTH];
+        ok = getString(&cursor, end, entry, sizeof(entry)) && (seg->dictionary[i] = strdup(entry)) != NULL;
+    }
+    free(dictData);
+    if (!ok) {
+        closeArchiveSegment(seg);
+        return NULL;
+    }
+    return seg;
+}
+
+// Reads the bytes of restart block 'block' into a fresh buffer
+static unsigned char* readSegmentBlock(ArchiveSegment *seg, uint32_t block, uint32_t *length) {
+    uint32_t start = seg->restarts[block];
+    uint32_t stop = (block + 1 < seg->header.restartCount) ? seg->restarts[block + 1] : seg->header.dataLength;
+    unsigned char *bytes = (unsigned char *)malloc(stop - start + 1);
+    if (bytes == NULL) return NULL;
+    if (fseek(seg->fp, seg->header.dataOffset + start, SEEK_SET) != 0 ||
+        (stop > start && fread(bytes, stop - start, 1, seg->fp) != 1)) {
+        free(bytes);
+        return NULL;
+    }
+    *length = stop - start;
+    return bytes;
+}
+
+// The first key of each block is stored whole, so it decodes on its own
+static int readRestartKey(ArchiveSegment *seg, uint32_t block, char *key) {
+    unsigned char bytes[MAX_ID_LENGTH + 8];
+    uint32_t stop = (block + 1 < seg->header.restartCount) ? seg->restarts[block + 1] : seg->header.dataLength;
+    size_t want = stop - seg->restarts[block];
+    if (want > sizeof(bytes)) want = sizeof(bytes);
+    if (fseek(seg->fp, seg->header.dataOffset + seg->restarts[block], SEEK_SET) != 0 ||
+        fread(bytes, 1, want, seg->fp) != want) return 0;
+    const unsigned char *cursor = bytes;
+    return getFrontCodedKey(&cursor, bytes + want, key);
+}
+
+// Finds one record by key; 'out' is a Student or Course depending on the segment
+int segmentFindRecord(ArchiveSegment *seg, const char *key, void *out) {
+    if (seg->header.restartCount == 0) return 0;
+
+    // Last block whose first key is <= key
+    int lo = 0, hi = (int)seg->header.restartCount - 1, block = -1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        char first[MAX_ID_LENGTH] = {0};
+        if (!readRestartKey(seg, mid, first)) return 0;
+        if (strcmp(first, key) <= 0) { block = mid; lo = mid + 1; } else hi = mid - 1;
+    }
+    if (block < 0) return 0;
+
+    uint32_t length;
+    unsigned char *bytes = readSegmentBlock(seg, block, &length);
+    if (bytes == NULL) return 0;
+    const unsigned char *cursor = bytes, *end = bytes + length;
+    char current[MAX_ID_LENGTH] = {0};
+    int found = 0;
+    while (cursor < end && !found) {
+        if (!getFrontCodedKey(&cursor, end, current)) break;
+        int ok;
+        if (seg->header.table == TABLE_STUDENTS) {
+            Student *s = (Student *)out;
+            ok = decodeStudent(&cursor, end, seg->dictionary, seg->header.dictionaryCount, s);
+            if (ok) strcpy(s->id, current);
+        } else {
+            Course *c = (Course *)out;
+            ok = decodeCourse(&cursor, end, seg->dictionary, seg->header.dictionaryCount, c);
+            if (ok) strcpy(c->code, current);
+        }
+        if (!ok) break;
+        int cmp = strcmp(current, key);
+        if (cmp == 0) found = 1;
+        else if (cmp > 0) break;
+    }
+    free(bytes);
+    return found;
+}
+
+// Number of the newest segment of a table, 0 if it has none
+int lastArchiveSegment(TableID table) {
+    char path[MAX_LINE_LENGTH];
+    struct stat st;
+    int last = 0;
+    while (last < MAX_ARCHIVE_SEGMENTS) {
+        segmentPath(table, last + 1, path, sizeof(path));
+        if (stat(path, &st) != 0) break;
+        last++;
+    }
+    return last;
+}
+
+// Searches every segment of a table, newest first
+int archiveLookup(TableID table, const char *key, void *out) {
+    for (int number = lastArchiveSegment(table); number >= 1; number--) {
+        ArchiveSegment *seg = openArchiveSegment(table, number);
+        if (seg == NULL) continue;
+        int found = segmentFindRecord(seg, key, out);
+        closeArchiveSegment(seg);
+        if (found) return 1;
+    }
+    return 0;
+}
+
+static int sameFileBytes(const char *a, const char *b) {
+    FILE *fa = fopen(a, "rb"), *fb = fopen(b, "rb");
+    int same = fa != NULL && fb != NULL;
+    while (same) {
+        char chunkA[4096], chunkB[4096];
+        size_t readA = fread(chunkA, 1, sizeof(chunkA), fa);
+        size_t readB = fread(chunkB, 1, sizeof(chunkB), fb);
+        same = readA == readB && memcmp(chunkA, chunkB, readA) == 0;
+        if (readA == 0) break;
+    }
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return same;
+}
+
+// Copies a segment file byte for byte, through a temp file and a rename so a
+// reader never sees half of it
+static int copySegmentFile(const char *from, const char *to) {
+    char tempPath[MAX_LINE_LENGTH * 3 + 8];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", to);
+    FILE *in = fopen(from, "rb");
+    FILE *out = in ? fopen(tempPath, "wb") : NULL;
+    int ok = out != NULL;
+    char chunk[4096];
+    size_t read;
+    while (ok && (read = fread(chunk, 1, sizeof(chunk), in)) > 0) ok = fwrite(chunk, 1, read, out) == read;
+    if (in) fclose(in);
+    if (out) ok = (fclose(out) == 0) && ok;
+    ok = ok && rename(tempPath, to) == 0;
+    if (out && !ok) remove(tempPath);
+    return ok;
+}
+
+// Adds a segment written by another instance (a replicated primary) as this
+// instance's next segment of 'table'. Installing the same segment again is a
+// no-op, so a replayed batch cannot duplicate it. Returns 1 once it is in place.
+int installArchiveSegment(TableID table, const char *source) {
+    char path[MAX_LINE_LENGTH];
+    int last = lastArchiveSegment(table);
+    for (int number = 1; number <= last; number++) {
+        segmentPath(table, number, path, sizeof(path));
+        if (sameFileBytes(source, path)) return 1;
+    }
+    if (last == MAX_ARCHIVE_SEGMENTS) return 0;
+    segmentPath(table, last + 1, path, sizeof(path));
+    return copySegmentFile(source, path);
+}
+
+// Moves every student/course from a semester before 'cutoff' into a new segment
+// per table, then rewrites the live table without them. The segment is written
+// first, so a crash in between leaves a duplicate rather than losing records.
+int archiveBeforeSemester(const char *cutoff, int *archivedStudents, int *archivedCourses) {
+    TableID tables[2] = { TABLE_STUDENTS, TABLE_COURSES };
+    int *archived[2] = { archivedStudents, archivedCourses };
+
+    for (int t = 0; t < 2; t++) {
+        TableID table = tables[t];
+        ensureTableLoaded(table);
+        const RecordSchema *schema = recordSchema(table);
+        size_t rowSize = schema->rowSize;
+        char *rows = (char *)schema->rows;
+        int *count = schema->count;
+
+        char *old = (char *)malloc(rowSize * (*count + 1));
+        if (old == NULL) return 0;
+        int oldCount = 0;
+        for (int i = 0; i < *count; i++) {
+            const char *semester = (table == TABLE_STUDENTS) ? students[i].semester : courses[i].semester;
+            if (semester[0] != '\0' && strcmp(semester, cutoff) < 0) {
+                memcpy(old + oldCount * rowSize, rows + i * rowSize, rowSize);
+                oldCount++;
+            }
+        }
+        *archived[t] = oldCount;
+        if (oldCount == 0) {
+            free(old);
+            continue;
+        }
+        int segment = writeArchiveSegment(table, old, oldCount, cutoff);
+        if (segment < 0) {
+            printf("Error: Could not write the %s archive segment.\n", tableNames[table]);
+            free(old);
+            return 0;
+        }
+        if (shipDirectory[0] != '\0') shipArchiveSegment(table, segment); // Ahead of the deletes below
+
+        // Drop the archived rows from the live table and persist it
+        for (int i = 0; i < oldCount; i++) {
+            const char *key = old + i * rowSize;
+            int index = findRowByKey(rows, rowSize, *count, key);
+            if (index < 0) continue;
+            statsRowChanged(table, rows + index * rowSize, -1);
+            memmove(rows + index * rowSize, rows + (index + 1) * rowSize, (*count - index - 1) * rowSize);
+            (*count)--;
+            markRecordDirty(table, key);
+            logChange(table, CHANGE_ARCHIVE, key);
+        }
+        free(old);
+        rebuildKeyFilter(table);
+        rebuildRequisiteGraph(table);
+        syncCourseSeats(table);
+        saveRecordTable(table);
+    }
+    return 1;
+}
+
+// --- CHANGE LOG (BINARY AUDIT TRAIL OF ADMIN EDITS) ---
+// Every add, update, delete and archive of a record, location or notice is
+// appended as a fixed-size binary ChangeRecord: who, when, which table, which
+// key. logChange() only copies the event into a buffer owned by the calling
+// thread, so recording costs a clock read and two short copies. The buffer
+// is written out when it fills, at the next menu prompt, and at shutdown.
+//
+// Events go to numbered segments: changes_NNNN.log takes appends until it
+// holds CHANGE_SEGMENT_EVENTS events. It is then sealed into changes_NNNN.seg
+// with the archive's encoding:
+//   - times as varint deltas;
+//   - actors as indexes into a per-segment dictionary;
+//   - the table and action packed into one byte.
+// A sealed segment's header holds its time range, a bit per table and its
+// actor dictionary, so queries skip segments that cannot match without
+// decoding them. Writers and readers of several instances are serialised by
+// a lock on changes.lock.
+
+#define CHANGE_SEGMENT_EVENTS 4096
+#define CHANGE_BUFFER_EVENTS 256
+#define CHANGE_SEGMENT_MAGIC "UGLOG01"
+#define MAX_CHANGE_SEGMENTS 9999
+
+typedef struct ChangeSegmentHeader {
+    char magic[8];
+    int64_t firstAt, minAt, maxAt;   // Deltas start from firstAt
+    uint32_t eventCount;
+    uint32_t tableMask;              // Bit per TableID present
+    uint32_t dataOffset, dataLength;
+    uint32_t dictionaryOffset, dictionaryCount;
+} ChangeSegmentHeader;
+
+typedef struct ChangeBuffer {
+    ChangeRecord events[CHANGE_BUFFER_EVENTS];
+    int count;
+} ChangeBuffer;
+
+static const char *changeActionNames[] = { "add", "update", "delete", "archive" };
+static const char *changeLogStem = "changes"; // Swapped by the benchmark
+static _Thread_local ChangeBuffer changeBuffer;
+static atomic_int activeChangeSegment = 1; // Lowest segment that may still be open
+
+static void changeSegmentPath(int number, const char *extension, char *out, size_t size) {
+    snprintf(out, size, "%s/%s_%04d.%s", dataDirectory, changeLogStem, number, extension);
+}
+
+static int fileExists(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0;
+}
+
+// Copies a string into a MAX_ID_LENGTH field, cutting it short if need be and
+// zeroing the unused bytes so the log never holds stale memory
+static void copyChangeField(char *field, const char *text) {
+    size_t length = strlen(text);
+    if (length > MAX_ID_LENGTH - 1) length = MAX_ID_LENGTH - 1;
+    memcpy(field, text, length);
+    memset(field + length, 0, MAX_ID_LENGTH - length);
+}
+
+void logChange(TableID table, ChangeAction action, const char *key) {
+    ChangeRecord *event = &changeBuffer.events[changeBuffer.count];
+    event->at = (int64_t)time(NULL);
+    event->table = (uint8_t)table;
+    event->action = (uint8_t)action;
+    copyChangeField(event->actor, loggedInUserID[0] ? loggedInUserID : "(system)");
+    copyChangeField(event->key, key);
+    if (shipDirectory[0] != '\0') shipMutation(table, action, key);
+    if (++changeBuffer.count == CHANGE_BUFFER_EVENTS) flushChangeLog();
+}
+
+// Signed deltas as varints: small steps either way take one byte
+static uint32_t zigzag(int64_t value) {
+    return (uint32_t)((value << 1) ^ (value >> 63));
+}
+
+static int64_t unzigzag(uint32_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+// Rewrites a full .log segment as a compressed .seg (called under the lock)
+static int sealChangeSegment(int number) {
+    char logPath[MAX_LINE_LENGTH], segPath[MAX_LINE_LENGTH], tempPath[MAX_LINE_LENGTH + 8];
+    changeSegmentPath(number, "log", logPath, sizeof(logPath));
+    changeSegmentPath(number, "seg", segPath, sizeof(segPath));
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", segPath);
+
+    FILE *fp = fopen(logPath, "rb");
+    if (fp == NULL) return 0;
+    ChangeRecord *events = (ChangeRecord *)malloc(sizeof(ChangeRecord) * CHANGE_SEGMENT_EVENTS * 2);
+    size_t count = events ? fread(events, sizeof(ChangeRecord), CHANGE_SEGMENT_EVENTS * 2, fp) : 0;
+    fclose(fp);
+    if (count == 0) {
+        free(events);
+        return 0;
+    }
+
+    ChangeSegmentHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHANGE_SEGMENT_MAGIC, sizeof(header.magic));
+    header.firstAt = header.minAt = header.maxAt = events[0].at;
+    header.eventCount = (uint32_t)count;
+
+    TextBuffer data = {0}, tail = {0};
+    StringDictionary actors = {0};
+    int64_t previous = events[0].at;
+    for (size_t i = 0; i < count; i++) {
+        const ChangeRecord *event = &events[i];
+        putVarint(&data, zigzag(event->at - previous));
+        unsigned char packed = (unsigned char)((event->table << 4) | (event->action & 0x0F));
+        tbAppendBytes(&data, &packed, 1);
+        putVarint(&data, (uint32_t)dictionaryIntern(&actors, event->actor));
+        putString(&data, event->key);
+        previous = event->at;
+        if (event->at < header.minAt) header.minAt = event->at;
+        if (event->at > header.maxAt) header.maxAt = event->at;
+        header.tableMask |= 1u << event->table;
+    }
+    for (int i = 0; i < actors.count; i++) putString(&tail, actors.entries[i]);
+    header.dataOffset = sizeof(header);
+    header.dataLength = (uint32_t)data.length;
+    header.dictionaryOffset = header.dataOffset + header.dataLength;
+    header.dictionaryCount = (uint32_t)actors.count;
+
+    int ok = 0;
+    fp = fopen(tempPath, "wb");
+    if (fp) {
+        ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+             (data.length == 0 || fwrite(data.data, data.length, 1, fp) == 1) &&
+             (tail.length == 0 || fwrite(tail.data, tail.length, 1, fp) == 1);
+        ok = (fclose(fp) == 0) && ok;
+        ok = ok && rename(tempPath, segPath) == 0;
+        if (ok) remove(logPath);
+        else remove(tempPath);
+    }
+    free(events);
+    free(data.data);
+    free(tail.data);
+    dictionaryFree(&actors);
+    return ok;
+}
+
+// Opens and exclusively locks (or share-locks) changes.lock
+static FILE* lockChangeLog(int exclusive) {
+    char path[MAX_LINE_LENGTH];
+    snprintf(path, sizeof(path), "%s/%s.lock", dataDirectory, changeLogStem);
+    FILE *fp = fopen(path, "a");
+    if (fp && !lockFile(fp, exclusive)) {
+        fclose(fp);
+        return NULL;
+    }
+    return fp;
+}
+
+// Writes out the calling thread's buffered events
+void flushChangeLog() {
+    if (changeBuffer.count == 0) return;
+    FILE *lock = lockChangeLog(1);
+    char path[MAX_LINE_LENGTH];
+    int number = atomic_load(&activeChangeSegment);
+    for (; lock && number <= MAX_CHANGE_SEGMENTS; number++) {
+        changeSegmentPath(number, "seg", path, sizeof(path));
+        if (!fileExists(path)) break;
+        changeSegmentPath(number, "log", path, sizeof(path));
+        remove(path); // Left behind if sealing was interrupted
+    }
+    changeSegmentPath(number, "log", path, sizeof(path));
+    FILE *fp = (lock && number <= MAX_CHANGE_SEGMENTS) ? fopen(path, "ab") : NULL;
+    if (fp == NULL) {
+        printf("Warning: Could not write the change log; %d change(s) were not recorded.\n", changeBuffer.count);
+    } else {
+        fwrite(changeBuffer.events, sizeof(ChangeRecord), (size_t)changeBuffer.count, fp);
+        fseek(fp, 0, SEEK_END);
+        long events = ftell(fp) / (long)sizeof(ChangeRecord);
+        fclose(fp);
+        if (events >= CHANGE_SEGMENT_EVENTS && sealChangeSegment(number)) number++;
+        atomic_store(&activeChangeSegment, number);
+    }
+    changeBuffer.count = 0;
+    if (lock) closeTable(lock);
+}
+
+static int changeMatches(const ChangeFilter *filter, const ChangeRecord *event) {
+    return (filter->table < 0 || event->table == filter->table) &&
+           (filter->from == 0 || event->at >= filter->from) &&
+           (filter->to == 0 || event->at <= filter->to) &&
+           (filter->actor[0] == '\0' || strcmp(event->actor, filter->actor) == 0) &&
+           (filter->key[0] == '\0' || strcmp(event->key, filter->key) == 0);
+}
+
+static int keepChange(ChangeRecord **matches, int *count, int *capacity, const ChangeRecord *event) {
+    if (*count == *capacity) {
+        int grown = *capacity ? *capacity * 2 : 64;
+        ChangeRecord *bigger = (ChangeRecord *)realloc(*matches, sizeof(ChangeRecord) * grown);
+        if (bigger == NULL) return 0;
+        *matches = bigger;
+        *capacity = grown;
+    }
+    (*matches)[(*count)++] = *event;
+    return 1;
+}
+
+// Decodes the matching events of one sealed segment, unless its header
+// shows there can be none. Returns the number of segments skipped (0 or 1).
+static int scanSealedChanges(const char *path, const ChangeFilter *filter, ChangeRecord **matches, int *count, int *capacity) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) return 0;
+    ChangeSegmentHeader header;
+    unsigned char *body = NULL;
+    char **actors = NULL;
+    int skipped = 1;
+    if (fread(&header, sizeof(header), 1, fp) != 1 || memcmp(header.magic, CHANGE_SEGMENT_MAGIC, 8) != 0 ||
+        (filter->table >= 0 && !(header.tableMask & (1u << filter->table))) ||
+        (filter->from && header.maxAt < filter->from) || (filter->to && header.minAt > filter->to)) {
+        fclose(fp);
+        return skipped;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    body = (unsigned char *)malloc((size_t)size);
+    actors = (char **)calloc(header.dictionaryCount + 1, sizeof(char *));
+    fseek(fp, 0, SEEK_SET);
+    if (body == NULL || actors == NULL || fread(body, (size_t)size, 1, fp) != 1 ||
+        (long)header.dictionaryOffset > size || header.dataOffset + header.dataLength > header.dictionaryOffset) {
+        fclose(fp);
+        free(body);
+        free(actors);
+        return 0;
+    }
+    fclose(fp);
+
+    const unsigned char *cursor = body + header.dictionaryOffset, *end = body + size;
+    int actorWanted = filter->actor[0] == '\0';
+    for (uint32_t i = 0; i < header.dictionaryCount; i++) {
+        char actor[MAX_ID_LENGTH];
+        if (!getString(&cursor, end, actor, sizeof(actor))) break;
+        actors[i] = strdup(actor);
+        if (!actorWanted && strcmp(actor, filter->actor) == 0) actorWanted = 1;
+    }
+    if (actorWanted) {
+        skipped = 0;
+        cursor = body + header.dataOffset;
+        end = body + header.dataOffset + header.dataLength;
+        ChangeRecord event;
+        int64_t at = header.firstAt;
+        for (uint32_t i = 0; i < header.eventCount; i++) {
+            uint32_t delta, actor;
+            if (!getVarint(&cursor, end, &delta) || cursor >= end) break;
+            unsigned char packed = *cursor++;
+            if (!getVarint(&cursor, end, &actor) || actor >= header.dictionaryCount || actors[actor] == NULL ||
+                !getString(&cursor, end, event.key, sizeof(event.key))) break;
+            at += unzigzag(delta);
+            event.at = at;
+            event.table = (uint8_t)(packed >> 4);
+            event.action = (uint8_t)(packed & 0x0F);
+            snprintf(event.actor, MAX_ID_LENGTH, "%s", actors[actor]);
+            if (changeMatches(filter, &event) && !keepChange(matches, count, capacity, &event)) break;
+        }
+    }
+    for (uint32_t i = 0; i < header.dictionaryCount; i++) free(actors[i]);
+    free(actors);
+    free(body);
+    return skipped;
+}
+
+// Every logged change that passes 'filter', oldest first (the caller frees
+// the array). 'skipped' (if not NULL) gets the number of sealed segments
+// ruled out by their headers. Flushes the caller's own buffer first.
+ChangeRecord* queryChanges(const ChangeFilter *filter, int *count, int *skipped) {
+    ChangeRecord *matches = NULL;
+    int capacity = 0, ruledOut = 0;
+    *count = 0;
+    flushChangeLog();
+    FILE *lock = lockChangeLog(0);
+    char path[MAX_LINE_LENGTH];
+    for (int number = 1; number <= MAX_CHANGE_SEGMENTS; number++) {
+        changeSegmentPath(number, "seg", path, sizeof(path));
+        if (fileExists(path)) {
+            ruledOut += scanSealedChanges(path, filter, &matches, count, &capacity);
+            continue;
+        }
+        changeSegmentPath(number, "log", path, sizeof(path));
+        FILE *fp = fopen(path, "rb");
+        if (fp == NULL) break; // Past the active segment
+        ChangeRecord event;
+        while (fread(&event, sizeof(event), 1, fp) == 1) {
+            event.actor[MAX_ID_LENGTH - 1] = event.key[MAX_ID_LENGTH - 1] = '\0';
+            if (changeMatches(filter, &event) && !keepChange(&matches, count, &capacity, &event)) break;
+        }
+        fclose(fp);
+    }
+    if (lock) closeTable(lock);
+    if (skipped) *skipped = ruledOut;
+    return matches;
+}
+
+const char* changeActionName(int action) {
+    return (action >= 0 && action < CHANGE_ACTION_COUNT) ? changeActionNames[action] : "?";
+}
+
+// Logs synthetic events into a scratch set of segments and times it, then
+// checks filtered queries against counts known from the generator
+int benchmarkChangeLog(int events) {
+    const char *savedStem = changeLogStem;
+    char savedUser[MAX_ID_LENGTH];
+    snprintf(savedUser, sizeof(savedUser), "%s", loggedInUserID);
+    changeLogStem = "bench_changes";
+    atomic_store(&activeChangeSegment, 1);
+
+    const int actors = 5;
+    const int64_t start = (int64_t)time(NULL);
+    int byActor = 0, byTableKey = 0;
+    double began = monotonicMillis();
+    for (int i = 0; i < events; i++) {
+        snprintf(loggedInUserID, MAX_ID_LENGTH, "admin%d", i % actors);
+        char key[MAX_ID_LENGTH];
+        TableID table = (TableID)(i % 3);
+        snprintf(key, sizeof(key), "K%d", (i / 3) % 500);
+        logChange(table, (ChangeAction)(i % 3), key);
+        if (i % actors == 2) byActor++;
+        if (table == TABLE_COURSES && strcmp(key, "K42") == 0) byTableKey++;
+    }
+    flushChangeLog();
+    double elapsed = monotonicMillis() - began;
+
+    // Raw size against what is on disk
+    long long disk = 0;
+    int segments = 0;
+    char path[MAX_LINE_LENGTH];
+    struct stat st;
+    for (int n = 1; n <= MAX_CHANGE_SEGMENTS; n++) {
+        changeSegmentPath(n, "seg", path, sizeof(path));
+        if (stat(path, &st) != 0) {
+            changeSegmentPath(n, "log", path, sizeof(path));
+            if (stat(path, &st) != 0) break;
+        }
+        disk += st.st_size;
+        segments++;
+    }
+
+    ChangeFilter filter = { "admin2", -1, "", 0, 0 };
+    int found, skipped, failures = 0;
+    began = monotonicMillis();
+    free(queryChanges(&filter, &found, &skipped));
+    double actorTime = monotonicMillis() - began;
+    if (found != byActor) failures++;
+
+    ChangeFilter byKey = { "", TABLE_COURSES, "K42", 0, 0 };
+    free(queryChanges(&byKey, &found, NULL));
+    if (found != byTableKey) failures++;
+
+    ChangeFilter nobody = { "nobody", -1, "", 0, 0 };
+    int none;
+    free(queryChanges(&nobody, &found, &none));
+    if (found != 0 || none < segments - 1) failures++; // Only the open .log has to be read
+
+    ChangeFilter future = { "", -1, "", start + 86400, 0 };
+    free(queryChanges(&future, &found, NULL));
+    if (found != 0) failures++;
+
+    printf("%d events logged in %.1f ms (%.0f ns each, writes and sealing included).\n",
+           events, elapsed, elapsed * 1e6 / events);
+    printf("%d segments, %lld bytes on disk for %lld bytes of events (%.1fx smaller).\n", segments, disk,
+           (long long)events * (long long)sizeof(ChangeRecord), disk ? (double)events * sizeof(ChangeRecord) / disk : 0.0);
+    printf("Query by actor: %d events in %.1f ms; %d sealed segments ruled out by their headers.\n", byActor, actorTime, skipped);
+    printf("%s\n", failures ? "FAILED: a query disagreed with the generated events." : "All queries returned the expected events.");
+
+    for (int n = 1; n <= MAX_CHANGE_SEGMENTS; n++) {
+        changeSegmentPath(n, "seg", path, sizeof(path));
+        int sealed = remove(path) == 0;
+        changeSegmentPath(n, "log", path, sizeof(path));
+        if (remove(path) != 0 && !sealed) break;
+    }
+    snprintf(path, sizeof(path), "%s/%s.lock", dataDirectory, changeLogStem);
+    remove(path);
+    changeLogStem = savedStem;
+    atomic_store(&activeChangeSegment, 1);
+    snprintf(loggedInUserID, MAX_ID_LENGTH, "%s", savedUser);
+    return failures == 0;
+}
+
+// --- REPLICATION (MUTATION LOG SHIPPING) ---
+// A primary started with '--ship DIR' appends every record-level mutation of
+// students, courses, faculty, programs, locations and notices to DIR/ship.log,
+// one text line each:
+//     seq;unix time;table;U|D;payload
+// An upsert (U) carries the record's whole line in its table file's format; a
+// delete (D) carries only the key. Archiving ships the new semester segment
+// itself: the file is copied to DIR/segments/ and an A entry naming it comes
+// ahead of the deletes that moved its records out of the live table, so a
+// replica's archiveLookup finds them too. Segments archived before shipping
+// began travel in DIR/base/ with the tables. Mutations are captured where logChange()
+// sees them and written out with the change log: at the next menu prompt and
+// at shutdown. Sequence numbers are assigned under the log's lock, so they
+// stay dense and ordered even if several primaries share the log. The first
+// primary to use DIR also leaves a copy of its tables in DIR/base/, and the
+// log's first line names that base.
+//
+// A replica ('--replica DIR', run in the replica's own data directory) seeds
+// itself from the base once, then polls the log and applies only the entries
+// past the sequence number saved in replica.state. Each touched table is read,
+// patched and written back through writeTableFile, so kiosks running on the
+// replica's directory hot-reload the change. Upserts and deletes are
+// idempotent (a segment already installed is recognised by its bytes), so a
+// batch cut short is simply applied again. replica.state also keeps the byte
+// offset in the log reached with that sequence number, so a poll reads only
+// what was appended since, however long the log has grown.
+
+#define SHIP_LOG_NAME "ship.log"
+#define SHIP_BASE_HEADER "#ship base="
+#define SHIP_SEGMENT_DIRECTORY "segments"
+#define SHIP_PAYLOAD_LENGTH 1024
+#define SHIP_POLL_MILLIS 1000
+
+static TextBuffer shipPending;             // Lines still waiting for a sequence number
+static long shipScannedSize = 0;           // How much of ship.log this process has read
+static long long shipLastSeq = 0;
+
+typedef struct ShipEntry {
+    long long seq;
+    long long at;
+    TableID table;
+    char op;                               // 'U' upsert, 'D' delete or 'A' archive segment
+    char payload[SHIP_PAYLOAD_LENGTH];
+} ShipEntry;
+
+// Where a replica keeps its stream position, and how far behind it is
+typedef struct ReplicaStatus {
+    long long baseId;           // Names the stream (and its base copy) being followed
+    long long appliedSeq;
+    long long appliedOffset;               // Bytes of the log read through appliedSeq
+    long long lastSeq;                     // Newest entry in the primary's log
+    long long appliedAt;                   // When the newest applied entry was shipped
+    int applied;                           // Entries applied by this poll
+} ReplicaStatus;
+
+static void shipPath(const char *directory, const char *name, char *out, size_t size) {
+    snprintf(out, size, "%s/%s", directory, name);
+}
+
+static int shipTableByName(const char *name) {
+    for (int t = 0; t < TABLE_COUNT; t++) {
+        if (strcmp(tableNames[t], name) == 0) return t;
+    }
+    return -1;
+}
+
+static int copyFile(const char *from, const char *to) {
+    FILE *in = openTableForRead(from);
+    if (in == NULL) return 0;
+    FILE *out = fopen(to, "wb");
+    if (out == NULL) {
+        closeTable(in);
+        return 0;
+    }
+    char chunk[4096];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), in)) > 0) fwrite(chunk, 1, read, out);
+    fclose(out);
+    closeTable(in);
+    return 1;
+}
+
+// Makes this process a primary. The first primary on 'directory' seeds the
+// base copy and starts the log; later ones append to the existing stream.
+int startShipping(const char *directory) {
+    char logPath[MAX_LINE_LENGTH * 2], basePath[MAX_LINE_LENGTH * 2], copyPath[MAX_LINE_LENGTH * 3];
+    if (strlen(directory) >= sizeof(shipDirectory) || !makeDirectory(directory)) {
+        printf("Error: Could not use %s for shipping.\n", directory);
+        return 0;
+    }
+    strcpy(shipDirectory, directory);
+    shipPath(directory, SHIP_LOG_NAME, logPath, sizeof(logPath));
+    if (fileExists(logPath)) return 1;
+
+    shipPath(directory, "base", basePath, sizeof(basePath));
+    if (!makeDirectory(basePath)) {
+        printf("Error: Could not create %s.\n", basePath);
+        return 0;
+    }
+    for (int t = 0; t < TABLE_COUNT; t++) {
+        snprintf(copyPath, sizeof(copyPath), "%s/%s", basePath, tableFileNames[t]);
+        if (fileExists(tableFiles[t]) && !copyFile(tableFiles[t], copyPath)) {
+            printf("Error: Could not copy %s to %s.\n", tableFiles[t], copyPath);
+            return 0;
+        }
+    }
+    TableID archived[2] = { TABLE_STUDENTS, TABLE_COURSES };
+    for (int t = 0; t < 2; t++) {
+        for (int number = 1; number <= lastArchiveSegment(archived[t]); number++) {
+            char name[64], segment[MAX_LINE_LENGTH];
+            segmentFileName(archived[t], number, name, sizeof(name));
+            segmentPath(archived[t], number, segment, sizeof(segment));
+            snprintf(copyPath, sizeof(copyPath), "%s/%s", basePath, name);
+            if (!copySegmentFile(segment, copyPath)) {
+                printf("Error: Could not copy %s to %s.\n", segment, copyPath);
+                return 0;
+            }
+        }
+    }
+    // The log is created last, so a replica never sees a log without its base
+    FILE *fp = fopen(logPath, "wb");
+    if (fp == NULL) {
+        printf("Error: Could not create %s.\n", logPath);
+        return 0;
+    }
+    // Milliseconds, so a log restarted within the same second still gets a new id
+    fprintf(fp, SHIP_BASE_HEADER "%lld\n", (long long)time(NULL) * 1000 + (long long)monotonicMillis() % 1000);
+    fclose(fp);
+    return 1;
+}
+
+// The record as it stands now, in its table file's format; 0 if it is gone
+static int formatShippedRow(TableID table, const char *key, TextBuffer *tb) {
+    const RecordSchema *schema = recordSchema(table);
+    if (schema) {
+        int index = findRowByKey(schema->rows, schema->rowSize, *schema->count, key);
+        if (index < 0) return 0;
+        schema->serialize((const char *)schema->rows + schema->rowSize * index, 1, tb);
+        if (tb->length > 0 && tb->data[tb->length - 1] == '\n') tb->data[--tb->length] = '\0';
+        return 1;
+    }
+    if (table == TABLE_LOCATIONS) {
+        LocationNode *node = findLocationIn(&hashTable, key);
+        if (node == NULL) return 0;
+        formatLocationLine(tb, node);
+        return 1;
+    }
+    int index = findNoticeIndex(atoi(key));
+    if (index < 0) return 0;
+    char line[MAX_LINE_LENGTH + 96];
+    formatNoticeLine(&notices[index], line, sizeof(line));
+    line[strcspn(line, "\n")] = '\0';
+    tbAppendf(tb, "%s", line);
+    return 1;
+}
+
+// Called by logChange() on a primary
+void shipMutation(TableID table, ChangeAction action, const char *key) {
+    TextBuffer payload = {0};
+    char op = 'D';
+    if (action == CHANGE_ADD || action == CHANGE_UPDATE) {
+        if (!formatShippedRow(table, key, &payload)) {
+            free(payload.data);
+            return;
+        }
+        op = 'U';
+    } else {
+        tbAppendf(&payload, "%s", key);
+    }
+    tbAppendf(&shipPending, "%lld;%s;%c;%s\n", (long long)time(NULL), tableNames[table], op, payload.data);
+    free(payload.data);
+}
+
+// Called when archiving on a primary: publishes the new segment and queues the
+// A entry that tells replicas to install it
+void shipArchiveSegment(TableID table, int number) {
+    char directory[MAX_LINE_LENGTH * 2], name[96], source[MAX_LINE_LENGTH], target[MAX_LINE_LENGTH * 3];
+    shipPath(shipDirectory, SHIP_SEGMENT_DIRECTORY, directory, sizeof(directory));
+    // Unique across primaries sharing the log, unlike the local segment number
+    snprintf(name, sizeof(name), "%s-%lld-%03d.seg", recordSchema(table)->rowsName,
+             (long long)time(NULL) * 1000 + (long long)monotonicMillis() % 1000, number);
+    segmentPath(table, number, source, sizeof(source));
+    snprintf(target, sizeof(target), "%s/%s", directory, name);
+    if (!makeDirectory(directory) || !copySegmentFile(source, target)) {
+        printf("Warning: Could not ship %s; replicas will not find these archived records.\n", source);
+        return;
+    }
+    tbAppendf(&shipPending, "%lld;%s;A;%s\n", (long long)time(NULL), tableNames[table], name);
+}
+
+// Reads entries appended since the last scan; only their sequence numbers matter here
+static void scanShipLog(FILE *fp) {
+    char line[SHIP_PAYLOAD_LENGTH + 64];
+    fseek(fp, shipScannedSize, SEEK_SET);
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (line[0] != '#') shipLastSeq = atoll(line);
+    }
+    shipScannedSize = ftell(fp);
+}
+
+void flushShipLog() {
+    char path[MAX_LINE_LENGTH * 2];
+    if (shipDirectory[0] == '\0' || shipPending.length == 0) return;
+    shipPath(shipDirectory, SHIP_LOG_NAME, path, sizeof(path));
+    FILE *fp = fopen(path, "r+b");
+    if (fp == NULL || !lockFile(fp, 1)) {
+        if (fp) fclose(fp);
+        printf("Error: Could not open %s; changes will be shipped later.\n", path);
+        return;
+    }
+    scanShipLog(fp); // Picks up entries other primaries appended
+    fseek(fp, 0, SEEK_END);
+    for (char *line = shipPending.data; *line; ) {
+        char *end = strchr(line, '\n');
+        fprintf(fp, "%lld;%.*s\n", ++shipLastSeq, (int)(end - line), line);
+        line = end + 1;
+    }
+    fflush(fp);
+    syncFileToDisk(fp);
+    shipScannedSize = ftell(fp);
+    unlockFile(fp);
+    fclose(fp);
+    shipPending.length = 0;
+    shipPending.data[0] = '\0';
+}
+
+// --- Replica side ---
+
+static void replicaStatePath(char *out, size_t size) {
+    snprintf(out, size, "%s/replica.state", dataDirectory);
+}
+
+static void loadReplicaState(ReplicaStatus *status) {
+    char path[MAX_LINE_LENGTH];
+    memset(status, 0, sizeof(*status));
+    replicaStatePath(path, sizeof(path));
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) return;
+    // Older state files have no offset; the log is then read from the top once
+    if (fscanf(fp, "%lld %lld %lld %lld", &status->baseId, &status->appliedSeq, &status->appliedAt,
+               &status->appliedOffset) < 3) {
+        memset(status, 0, sizeof(*status));
+    }
+    status->lastSeq = status->appliedSeq;
+    fclose(fp);
+}
+
+static int saveReplicaState(const ReplicaStatus *status) {
+    char path[MAX_LINE_LENGTH];
+    replicaStatePath(path, sizeof(path));
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) return 0;
+    fprintf(fp, "%lld %lld %lld %lld\n", status->baseId, status->appliedSeq, status->appliedAt, status->appliedOffset);
+    syncFileToDisk(fp);
+    fclose(fp);
+    return 1;
+}
+
+// Replaces 'table' with the body of 'path' (its version header dropped)
+static int replaceTableWith(TableID table, const char *path) {
+    FILE *fp = openTableForRead(path);
+    if (fp == NULL) return 1; // The primary had no such file
+    TextBuffer body = {0};
+    char line[SHIP_PAYLOAD_LENGTH];
+    int version = 0;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (strncmp(line, VERSION_HEADER_PREFIX, strlen(VERSION_HEADER_PREFIX)) == 0) continue;
+        tbAppendf(&body, "%s", line);
+    }
+    closeTable(fp);
+
+    int result = -1;
+    for (int attempt = 0; attempt < MAX_SAVE_ATTEMPTS && result != 1; attempt++) {
+        version = readTableFileVersion(table);
+        result = writeTableFile(table, body.data ? body.data : "", version < 0 ? 0 : version);
+        if (result < 0) break;
+    }
+    free(body.data);
+    return result == 1;
+}
+
+static int seedReplica(const char *directory) {
+    char path[MAX_LINE_LENGTH * 3];
+    for (int t = 0; t < TABLE_COUNT; t++) {
+        snprintf(path, sizeof(path), "%s/base/%s", directory, tableFileNames[t]);
+        if (!replaceTableWith((TableID)t, path)) {
+            printf("Error: Could not seed %s from %s.\n", tableFiles[t], path);
+            return 0;
+        }
+    }
+    TableID archived[2] = { TABLE_STUDENTS, TABLE_COURSES };
+    for (int t = 0; t < 2; t++) {
+        for (int number = 1; number <= MAX_ARCHIVE_SEGMENTS; number++) {
+            char name[64];
+            segmentFileName(archived[t], number, name, sizeof(name));
+            snprintf(path, sizeof(path), "%s/base/%s", directory, name);
+            if (!fileExists(path)) break;
+            if (!installArchiveSegment(archived[t], path)) {
+                printf("Error: Could not install the archive segment %s.\n", path);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// Applies one table's entries to a private copy of its file and writes it back.
+// Returns 1 when written, 0 when another writer got in first (try again), -1 on error.
+static int applyRecordEntries(const RecordSchema *schema, const ShipEntry *entries, int count) {
+    TableID table = schema->table;
+    char *rows = (char *)malloc(schema->rowSize * MAX_RECORDS);
+    if (rows == NULL) return -1;
+    int version = 0;
+    int rowCount = schema->parseFile(tableFiles[table], rows, MAX_RECORDS, &version);
+    if (rowCount < 0) rowCount = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (entries[i].table != table) continue;
+        if (entries[i].op == 'U') {
+            AnyRecord row;
+            char line[SHIP_PAYLOAD_LENGTH];
+            memset(&row, 0, sizeof(row));
+            strcpy(line, entries[i].payload);
+            if (!schema->parseLine(line, &row)) continue;
+            int index = findRowByKey(rows, schema->rowSize, rowCount, (const char *)&row);
+            if (index < 0 && rowCount == MAX_RECORDS) {
+                printf("Warning: %s is full; #%lld was not applied.\n", tableFiles[table], entries[i].seq);
+                continue;
+            }
+            if (index < 0) index = rowCount++;
+            memcpy(rows + schema->rowSize * index, &row, schema->rowSize);
+        } else if (entries[i].op == 'D') {
+            int index = findRowByKey(rows, schema->rowSize, rowCount, entries[i].payload);
+            if (index < 0) continue;
+            memmove(rows + schema->rowSize * index, rows + schema->rowSize * (index + 1),
+                    schema->rowSize * (rowCount - index - 1));
+            rowCount--;
+        }
+    }
+
+    TextBuffer body = {0};
+    schema->serialize(rows, rowCount, &body);
+    int result = writeTableFile(table, body.data ? body.data : "", version);
+    free(body.data);
+    free(rows);
+    return result;
+}
+
+static int applyLocationEntries(const ShipEntry *entries, int count) {
+    LocationTable *table = (LocationTable *)malloc(sizeof(LocationTable));
+    if (table == NULL) return -1;
+    int version = 0;
+    initLocationTable(table);
+    if (parseLocationFile(tableFiles[TABLE_LOCATIONS], table, &version) < 0) version = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (entries[i].table != TABLE_LOCATIONS) continue;
+        char line[SHIP_PAYLOAD_LENGTH];
+        strcpy(line, entries[i].payload);
+        line[strcspn(line, ";")] = '\0'; // The key
+        normalizeString(line);
+        removeLocationFrom(table, line);
+        if (entries[i].op == 'U') {
+            strcpy(line, entries[i].payload);
+            parseLocationLine(line, table);
+        }
+    }
+
+    TextBuffer body = {0};
+    serializeLocationTable(table, &body);
+    int result = writeTableFile(TABLE_LOCATIONS, body.data, version);
+    free(body.data);
+    destroyLocationTable(table);
+    free(table);
+    return result;
+}
+
+// notices.dat is append-only: add the notices it lacks, retract those it still has
+static int applyNoticeEntries(const ShipEntry *entries, int count) {
+    Notice *list = (Notice *)malloc(sizeof(Notice) * MAX_NOTICES);
+    if (list == NULL) return -1;
+    int nextID = 1, version = 0;
+    int listCount = parseNoticeFile(tableFiles[TABLE_NOTICES], list, MAX_NOTICES, &nextID, &version);
+    if (listCount < 0) listCount = 0;
+
+    int result = 1;
+    for (int i = 0; i < count && result == 1; i++) {
+        if (entries[i].table != TABLE_NOTICES) continue;
+        char line[SHIP_PAYLOAD_LENGTH + 2];
+        int id = atoi(entries[i].op == 'U' ? entries[i].payload + 2 : entries[i].payload);
+        int index = -1;
+        for (int n = 0; n < listCount; n++) {
+            if (list[n].id == id) { index = n; break; }
+        }
+        if (entries[i].op == 'U' && index < 0) {
+            snprintf(line, sizeof(line), "%s\n", entries[i].payload);
+            result = appendTableLine(TABLE_NOTICES, line, version);
+            if (result == 1 && listCount < MAX_NOTICES) list[listCount++].id = id;
+        } else if (entries[i].op == 'D' && index >= 0) {
+            snprintf(line, sizeof(line), "R;%d\n", id);
+            result = appendTableLine(TABLE_NOTICES, line, version);
+            if (result == 1) list[index] = list[--listCount];
+        } else {
+            continue;
+        }
+        version++;
+    }
+    free(list);
+    return result;
+}
+
+static int applyTableEntries(TableID table, const ShipEntry *entries, int count) {
+    for (int attempt = 0; attempt < MAX_SAVE_ATTEMPTS; attempt++) {
+        const RecordSchema *schema = recordSchema(table);
+        int result = schema ? applyRecordEntries(schema, entries, count)
+                   : (table == TABLE_LOCATIONS) ? applyLocationEntries(entries, count)
+                   : applyNoticeEntries(entries, count);
+        if (result != 0) return result == 1;
+    }
+    return 0;
+}
+
+// One poll: reads the entries past status->appliedSeq and applies them.
+// Returns 0 if the log cannot be read or a table cannot be written.
+static int replicateOnce(const char *directory, ReplicaStatus *status) {
+    char path[MAX_LINE_LENGTH * 2], line[SHIP_PAYLOAD_LENGTH + 64];
+    shipPath(directory, SHIP_LOG_NAME, path, sizeof(path));
+    FILE *fp = openTableForRead(path);
+    if (fp == NULL) {
+        printf("Error: No shipped log at %s.\n", path);
+        return 0;
+    }
+    long long baseId = 0;
+    if (fgets(line, sizeof(line), fp) != NULL && strncmp(line, SHIP_BASE_HEADER, strlen(SHIP_BASE_HEADER)) == 0) {
+        baseId = atoll(line + strlen(SHIP_BASE_HEADER));
+    }
+    if (baseId == 0) {
+        closeTable(fp);
+        printf("Error: %s has no base header.\n", path);
+        return 0;
+    }
+    if (baseId != status->baseId) {
+        // A new stream (or a first start): begin again from its base copy
+        if (status->baseId != 0) printf("The primary's log was restarted; reseeding from its base.\n");
+        if (!seedReplica(directory)) {
+            closeTable(fp);
+            return 0;
+        }
+        status->baseId = baseId;
+        status->appliedSeq = 0;
+        status->appliedAt = 0;
+        status->appliedOffset = 0;
+        saveReplicaState(status);
+    }
+
+    // Entries up to appliedOffset are done; sequence numbers still guard a shorter log
+    int64_t readTo = ftell64(fp);
+    fseek64(fp, 0, SEEK_END);
+    if (status->appliedOffset > readTo && status->appliedOffset <= ftell64(fp)) readTo = status->appliedOffset;
+    fseek64(fp, readTo, SEEK_SET);
+
+    ShipEntry *entries = NULL;
+    int count = 0, capacity = 0;
+    status->applied = 0;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        int64_t lineStart = readTo;
+        readTo = ftell64(fp);
+        if (line[0] == '#') continue;
+        line[strcspn(line, "\r\n")] = '\0';
+        char *cursor = line;
+        char *seq = nextToken(&cursor, ';');
+        char *at = nextToken(&cursor, ';');
+        char *table = nextToken(&cursor, ';');
+        char *op = nextToken(&cursor, ';');
+        if (seq == NULL || at == NULL || table == NULL || op == NULL || cursor == NULL) continue;
+        long long number = atoll(seq);
+        if (number > status->lastSeq) status->lastSeq = number;
+        int tableID = shipTableByName(table);
+        if (number <= status->appliedSeq || tableID < 0 || (op[0] != 'U' && op[0] != 'D' && op[0] != 'A')) continue;
+        if (op[0] == 'A' && ((tableID != TABLE_STUDENTS && tableID != TABLE_COURSES) || strpbrk(cursor, "/\\") != NULL)) continue;
+        if (count == capacity) {
+            int newCapacity = capacity ? capacity * 2 : 64;
+            ShipEntry *grown = (ShipEntry *)realloc(entries, sizeof(ShipEntry) * (size_t)newCapacity);
+            if (grown == NULL) {
+                readTo = lineStart; // Read again next poll
+                break;
+            }
+            entries = grown;
+            capacity = newCapacity;
+        }
+        ShipEntry *entry = &entries[count++];
+        entry->seq = number;
+        entry->at = atoll(at);
+        entry->table = (TableID)tableID;
+        entry->op = op[0];
+        snprintf(entry->payload, sizeof(entry->payload), "%s", cursor);
+    }
+    closeTable(fp);
+
+    // Segments go in first, so archived records are never missing from both places
+    int ok = 1;
+    for (int i = 0; i < count && ok; i++) {
+        if (entries[i].op != 'A') continue;
+        snprintf(path, sizeof(path), "%s/%s/%s", directory, SHIP_SEGMENT_DIRECTORY, entries[i].payload);
+        if (!installArchiveSegment(entries[i].table, path)) {
+            printf("Error: Could not install the shipped archive segment %s.\n", path);
+            ok = 0;
+        }
+    }
+
+    // Tables are independent, so each is patched once with all of its entries, in log order
+    for (int t = 0; t < TABLE_COUNT && ok; t++) {
+        int touched = 0;
+        for (int i = 0; i < count && !touched; i++) touched = (entries[i].table == (TableID)t && entries[i].op != 'A');
+        if (touched && !applyTableEntries((TableID)t, entries, count)) {
+            printf("Error: Could not apply shipped changes to %s.\n", tableFiles[t]);
+            ok = 0;
+        }
+    }
+    if (ok && (count > 0 || readTo != status->appliedOffset)) {
+        status->applied = count;
+        if (count > 0) {
+            status->appliedSeq = entries[count - 1].seq;
+            status->appliedAt = entries[count - 1].at;
+        }
+        status->appliedOffset = readTo;
+        saveReplicaState(status);
+    }
+    free(entries);
+    return ok;
+}
+
+// Follows the primary's log from this instance's data directory. 'seconds'
+// < 0 follows until the process is stopped; 0 catches up once and returns.
+int runReplica(const char *directory, int seconds) {
+    ReplicaStatus status;
+    loadReplicaState(&status);
+    double start = monotonicMillis();
+    long long reportedSeq = -1, reportedLast = -1;
+    int ok;
+    do {
+        ok = replicateOnce(directory, &status);
+        if (!ok) break;
+        if (status.appliedSeq != reportedSeq || status.lastSeq != reportedLast) {
+            long long now = (long long)time(NULL);
+            long long delay = status.appliedAt ? now - status.appliedAt : 0;
+            printf("Replica at #%lld of #%lld (%lld behind); applied %d, newest shipped %llds ago.\n",
+                   status.appliedSeq, status.lastSeq, status.lastSeq - status.appliedSeq, status.applied,
+                   delay < 0 ? 0 : delay);
+            fflush(stdout);
+            reportedSeq = status.appliedSeq;
+            reportedLast = status.lastSeq;
+        }
+        if (seconds == 0) break;
+        sleepMillis(SHIP_POLL_MILLIS);
+    } while (seconds < 0 || monotonicMillis() - start < seconds * 1000.0);
+    return ok;
+}
+
+// --- LOCATION FUNCTIONALITIES MENU ---
+
+void locationFunctionalitiesMenu() {
+    clearScreen();
+    ensureTableLoaded(TABLE_LOCATIONS);
+    int choice;
+    do {
+        clearScreen();
+        printf("======================================================\n");
+        printf("              Campus Location Guidebook\n");
+        printf("======================================================\n");
+        printf("This module allows you to find locations by Task Key.\n");
+        printf("Example Keys: 'library', 'c_lab', 'admin_office', etc.\n\n");
+        
+        printf("[1] Search for a Location (By Task Key)\n");
+        printf("[2] View All Available Locations\n");
+        printf("[3] Add a New Location (Admin/Staff only)\n");
+        printf("[4] Delete a Location (Admin/Staff only)\n");
+        printf("[5] Node Allocator Statistics (Admin/Staff only)\n");
+        printf("[6] Find Nearest Locations\n");
+        printf("[7] Occupancy (How Busy / Check In)\n");
+        printf("[8] Return to Main Menu\n");
+        printf("------------------------------------------------------\n");
+
+        choice = getMenuChoice(8);
+
+        switch (choice) {
+            case 1: searchLocation(); break;
+            case 2: viewAllLocations(); break;
+            case 3: addLocationMenu(); break;
+            case 4: deleteLocationMenu(); break;
+            case 5: viewAllocatorStats(); break;
+            case 6: nearestLocationsMenu(); break;
+            case 7: occupancyMenu(); break;
+            case 8: printf("Returning to Main Menu...\n"); break;
+        }
+        if (choice != 8 && choice != 7) pressEnterToContinue();
+
+    } while (choice != 8);
+}
+
+void searchLocation() {
+    clearScreen();
+    printf("======================================================\n");
+    printf("                  Search Location\n");
+    printf("======================================================\n");
+    printf("Instruction: Enter the unique 'Task Key' (e.g., 'library', 'c_lab') to find its location.\n\n");
+    
+    char *key = getInput("Enter Task Key to search: ");
+    
+    int slot = epochEnter();
+    const TableSnapshot *snapshot = currentSnapshot(TABLE_LOCATIONS);
+    int index = hashFunction(key);
+    LocationNode *current = (snapshot && keyMayExist(TABLE_LOCATIONS, key)) ? snapshot->locations->buckets[index] : NULL;
+    int found = 0;
+
+    printf("\n--- Search Results ---\n");
+    while (current) {
+        if (strcmp(current->key, key) == 0) {
+            printf("Key: %s\n", current->key);
+            printf("Building: %s\n", current->building);
+            printf("Floor: %s\n", current->floor);
+            printf("Room/Facility: %s\n", current->room);
+            printf("Description: %s\n", current->description);
+            if (current->hasPosition) {
+                printf("Position: (%g, %g) m, level %d\n", current->position.x, current->position.y, current->position.level);
+            }
+            found = 1;
+            break;
+        }
+        current = current->next;
+    }
+    epochExit(slot);
+
+    if (!found) {
+        printf("Location for key '%s' not found in the directory.\n", key);
+    }
+}
+
+void viewAllLocations() {
+    clearScreen();
+    printf("======================================================\n");
+    printf("              All Available Locations\n");
+    printf("======================================================\n");
+    printf("This shows all locations currently loaded into the system:\n\n");
+    
+    int total = 0;
+    TableView table;
+    tvInit(&table, 6, "Task Key", "Building", "Floor", "Room", "Description", "Position (x,y,level)");
+
+    int slot = epochEnter();
+    const TableSnapshot *snapshot = currentSnapshot(TABLE_LOCATIONS);
+    for (int i = 0; snapshot && i < HASH_SIZE; i++) {
+        LocationNode *current = snapshot->locations->buckets[i];
+        while (current) {
+            char position[64];
+            formatPosition(current, position, sizeof(position));
+            tvAddRow(&table, current->key, current->building, current->floor, current->room, current->description, position);
+            current = current->next;
+            total++;
+        }
+    }
+    epochExit(slot); // The table holds copies of the cells
+    
+    tvRender(&table, stdout);
+    printf("\nTotal locations found: %d\n", total);
+}
+
+void addLocationMenu() {
+    if (currentUserRole != ROLE_ADMIN) {
+        printf("\nAuthorization Required: Only Administrators can add new locations.\n");
+        return;
+    }
+    
+    clearScreen();
+    printf("======================================================\n");
+    printf("                  Add New Location\n");
+    printf("======================================================\n");
     printf("Instruction: Enter details for the new location.\n");
     printf("The Task Key must be unique for fast lookups.\n\n");
     
@@ -532,7 +8722,8 @@ void addLocationMenu() {
         }
         
         int index = hashFunction(key);
-        LocationNode *current = hashTable[index];
+        // A key the filter has never seen is free without walking the chain
+        LocationNode *current = keyMayExist(TABLE_LOCATIONS, key) ? hashTable.buckets[index] : NULL;
         int exists = 0;
         
         while (current) {
@@ -551,14 +8742,30 @@ void addLocationMenu() {
         }
     } while(1);
     
-    char *building = getInput("Enter Building Name: ");
-    char *floor = getInput("Enter Floor (e.g., '1st', 'Ground'): ");
-    char *room = getInput("Enter Room/Facility Code: ");
-    char *description = getInput("Enter Short Description: ");
+    // getInput reuses one static buffer, so copy each answer out before the next prompt
+    char building[MAX_NAME_LENGTH], floor[MAX_NAME_LENGTH], room[MAX_NAME_LENGTH], description[MAX_NAME_LENGTH];
+    strcpy(building, getInput("Enter Building Name: "));
+    strcpy(floor, getInput("Enter Floor (e.g., '1st', 'Ground'): "));
+    strcpy(room, getInput("Enter Room/Facility Code: "));
+    strcpy(description, getInput("Enter Short Description: "));
+
+    LocationPosition position;
+    int positioned = 0;
+    while (1) {
+        char *coordinates = getInput("Enter Coordinates in metres 'x,y' or 'x,y,level' (blank if unknown): ");
+        if (coordinates[0] == '\0') break;
+        if (parsePosition(coordinates, floor, &position)) {
+            positioned = 1;
+            break;
+        }
+        printf("   Invalid coordinates. Example: 120.5,48 or 120.5,48,2\n");
+    }
     
-    // Save to file and reload hash table
-    saveLocationToFile(key_buffer, building, floor, room, description);
-    printf("\nSuccess! Location '%s' has been added to the guide.\n", key_buffer);
+    // Append to file and add to the hash table
+    if (saveLocationToFile(key_buffer, building, floor, room, description, positioned ? &position : NULL)) {
+        logChange(TABLE_LOCATIONS, CHANGE_ADD, key_buffer);
+        printf("\nSuccess! Location '%s' has been added to the guide.\n", key_buffer);
+    }
 }
 
 void deleteLocationMenu() {
@@ -576,7 +8783,7 @@ void deleteLocationMenu() {
     char *keyToDelete = getInput("Enter Task Key to delete: ");
     
     int index = hashFunction(keyToDelete);
-    LocationNode *current = hashTable[index];
+    LocationNode *current = hashTable.buckets[index];
     LocationNode *prev = NULL;
     int found = 0;
 
@@ -585,12 +8792,14 @@ void deleteLocationMenu() {
         if (strcmp(current->key, keyToDelete) == 0) {
             if (prev == NULL) {
                 // Deleting the head node
-                hashTable[index] = current->next;
+                hashTable.buckets[index] = current->next;
             } else {
                 // Deleting a non-head node
                 prev->next = current->next;
             }
-            free(current);
+            statsRowChanged(TABLE_LOCATIONS, current, -1);
+            gridRemove(&hashTable.grid, current);
+            slabFree(&hashTable.nodes, current);
             found = 1;
             break;
         }
@@ -600,13 +8809,255 @@ void deleteLocationMenu() {
 
     if (found) {
         // Rewrite the file with the remaining locations
+        rebuildKeyFilter(TABLE_LOCATIONS);
+        markRecordDirty(TABLE_LOCATIONS, keyToDelete);
         rewriteLocationFile();
+        logChange(TABLE_LOCATIONS, CHANGE_DELETE, keyToDelete);
         printf("\nSuccess! Location '%s' has been deleted from the guide.\n", keyToDelete);
     } else {
         printf("\nError: Location with key '%s' not found.\n", keyToDelete);
     }
 }
 
+void viewAllocatorStats() {
+    if (currentUserRole != ROLE_ADMIN) {
+        printf("\nAuthorization Required: Only Administrators can view allocator statistics.\n");
+        return;
+    }
+
+    clearScreen();
+    printf("======================================================\n");
+    printf("              Node Allocator Statistics\n");
+    printf("======================================================\n");
+    printf("Location nodes are carved from slabs; a reload releases them all at once.\n\n");
+    printSlabStats(&hashTable.nodes);
+}
+
+// Counts the positioned locations in the current snapshot
+static int positionedLocationCount() {
+    int slot = epochEnter();
+    const TableSnapshot *snapshot = currentSnapshot(TABLE_LOCATIONS);
+    int points = snapshot ? snapshot->locations->grid.points : 0;
+    epochExit(slot);
+    return points;
+}
+
+// Runs the search against one snapshot and copies the hits into 'table'.
+// Returns the hit count, or -1 if 'origin' is neither a positioned Task Key nor 'x,y'.
+static int findNearestIn(LocationTable *locations, const char *origin, const char *filter,
+                         int limit, double radius, TableView *table) {
+    LocationPosition from;
+    LocationNode *start = findLocationIn(locations, origin);
+    if (start && start->hasPosition) {
+        from = start->position;
+    } else if (!parsePosition(origin, "Ground", &from)) {
+        return -1;
+    }
+
+    NearestHit hits[MAX_NEAREST];
+    int count = gridNearest(&locations->grid, &from, filter, limit, radius, hits);
+    for (int i = 0; i < count; i++) {
+        char distance[32];
+        snprintf(distance, sizeof(distance), "%.1f", hits[i].distance);
+        tvAddRow(table, hits[i].node->key, hits[i].node->building, hits[i].node->floor, hits[i].node->room, distance);
+    }
+    return count;
+}
+
+// Every prompt is answered before the snapshot is taken, so no epoch slot is
+// held while waiting for input (or across the end of a replayed session)
+void nearestLocationsMenu() {
+    clearScreen();
+    printf("======================================================\n");
+    printf("               Find Nearest Locations\n");
+    printf("======================================================\n");
+    printf("Instruction: Say where you are with a Task Key (e.g., 'library') or\n");
+    printf("coordinates 'x,y' / 'x,y,level'. Distances count %.0f m per floor.\n\n", LEVEL_HEIGHT_METERS);
+
+    if (positionedLocationCount() == 0) {
+        printf("No locations have coordinates yet. Add them with 'x,y' when creating a location.\n");
+        return;
+    }
+
+    char origin[MAX_NAME_LENGTH];
+    strcpy(origin, getInput("You are at: "));
+
+    char filter[MAX_NAME_LENGTH];
+    strcpy(filter, getInput("Looking for (e.g., 'lab', 'washroom'; blank for anything): "));
+
+    printf("\n[1] The k nearest\n[2] Everything within a radius\n");
+    int mode = getMenuChoice(2);
+    int limit = MAX_NEAREST;
+    double radius = 0;
+    if (mode == 1) {
+        if (!readIntInput("How many results (1-20)? ", &limit) || limit < 1 || limit > MAX_NEAREST) limit = 5;
+    } else {
+        int metres;
+        if (!readIntInput("Radius in metres: ", &metres) || metres <= 0) {
+            printf("Invalid radius.\n");
+            return;
+        }
+        radius = metres;
+    }
+
+    TableView table;
+    tvInit(&table, 5, "Task Key", "Building", "Floor", "Room", "Distance (m)");
+    tvAlignRight(&table, 4);
+    int slot = epochEnter();
+    const TableSnapshot *snapshot = currentSnapshot(TABLE_LOCATIONS);
+    int count = snapshot ? findNearestIn(snapshot->locations, origin, filter, limit, radius, &table) : 0;
+    epochExit(slot); // The table holds copies of the cells
+
+    if (count < 0) {
+        printf("\nError: '%s' is neither a positioned Task Key nor 'x,y' coordinates.\n", origin);
+    } else if (count == 0) {
+        printf("\nNo matching locations found.\n");
+    } else {
+        printf("\n");
+        tvRender(&table, stdout);
+        if (radius > 0 && count == MAX_NEAREST) printf("(Showing the closest %d.)\n", MAX_NEAREST);
+    }
+}
+
+// Reads a Task Key and checks that the location exists
+static int readOccupancyKey(char *key) {
+    snprintf(key, MAX_NAME_LENGTH, "%s", getInput("Enter Task Key (e.g., 'library'): "));
+    int slot = epochEnter();
+    const TableSnapshot *snapshot = currentSnapshot(TABLE_LOCATIONS);
+    int found = snapshot && keyMayExist(TABLE_LOCATIONS, key) && findLocationIn(snapshot->locations, key);
+    epochExit(slot);
+    if (!found) printf("\nLocation for key '%s' not found in the directory.\n", key);
+    return found;
+}
+
+static void formatClock(time_t at, char *out, size_t size) {
+    struct tm *local = localtime(&at);
+    strftime(out, size, "%H:%M", local);
+}
+
+static void printOccupancy(const char *key) {
+    time_t now = time(NULL);
+    OccupancySummary summary;
+    if (!occupancySummary(key, now, &summary)) {
+        printf("\nNo check-ins or headcounts recorded for '%s' yet.\n", key);
+        return;
+    }
+    char clock[16];
+    formatClock(summary.peakAt, clock, sizeof(clock));
+    printf("\n--- Occupancy of %s ---\n", key);
+    printf("Right now:          %d\n", summary.current);
+    printf("Last hour average:  %.1f\n", summary.hourAverage);
+    printf("Peak (24 hours):    %d (around %s)\n", summary.peak, clock);
+    printf("Check-ins (1 hour): %d\n", summary.checkInsLastHour);
+
+    int levels[OCCUPANCY_HOUR_BUCKETS], most = 1;
+    int count = occupancyRecent(key, now, levels, OCCUPANCY_HOUR_BUCKETS);
+    for (int i = 0; i < count; i++) if (levels[i] > most) most = levels[i];
+    printf("\nLast hour (5-minute steps):\n");
+    for (int i = 0; i < count; i++) {
+        char bar[41];
+        int width = levels[i] * 40 / most;
+        memset(bar, '#', (size_t)width);
+        bar[width] = '\0';
+        formatClock(now - (time_t)(count - 1 - i) * OCCUPANCY_BUCKET_SECONDS, clock, sizeof(clock));
+        printf("  %s %-40s %d\n", clock, bar, levels[i]);
+    }
+}
+
+typedef struct BusyLocation {
+    const char *key;
+    OccupancySummary summary;
+} BusyLocation;
+
+static int compareBusiest(const void *a, const void *b) {
+    const BusyLocation *x = (const BusyLocation *)a, *y = (const BusyLocation *)b;
+    if (x->summary.current != y->summary.current) return y->summary.current - x->summary.current;
+    return strcmp(x->key, y->key);
+}
+
+static void listBusiestLocations() {
+    const char *keys[MAX_OCCUPANCY_SERIES];
+    BusyLocation busy[MAX_OCCUPANCY_SERIES];
+    time_t now = time(NULL);
+    int count = occupancyKeys(keys, MAX_OCCUPANCY_SERIES);
+    for (int i = 0; i < count; i++) {
+        busy[i].key = keys[i];
+        occupancySummary(keys[i], now, &busy[i].summary);
+    }
+    if (count == 0) {
+        printf("\nNo check-ins or headcounts have been recorded yet.\n");
+        return;
+    }
+    qsort(busy, (size_t)count, sizeof(BusyLocation), compareBusiest);
+
+    TableView table;
+    tvInit(&table, 5, "Task Key", "Now", "Hour Avg", "Peak (24 h)", "Check-ins (1 h)");
+    for (int i = 0; i < count; i++) {
+        char current[16], average[16], peak[16], checkIns[16];
+        snprintf(current, sizeof(current), "%d", busy[i].summary.current);
+        snprintf(average, sizeof(average), "%.1f", busy[i].summary.hourAverage);
+        snprintf(peak, sizeof(peak), "%d", busy[i].summary.peak);
+        snprintf(checkIns, sizeof(checkIns), "%d", busy[i].summary.checkInsLastHour);
+        tvAddRow(&table, busy[i].key, current, average, peak, checkIns);
+    }
+    printf("\n");
+    tvRender(&table, stdout);
+}
+
+// How busy each location is, from check-ins, check-outs and headcounts
+void occupancyMenu() {
+    int choice;
+    do {
+        clearScreen();
+        printf("======================================================\n");
+        printf("                 Location Occupancy\n");
+        printf("======================================================\n");
+        printf("Instruction: Check in and out of locations, or see how busy they are.\n\n");
+
+        printf("[1] How Busy Is a Location?\n");
+        printf("[2] Check In\n");
+        printf("[3] Check Out\n");
+        printf("[4] Record a Headcount (Admin/Staff only)\n");
+        printf("[5] Busiest Locations Now\n");
+        printf("[6] Return to Location Menu\n");
+        printf("------------------------------------------------------\n");
+
+        choice = getMenuChoice(6);
+        char key[MAX_NAME_LENGTH];
+        int count = 0, level;
+
+        switch (choice) {
+            case 1:
+                if (readOccupancyKey(key)) printOccupancy(key);
+                break;
+            case 2:
+            case 3:
+                if (!readOccupancyKey(key)) break;
+                level = recordOccupancy(key, choice == 2 ? OCCUPANCY_CHECK_IN : OCCUPANCY_CHECK_OUT, 0, time(NULL));
+                if (level < 0) printf("\nError: No more locations can be tracked.\n");
+                else printf("\nChecked %s %s. Occupancy is now %d.\n", choice == 2 ? "in to" : "out of", key, level);
+                break;
+            case 4:
+                if (currentUserRole != ROLE_ADMIN) {
+                    printf("\nAuthorization Required: Only Administrators can record headcounts.\n");
+                    break;
+                }
+                if (!readOccupancyKey(key)) break;
+                if (!readIntInput("People counted: ", &count) || count < 0) {
+                    printf("Invalid headcount.\n");
+                    break;
+                }
+                if (recordOccupancy(key, OCCUPANCY_HEADCOUNT, count, time(NULL)) < 0) printf("\nError: No more locations can be tracked.\n");
+                else printf("\nOccupancy of %s set to %d.\n", key, count);
+                break;
+            case 5: listBusiestLocations(); break;
+            case 6: printf("Returning to Location Menu...\n"); break;
+        }
+        if (choice != 6) pressEnterToContinue();
+
+    } while (choice != 6);
+}
+
 // --- AUTHENTICATION ---
 
 void loginMenu() {
@@ -626,24 +9077,26 @@ void loginMenu() {
         char *inputUser = getInput("Username/ID: ");
         if (strcmp(inputUser, "exit") == 0) {
             printf("\nExiting application. Goodbye!\n");
-            exit(0);
+            endInputSession();
         }
         strncpy(username, inputUser, MAX_ID_LENGTH);
 
         char *inputPass = getInput("Password: ");
         strncpy(password, inputPass, MAX_ID_LENGTH);
 
-        FILE *fp = fopen("db/users.dat", "r");
+        // Unknown names (typos, probing) are turned away by the filter without reading users.dat
+        int knownName = loginMayExist(username);
+        FILE *fp = knownName ? fopen(usersFile, "r") : NULL;
         int authenticated = 0;
 
-        if (fp == NULL) {
+        if (knownName && fp == NULL) {
             printf("\nError: 'users.dat' file not found. Cannot proceed with login.\n");
             pressEnterToContinue();
             continue;
         }
 
         char line[MAX_LINE_LENGTH];
-        while (fgets(line, MAX_LINE_LENGTH, fp) != NULL) {
+        while (fp && fgets(line, MAX_LINE_LENGTH, fp) != NULL) {
             char temp_user[MAX_ID_LENGTH];
             char temp_pass[MAX_ID_LENGTH];
             char temp_role[MAX_ID_LENGTH];
@@ -668,10 +9121,11 @@ void loginMenu() {
                 }
             }
         }
-        fclose(fp);
+        if (fp) fclose(fp);
 
         if (authenticated && role != ROLE_UNKNOWN) {
             currentUserRole = role;
+            startBackgroundPrefetch();
             printf("\n--- Login Successful! ---\n");
             printf("Welcome, %s (%s).\n", username, roleStr);
             pressEnterToContinue();
@@ -695,7 +9149,9 @@ void mainMenu() {
         printf("======================================================\n");
         printf("       University Help Guidebook - Main Menu\n");
         printf("======================================================\n");
-        printf("Logged In as: %s | Role: %s\n\n", loggedInUserID, (currentUserRole == ROLE_ADMIN ? "Administrator" : "Student"));
+        printf("Logged In as: %s | Role: %s", loggedInUserID, (currentUserRole == ROLE_ADMIN ? "Administrator" : "Student"));
+        if (campusName[0] != '\0') printf(" | Campus: %s", campusName);
+        printf("\n\n");
         
         // Modules available to both
         printf("[1] Campus Location Functionalities (Hash Table/Linked List)\n");
@@ -735,7 +9191,7 @@ void mainMenu() {
                 break; // Exit do-while loop to return to loginMenu
             case 5:
                 printf("\nExiting application. Goodbye!\n");
-                exit(0);
+                endInputSession();
         }
         
         // If the choice wasn't Log Out or Exit, pause
@@ -757,21 +9213,35 @@ void adminMenu() {
         printf("[2] Manage Course Information\n");
         printf("[3] Manage Faculty Information\n");
         printf("[4] Edit Academic Calendar/Notices\n");
-        printf("[5] Return to Main Menu\n");
+        printf("[5] Record Index Tools (B+tree)\n");
+        printf("[6] Semester Archive\n");
+        printf("[7] Query Records (Filter Language)\n");
+        printf("[8] Statistics Dashboard\n");
+        printf("[9] Degree Audit\n");
+        printf("[10] Change Log (Who Changed What)\n");
+        printf("[11] Class Rankings (Honours Lists)\n");
+        printf("[12] Return to Main Menu\n");
         printf("------------------------------------------------------\n");
         
-        choice = getMenuChoice(5);
+        choice = getMenuChoice(12);
 
         switch (choice) {
-            case 1: studentCRUDMenu(); break;
-            case 2: courseCRUDMenu(); break;
-            case 3: facultyCRUDMenu(); break;
+            case 1: recordCRUDMenu(TABLE_STUDENTS); break;
+            case 2: recordCRUDMenu(TABLE_COURSES); break;
+            case 3: recordCRUDMenu(TABLE_FACULTY); break;
             case 4: editNotices(); break;
-            case 5: printf("Returning to Main Menu...\n"); break;
+            case 5: recordIndexMenu(); break;
+            case 6: archiveMenu(); break;
+            case 7: queryRecordsTool(); break;
+            case 8: statisticsDashboard(); break;
+            case 9: degreeAuditMenu(); break;
+            case 10: changeLogTool(); break;
+            case 11: classRankingsTool(); break;
+            case 12: printf("Returning to Main Menu...\n"); break;
         }
-        if (choice != 5) pressEnterToContinue();
+        if (choice != 12) pressEnterToContinue();
 
-    } while (choice != 5);
+    } while (choice != 12);
 }
 
 void studentMenu() {
@@ -787,25 +9257,50 @@ void studentMenu() {
         printf("[2] View Course Catalog\n");
         printf("[3] View Academic Calendar/Notices\n");
         printf("[4] Simple GPA Calculator\n");
-        printf("[5] Return to Main Menu\n");
+        printf("[5] Course Eligibility Planner\n");
+        printf("[6] My Degree Audit\n");
+        printf("[7] Course Registration\n");
+        printf("[8] Return to Main Menu\n");
         printf("------------------------------------------------------\n");
         
-        choice = getMenuChoice(5);
+        choice = getMenuChoice(8);
 
         switch (choice) {
             case 1: viewPersonalProfile(); break;
             case 2: viewCourseCatalog(); break;
             case 3: viewNotices(); break;
             case 4: gpaCalculator(); break;
-            case 5: printf("Returning to Main Menu...\n"); break;
+            case 5: courseEligibilityPlanner(); break;
+            case 6: viewDegreeAudit(); break;
+            case 7: courseRegistration(); break;
+            case 8: printf("Returning to Main Menu...\n"); break;
         }
-        if (choice != 5) pressEnterToContinue();
+        if (choice != 8) pressEnterToContinue();
 
-    } while (choice != 5);
+    } while (choice != 8);
 }
 
 // --- STUDENT MODULE FEATURES ---
 
+// Until the student table has been loaded, fault in just this one
+// record through the ID index instead of loading every student
+static int findLoggedInStudent(Student *record) {
+    int found = 0;
+    if (isTableLoaded(TABLE_STUDENTS)) {
+        for (int i = 0; i < studentCount; i++) {
+            if (strcmp(students[i].id, loggedInUserID) == 0) {
+                *record = students[i];
+                found = 1;
+                break;
+            }
+        }
+    } else {
+        found = indexLookupRecord(TABLE_STUDENTS, loggedInUserID, record);
+    }
+    if (!found) found = archiveLookup(TABLE_STUDENTS, loggedInUserID, record); // Graduated cohorts
+    return found;
+}
+
 void viewPersonalProfile() {
     clearScreen();
     printf("======================================================\n");
@@ -813,15 +9308,26 @@ void viewPersonalProfile() {
     printf("======================================================\n");
     printf("Instruction: Displaying details for the logged-in student.\n\n");
 
-    int found = 0;
-    for (int i = 0; i < studentCount; i++) {
-        if (strcmp(students[i].id, loggedInUserID) == 0) {
-            printf("Student ID: %s\n", students[i].id);
-            printf("Name:       %s\n", students[i].name);
-            printf("Program:    %s\n", students[i].program);
-            printf("Email:      %s\n", students[i].email);
-            found = 1;
-            break;
+    Student record;
+    int found = findLoggedInStudent(&record);
+
+    if (found) {
+        printf("Student ID: %s\n", record.id);
+        printf("Name:       %s\n", record.name);
+        printf("Program:    %s\n", record.program);
+        printf("Email:      %s\n", record.email);
+        if (record.semester[0]) printf("Admitted:   %s\n", record.semester);
+        if (record.completed[0]) printf("Completed:  %s\n", record.completed);
+        if (hasGpa(record.gpa)) {
+            char gpa[16];
+            ClassRank standing;
+            formatGpa(record.gpa, gpa, sizeof(gpa));
+            printf("GPA:        %s\n", gpa);
+            ensureTableLoaded(TABLE_STUDENTS);
+            if (classRankOf(&record, &standing)) {
+                printf("Class Rank: %d of %d in %s (ahead of %.0f%% of the program)\n",
+                       standing.rank, standing.cohort, record.program, standing.percentile);
+            }
         }
     }
 
@@ -830,75 +9336,254 @@ void viewPersonalProfile() {
     }
 }
 
+static void buildCourseCatalog(TextBuffer *out, int width, int variant) {
+    (void)variant;
+    if (courseCount == 0) {
+        tbAppendf(out, "The Course Catalog is currently empty.\n");
+        return;
+    }
+
+    TableView table;
+    tvInit(&table, 4, "Code", "Course Name", "Credits", "Prerequisites");
+    tvAlignRight(&table, 2);
+    for (int i = 0; i < courseCount; i++) {
+        char credits[16], requires[MAX_LINE_LENGTH];
+        CourseSet prerequisites;
+        snprintf(credits, sizeof(credits), "%d", courses[i].credits);
+        courseListSet(courses[i].prerequisites, &prerequisites);
+        formatCourseSet(&prerequisites, requires, sizeof(requires));
+        tvAddRow(&table, courses[i].code, courses[i].name, credits, requires);
+    }
+    tvRenderText(&table, out, width);
+}
+
+static void buildFacultyDirectory(TextBuffer *out, int width, int variant) {
+    (void)variant;
+    if (facultyCount == 0) {
+        tbAppendf(out, "The Faculty Directory is currently empty.\n");
+        return;
+    }
+
+    TableView table;
+    tvInit(&table, 3, "Faculty ID", "Name", "Department");
+    for (int i = 0; i < facultyCount; i++) {
+        tvAddRow(&table, faculty[i].id, faculty[i].name, faculty[i].department);
+    }
+    tvRenderText(&table, out, width);
+}
+
 void viewCourseCatalog() {
     clearScreen();
+    ensureTableLoaded(TABLE_COURSES);
     printf("======================================================\n");
     printf("                 Course Catalog\n");
     printf("======================================================\n");
     printf("Instruction: Displaying all available courses.\n\n");
-    
+
+    fputs(cachedView(VIEW_COURSE_CATALOG, 0, 0, buildCourseCatalog), stdout);
+}
+
+// Where the student stands on every course, then what finishing the courses
+// taken this semester would open up
+void courseEligibilityPlanner() {
+    clearScreen();
+    ensureTableLoaded(TABLE_COURSES);
+    printf("======================================================\n");
+    printf("              Course Eligibility Planner\n");
+    printf("======================================================\n");
+    printf("Instruction: Checks each course against your completed courses.\n\n");
+
+    Student record;
+    if (!findLoggedInStudent(&record)) {
+        printf("Error: Your student record was not found in the database (ID: %s).\n", loggedInUserID);
+        return;
+    }
     if (courseCount == 0) {
         printf("The Course Catalog is currently empty.\n");
         return;
     }
 
-    printf("+-----------+-----------------------------------+---------+\n");
-    printf("| Code      | Course Name                       | Credits |\n");
-    printf("+-----------+-----------------------------------+---------+\n");
+    CourseSet completed, missing, pending;
+    courseListSet(record.completed, &completed);
+    TableView table;
+    tvInit(&table, 3, "Code", "Course Name", "Status");
     for (int i = 0; i < courseCount; i++) {
-        printf("| %-9s | %-33s | %-7d |\n", 
-               courses[i].code, 
-               courses[i].name, 
-               courses[i].credits);
+        char status[MAX_LINE_LENGTH + 32], codes[MAX_LINE_LENGTH];
+        if (courseSetHas(&completed, i)) {
+            snprintf(status, sizeof(status), "Completed");
+        } else if (!missingRequisites(&completed, i, &missing)) {
+            formatCourseSet(&missing, codes, sizeof(codes));
+            snprintf(status, sizeof(status), "Needs %s", codes);
+        } else if (pendingCorequisites(&completed, i, &pending)) {
+            formatCourseSet(&pending, codes, sizeof(codes));
+            snprintf(status, sizeof(status), "Eligible (take with %s)", codes);
+        } else {
+            snprintf(status, sizeof(status), "Eligible");
+        }
+        tvAddRow(&table, courses[i].code, courses[i].name, status);
+    }
+    tvRender(&table, stdout);
+
+    char *input = getInput("\nCourses you expect to complete this semester (blank to skip): ");
+    if (input[0] == '\0') return;
+    char list[MAX_NAME_LENGTH], problem[MAX_LINE_LENGTH], codes[MAX_LINE_LENGTH];
+    if (!normalizeCourseList(TABLE_STUDENTS, &record, input, list, sizeof(list), problem, sizeof(problem))) {
+        printf("Error: %s\n", problem);
+        return;
+    }
+    CourseSet after, unlocked;
+    courseListSet(list, &after);
+    courseSetUnion(&after, &completed);
+    if (coursesUnlocked(&completed, &after, &unlocked) == 0) {
+        printf("\nCompleting these does not unlock any new course.\n");
+    } else {
+        formatCourseSet(&unlocked, codes, sizeof(codes));
+        printf("\nCompleting these unlocks: %s\n", codes);
+    }
+}
+
+// The audit of one student as shown to the student and to admins.
+// Courses and programs must be loaded.
+void printAuditReport(const Student *student) {
+    AuditResult result;
+    CourseSet missing, electives;
+    char codes[MAX_LINE_LENGTH];
+    auditStudent(student, &result, &missing, &electives);
+
+    printf("Student:   %s (%s)\n", student->id, student->name);
+    printf("Program:   %s\n", student->program);
+    printf("Status:    %s\n", auditStatusNames[result.status]);
+    if (result.status == AUDIT_NO_PROGRAM) {
+        printf("\nNo requirements are defined for the '%s' program yet.\n", student->program);
+        return;
+    }
+    const Program *program = &programs[findRowByKey(programs, sizeof(Program), programCount, student->program)];
+    printf("Credits:   %d earned of %d", result.credits, program->credits);
+    if (result.expectedCredits > 0) printf(" (about %d expected by now)", result.expectedCredits);
+    printf("\n");
+    formatCourseSet(&missing, codes, sizeof(codes));
+    printf("Required:  %s\n", result.missingRequired ? codes : "all completed");
+    if (program->picks > 0) {
+        formatCourseSet(&electives, codes, sizeof(codes));
+        printf("Electives: %d of %d taken%s%s%s\n", program->picks - result.electivesShort, program->picks,
+               codes[0] ? " (" : "", codes, codes[0] ? ")" : "");
+    }
+}
+
+void viewDegreeAudit() {
+    clearScreen();
+    ensureTableLoaded(TABLE_COURSES);
+    ensureTableLoaded(TABLE_PROGRAMS);
+    printf("======================================================\n");
+    printf("                  My Degree Audit\n");
+    printf("======================================================\n");
+    printf("Instruction: Your completed courses against your program's requirements.\n\n");
+
+    Student record;
+    if (!findLoggedInStudent(&record)) {
+        printf("Error: Your student record was not found in the database (ID: %s).\n", loggedInUserID);
+        return;
+    }
+    printAuditReport(&record);
+}
+
+// Seats and waitlist places, taken or given up one course at a time
+void courseRegistration() {
+    loadRegistrations();
+    Student record;
+    if (!findLoggedInStudent(&record)) {
+        clearScreen();
+        printf("Error: Your student record was not found in the database (ID: %s).\n", loggedInUserID);
+        return;
+    }
+    CourseSet completed, missing;
+    courseListSet(record.completed, &completed);
+
+    while (1) {
+        flushRegistrationJournal(beginRegistrationChange()); // Seats other instances took meanwhile
+        clearScreen();
+        printf("======================================================\n");
+        printf("                 Course Registration\n");
+        printf("======================================================\n");
+        printf("Instruction: Full courses put you on their waitlist; a dropped seat goes to the next in line.\n\n");
+        if (courseCount == 0) {
+            printf("The Course Catalog is currently empty.\n");
+            return;
+        }
+
+        TableView table;
+        tvInit(&table, 5, "Code", "Course Name", "Seats", "Waitlist", "You");
+        for (int i = 0; i < courseCount; i++) {
+            int taken, capacity, waiting, position = 0;
+            char seats[32], queue[16], yours[32];
+            seatCounts(courses[i].code, &taken, &capacity, &waiting);
+            if (capacity) snprintf(seats, sizeof(seats), "%d/%d", taken, capacity);
+            else snprintf(seats, sizeof(seats), "%d (open)", taken);
+            snprintf(queue, sizeof(queue), "%d", waiting);
+            int state = registrationState(record.id, courses[i].code, &position);
+            if (state == SEAT_ENROLLED) snprintf(yours, sizeof(yours), "Enrolled");
+            else if (state == SEAT_WAITLISTED) snprintf(yours, sizeof(yours), "Waitlist #%d", position);
+            else yours[0] = '\0';
+            tvAddRow(&table, courses[i].code, courses[i].name, seats, queue, yours);
+        }
+        tvRender(&table, stdout);
+
+        char *input = getInput("\nEnter a course code to register, -CODE to drop (blank to return): ");
+        if (input[0] == '\0') return;
+        int dropping = (input[0] == '-');
+        char code[MAX_ID_LENGTH];
+        snprintf(code, sizeof(code), "%s", input + dropping);
+        int row = findRowByKey(courses, sizeof(Course), courseCount, code);
+        FILE *lock = beginRegistrationChange(); // Decide on the seats as they are now
+        if (row < 0) {
+            printf("Error: Course %s was not found.\n", code);
+        } else if (dropping) {
+            if (dropCourse(record.id, code) == REG_DROPPED) printf("Your place in %s was given up.\n", code);
+            else printf("You are not registered for %s.\n", code);
+        } else if (courseSetHas(&completed, row)) {
+            printf("You have already completed %s.\n", code);
+        } else if (!missingRequisites(&completed, row, &missing)) {
+            char codes[MAX_LINE_LENGTH];
+            formatCourseSet(&missing, codes, sizeof(codes));
+            printf("Error: %s needs %s first.\n", code, codes);
+        } else {
+            int position = 0;
+            switch (registerForCourse(record.id, code)) {
+                case REG_ENROLLED: printf("Registered for %s.\n", code); break;
+                case REG_WAITLISTED:
+                    registrationState(record.id, code, &position);
+                    printf("%s is full; you are number %d on its waitlist.\n", code, position);
+                    break;
+                case REG_ALREADY: printf("You already hold a seat or waitlist place in %s.\n", code); break;
+                default: printf("Error: Registration failed; please try again.\n"); break;
+            }
+        }
+        flushRegistrationJournal(lock);
+        pressEnterToContinue();
     }
-    printf("+-----------+-----------------------------------+---------+\n");
 }
 
 // NOTE: This function is the ONLY thing called by the Main Menu option for Campus Directory (Option 2)
 void viewFacultyDirectory() {
     clearScreen();
+    ensureTableLoaded(TABLE_FACULTY);
     printf("======================================================\n");
     printf("              Campus Faculty Directory\n");
     printf("======================================================\n");
     printf("Instruction: Displaying the complete faculty directory for guidance.\n\n");
-    
-    if (facultyCount == 0) {
-        printf("The Faculty Directory is currently empty.\n");
-        return;
-    }
 
-    printf("+-----------+--------------------------+-----------------------+\n");
-    printf("| Faculty ID| Name                     | Department            |\n");
-    printf("+-----------+--------------------------+-----------------------+\n");
-    for (int i = 0; i < facultyCount; i++) {
-        printf("| %-9s | %-24s | %-21s |\n", 
-               faculty[i].id, 
-               faculty[i].name, 
-               faculty[i].department);
-    }
-    printf("+-----------+--------------------------+-----------------------+\n");
+    fputs(cachedView(VIEW_FACULTY_DIRECTORY, 0, 0, buildFacultyDirectory), stdout);
 }
 
 void viewNotices() {
     clearScreen();
+    ensureTableLoaded(TABLE_NOTICES);
     printf("======================================================\n");
     printf("           Academic Calendar & Notices\n");
     printf("======================================================\n");
     printf("Instruction: Check here for important announcements.\n\n");
 
-    FILE *fp = fopen("db/notices.txt", "r");
-    if (fp == NULL) {
-        printf("Error: 'notices.txt' file not found.\n");
-        return;
-    }
-
-    char line[MAX_LINE_LENGTH];
-    while (fgets(line, MAX_LINE_LENGTH, fp) != NULL) {
-        normalizeString(line); // Clean up the line
-        printf("   %s\n", line);
-    }
-
-    fclose(fp);
+    fputs(renderNoticeBoard(currentUserRole), stdout);
 }
 
 void gpaCalculator() {
@@ -913,37 +9598,34 @@ void gpaCalculator() {
     float totalGradePoints = 0.0;
     int totalCredits = 0;
     
-    printf("How many courses will you enter? ");
-    if (scanf("%d", &numCourses) != 1 || numCourses <= 0) {
+    if (!readIntInput("How many courses will you enter? ", &numCourses) || numCourses <= 0) {
         printf("Invalid number of courses.\n");
-        while (getchar() != '\n');
         return;
     }
-    while (getchar() != '\n'); // Clear buffer
     
     printf("\n--- Start Entering Course Grades ---\n");
     
     for (int i = 0; i < numCourses; i++) {
         char gradeChar;
+        char gradeLine[MAX_LINE_LENGTH];
         int credits;
         int gradeValue = 0;
 
         printf("Course %d:\n", i + 1);
         printf("  Enter Grade (A, B, C, D, F): ");
-        if (scanf(" %c", &gradeChar) != 1) {
+        readInputLine("  Enter Grade (A, B, C, D, F): ", gradeLine, sizeof(gradeLine));
+        const char *grade = gradeLine;
+        while (isspace((unsigned char)*grade)) grade++;
+        if (*grade == '\0') {
             printf("Invalid grade input. Skipping course.\n");
-            while (getchar() != '\n');
             continue;
         }
-        while (getchar() != '\n'); // Clear buffer
+        gradeChar = *grade;
 
-        printf("  Enter Credits (1-5): ");
-        if (scanf("%d", &credits) != 1 || credits <= 0) {
+        if (!readIntInput("  Enter Credits (1-5): ", &credits) || credits <= 0) {
             printf("Invalid credit input. Skipping course.\n");
-            while (getchar() != '\n');
             continue;
         }
-        while (getchar() != '\n'); // Clear buffer
 
         gradeChar = toupper(gradeChar);
 
@@ -979,31 +9661,108 @@ void gpaCalculator() {
 }
 
 
-// --- ADMIN MODULE CRUD UTILITIES (STUDENT) ---
+// --- ADMIN MODULE: RECORD EDITOR (ARRAY TABLES) ---
+// One view/add/update/delete implementation for every array table, driven by
+// its RecordSchema: the key is checked for uniqueness, the other fields are
+// read in .dat order with the prompt their field list gives.
+
+static char* recordAt(const RecordSchema *schema, int index) {
+    return (char *)schema->rows + index * schema->rowSize;
+}
+
+// Reads one field from the user into 'row'. When updating, blank input keeps
+// the current value. Returns 0 if a required value was invalid.
+static int readRecordField(TableID table, const RecordField *field, void *row, int updating) {
+    char *value = (char *)row + field->offset;
+    char prompt[MAX_LINE_LENGTH];
+    switch (field->type) {
+        case FIELD_INT: {
+            int number;
+            if (updating) {
+                snprintf(prompt, MAX_LINE_LENGTH, "Enter New %s (Current: %d, Enter -1 to skip): ", field->header, *(int *)value);
+                if (readIntInput(prompt, &number) && number >= 0) *(int *)value = number;
+                return 1;
+            }
+            if (!readIntInput(field->prompt, &number) || number < 0) {
+                printf("Invalid %s input. Record creation failed.\n", field->name);
+                return 0;
+            }
+            *(int *)value = number;
+            return 1;
+        }
+        case FIELD_GPA: {
+            char current[16];
+            formatGpa(*(int *)value, current, sizeof(current));
+            snprintf(prompt, MAX_LINE_LENGTH, "Enter New %s (Current: %s, '-' to clear): ", field->header, current[0] ? current : "none");
+            while (1) {
+                char *input = getInput(updating ? prompt : field->prompt);
+                if (input[0] == '\0' && updating) return 1;
+                if (input[0] == '\0' || strcmp(input, "-") == 0) {
+                    *(int *)value = GPA_NONE;
+                    return 1;
+                }
+                if (parseGpa(input, (int *)value)) return 1;
+                printf("   Invalid GPA. Enter a number from 0 to 10, e.g. 8.75.\n");
+            }
+        }
+        case FIELD_SEMESTER:
+            snprintf(prompt, MAX_LINE_LENGTH, "Enter New %s (Current: %s): ", field->header, value);
+            readSemesterInput(updating ? prompt : field->prompt, value);
+            return 1;
+        case FIELD_COURSE_LIST: {
+            char list[MAX_NAME_LENGTH], problem[MAX_LINE_LENGTH];
+            snprintf(prompt, MAX_LINE_LENGTH, "Enter New %s (Current: %s, '-' to clear): ", field->header, value[0] ? value : "none");
+            do {
+                char *input = getInput(updating ? prompt : field->prompt);
+                if (updating && input[0] == '\0') return 1;
+                if (strcmp(input, "-") == 0) input[0] = '\0';
+                if (normalizeCourseList(table, row, input, list, sizeof(list), problem, sizeof(problem))) {
+                    snprintf(value, field->size, "%s", list);
+                    return 1;
+                }
+                printf("Error: %s Try again.\n", problem);
+            } while (1);
+        }
+        default: {
+            snprintf(prompt, MAX_LINE_LENGTH, "Enter New %s (Current: %s): ", field->header, value);
+            char *input = getInput(updating ? prompt : field->prompt);
+            if (!updating || input[0] != '\0') snprintf(value, field->size, "%s", input);
+            return 1;
+        }
+    }
+}
+
+void recordCRUDMenu(TableID table) {
+    const RecordSchema *schema = recordSchema(table);
+    const char *name = tableNames[table];
+    char title[MAX_NAME_LENGTH];
+    int i;
+    for (i = 0; name[i] && i < MAX_NAME_LENGTH - 1; i++) title[i] = (char)toupper((unsigned char)name[i]);
+    title[i] = '\0';
 
-void studentCRUDMenu() {
+    ensureTableLoaded(table);
     int choice;
     do {
         clearScreen();
         printf("======================================================\n");
-        printf("           MANAGE STUDENT RECORDS (CRUD)\n");
+        printf("           MANAGE %s RECORDS (CRUD)\n", title);
         printf("======================================================\n");
-        printf("Instruction: Choose an operation for Student Records.\n\n");
-        
-        printf("[1] View All Student Records\n");
-        printf("[2] Add New Student Record\n");
-        printf("[3] Update Existing Student Record\n");
-        printf("[4] Delete Student Record\n");
+        printf("Instruction: Choose an operation for %s Records.\n\n", name);
+
+        printf("[1] View All %s Records\n", name);
+        printf("[2] Add New %s Record\n", name);
+        printf("[3] Update Existing %s Record\n", name);
+        printf("[4] Delete %s Record\n", name);
         printf("[5] Return to Admin Menu\n");
         printf("------------------------------------------------------\n");
-        
+
         choice = getMenuChoice(5);
 
         switch (choice) {
-            case 1: displayStudentRecords(); break;
-            case 2: addStudentRecord(); break;
-            case 3: updateStudentRecord(); break;
-            case 4: deleteStudentRecord(); break;
+            case 1: displayRecords(schema); break;
+            case 2: addRecord(schema); break;
+            case 3: updateRecord(schema); break;
+            case 4: deleteRecord(schema); break;
             case 5: printf("Returning to Admin Menu...\n"); break;
         }
         if (choice != 5) pressEnterToContinue();
@@ -1011,334 +9770,824 @@ void studentCRUDMenu() {
     } while (choice != 5);
 }
 
-void displayStudentRecords() {
+void displayRecords(const RecordSchema *schema) {
     clearScreen();
     printf("======================================================\n");
-    printf("                All Student Records\n");
+    printf("                All %s Records\n", tableNames[schema->table]);
     printf("======================================================\n");
-    
-    if (studentCount == 0) {
-        printf("No student records found.\n");
+
+    if (*schema->count == 0) {
+        printf("No %s records found.\n", tableNames[schema->table]);
+        return;
+    }
+
+    TableView table;
+    const char *headers[MAX_TABLE_COLUMNS];
+    const char *cells[MAX_TABLE_COLUMNS];
+    char numbers[MAX_TABLE_COLUMNS][16];
+    for (int f = 0; f < schema->fieldCount; f++) headers[f] = schema->fields[f].header;
+    tvInitColumns(&table, schema->fieldCount, headers);
+    for (int f = 0; f < schema->fieldCount; f++) {
+        if (schema->fields[f].type == FIELD_INT || schema->fields[f].type == FIELD_GPA) tvAlignRight(&table, f);
+    }
+    for (int i = 0; i < *schema->count; i++) {
+        for (int f = 0; f < schema->fieldCount; f++) {
+            cells[f] = formatRecordCell(&schema->fields[f], recordAt(schema, i), numbers[f], sizeof(numbers[f]));
+        }
+        tvAddRowCells(&table, cells);
+    }
+    tvRender(&table, stdout);
+}
+
+void addRecord(const RecordSchema *schema) {
+    TableID table = schema->table;
+    const RecordField *keyField = &schema->fields[0];
+    clearScreen();
+    printf("======================================================\n");
+    printf("               Add New %s Record\n", tableNames[table]);
+    printf("======================================================\n");
+
+    if (*schema->count >= MAX_RECORDS) {
+        printf("Error: Database capacity reached (%d records).\n", MAX_RECORDS);
+        return;
+    }
+
+    AnyRecord record;
+    memset(&record, 0, sizeof(record));
+    char *key = (char *)&record + keyField->offset;
+
+    // Check for unique key
+    do {
+        char *input = getInput(keyField->prompt);
+        int exists = keyMayExist(table, input) && // The filter settles most new keys without a scan
+                     findRowByKey(schema->rows, schema->rowSize, *schema->count, input) >= 0;
+        if (input[0] == '\0') {
+            printf("Error: %s cannot be empty. Try again.\n", keyField->header);
+        } else if (exists) {
+            printf("Error: %s already exists. Try again.\n", keyField->header);
+        } else {
+            snprintf(key, keyField->size, "%s", input);
+            break;
+        }
+    } while(1);
+
+    for (int f = 1; f < schema->fieldCount; f++) {
+        if (!readRecordField(table, &schema->fields[f], &record, 0)) return;
+    }
+
+    memcpy(recordAt(schema, *schema->count), &record, schema->rowSize);
+    (*schema->count)++;
+    statsRowChanged(table, &record, 1);
+    rebuildRequisiteGraph(table); // Lists loaded with the new code in them now resolve
+    syncCourseSeats(table);
+    keyFilterAdd(table, key);
+    markRecordDirty(table, key);
+    saveRecordTable(table);
+    logChange(table, CHANGE_ADD, key);
+
+    printf("\nSuccess! %s record (%s: %s) added.\n", tableNames[table], keyField->header, key);
+    if (schema->onAdd) schema->onAdd(&record);
+}
+
+void deleteRecord(const RecordSchema *schema) {
+    TableID table = schema->table;
+    const RecordField *keyField = &schema->fields[0];
+    clearScreen();
+    printf("======================================================\n");
+    printf("              Delete %s Record\n", tableNames[table]);
+    printf("======================================================\n");
+
+    char prompt[MAX_LINE_LENGTH];
+    char key[MAX_NAME_LENGTH]; // getInput's buffer is reused by the prompts that follow
+    snprintf(prompt, MAX_LINE_LENGTH, "Enter %s to delete: ", keyField->header);
+    snprintf(key, sizeof(key), "%s", getInput(prompt));
+    int foundIndex = findRowByKey(schema->rows, schema->rowSize, *schema->count, key);
+
+    if (foundIndex != -1) {
+        statsRowChanged(table, recordAt(schema, foundIndex), -1);
+        // Shift remaining records to fill the gap
+        memmove(recordAt(schema, foundIndex), recordAt(schema, foundIndex + 1),
+                (*schema->count - foundIndex - 1) * schema->rowSize);
+        (*schema->count)--;
+        rebuildKeyFilter(table); // Bits cannot be cleared, so compact the filter too
+        rebuildRequisiteGraph(table); // Rows after the gap moved down one bit
+        syncCourseSeats(table);
+        markRecordDirty(table, key);
+        saveRecordTable(table);
+        logChange(table, CHANGE_DELETE, key);
+        printf("\nSuccess! %s record (%s: %s) deleted.\n", tableNames[table], keyField->header, key);
+    } else {
+        printf("\nError: %s '%s' not found.\n", keyField->header, key);
+    }
+}
+
+void updateRecord(const RecordSchema *schema) {
+    TableID table = schema->table;
+    const RecordField *keyField = &schema->fields[0];
+    clearScreen();
+    printf("======================================================\n");
+    printf("              Update %s Record\n", tableNames[table]);
+    printf("======================================================\n");
+
+    char prompt[MAX_LINE_LENGTH];
+    char key[MAX_NAME_LENGTH]; // getInput's buffer is reused by the prompts that follow
+    snprintf(prompt, MAX_LINE_LENGTH, "Enter %s to update: ", keyField->header);
+    snprintf(key, sizeof(key), "%s", getInput(prompt));
+    int foundIndex = findRowByKey(schema->rows, schema->rowSize, *schema->count, key);
+
+    if (foundIndex != -1) {
+        char *row = recordAt(schema, foundIndex);
+        printf("\nUpdating Record for %s: %s (Name: %s)\n", keyField->header, key, row + schema->fields[1].offset);
+        printf("--- Enter new values (or press Enter to keep current value) ---\n");
+
+        // Edit a copy: the live row and its counters change only once every prompt is answered
+        AnyRecord edited;
+        memcpy(&edited, row, schema->rowSize);
+        for (int f = 1; f < schema->fieldCount; f++) readRecordField(table, &schema->fields[f], &edited, 1);
+        statsRowChanged(table, row, -1);
+        memcpy(row, &edited, schema->rowSize);
+        statsRowChanged(table, row, 1);
+        requisiteRowChanged(table, foundIndex);
+        syncCourseSeats(table);
+
+        markRecordDirty(table, key);
+        saveRecordTable(table);
+        logChange(table, CHANGE_UPDATE, key);
+        printf("\nSuccess! %s record (%s: %s) updated.\n", tableNames[table], keyField->header, key);
+    } else {
+        printf("\nError: %s '%s' not found.\n", keyField->header, key);
+    }
+}
+
+// New students log in with their ID as the password. Deleting the student
+// leaves this line in users.dat; the login then finds no student record.
+void createStudentLogin(const void *row) {
+    const Student *student = (const Student *)row;
+    FILE *fp = fopen(usersFile, "a");
+    if (fp == NULL) {
+        printf("Warning: Could not create a login for %s.\n", student->id);
+        return;
+    }
+    fprintf(fp, "%s,%s,student\n", student->id, student->id);
+    fclose(fp);
+    printf("User login created (Password = ID).\n");
+}
+
+// --- ADMIN MODULE: ACADEMIC CALENDAR ---
+
+void postNotice() {
+    if (noticeCount >= MAX_NOTICES) {
+        printf("Error: Calendar capacity reached (%d notices).\n", MAX_NOTICES);
+        return;
+    }
+
+    Notice n;
+    memset(&n, 0, sizeof(n));
+    n.id = nextNoticeID;
+
+    strncpy(n.text, getInput("Enter Notice Text: "), MAX_LINE_LENGTH - 1);
+    if (n.text[0] == '\0') {
+        printf("Notice text cannot be empty.\n");
+        return;
+    }
+    // ';' separates fields in notices.dat, so keep it out of the text
+    for (char *c = n.text; *c; c++) if (*c == ';') *c = ',';
+
+    char *input = getInput("Enter Category (general/exam/holiday/event) [general]: ");
+    snprintf(n.category, sizeof(n.category), "%.*s", MAX_CATEGORY_LENGTH - 1, input[0] ? input : "general");
+    for (char *c = n.category; *c; c++) *c = *c == ';' ? ',' : (char)tolower((unsigned char)*c);
+
+    input = getInput("Enter Audience (all/student/admin) [all]: ");
+    n.audience = audienceFromString(input);
+
+    char today[16];
+    formatDate(todayDate(), today, sizeof(today));
+    char promptBuffer[MAX_LINE_LENGTH];
+    snprintf(promptBuffer, MAX_LINE_LENGTH, "Enter Publish Date YYYY-MM-DD [%s]: ", today);
+    input = getInput(promptBuffer);
+    n.publishDate = input[0] ? parseDate(input) : todayDate();
+    if (n.publishDate == 0) {
+        printf("Invalid publish date. Notice not posted.\n");
+        return;
+    }
+
+    input = getInput("Enter Expiry Date YYYY-MM-DD (exam date for exams): ");
+    n.expiryDate = parseDate(input);
+    if (n.expiryDate == 0 || n.expiryDate < n.publishDate) {
+        printf("Invalid expiry date (must not be before the publish date). Notice not posted.\n");
+        return;
+    }
+
+    if (!appendNoticeToFile(&n)) return;
+    notices[noticeCount++] = n;
+    nextNoticeID = n.id + 1;
+    rebuildNoticeIndexes();
+    char key[16];
+    snprintf(key, sizeof(key), "%d", n.id);
+    logChange(TABLE_NOTICES, CHANGE_ADD, key);
+    printf("\nSuccess! Notice #%d has been posted.\n", n.id);
+}
+
+void retractNotice() {
+    char *input = getInput("Enter Notice ID to retract: ");
+    int id = atoi(input);
+    int index = findNoticeIndex(id);
+    if (index == -1) {
+        printf("\nError: Notice #%s not found.\n", input);
+        return;
+    }
+    if (!appendRetractionToFile(id)) return;
+    index = findNoticeIndex(id); // The calendar may have been reloaded while saving
+    if (index != -1) removeNoticeAt(notices, &noticeCount, index);
+    rebuildNoticeIndexes();
+    char key[16];
+    snprintf(key, sizeof(key), "%d", id);
+    logChange(TABLE_NOTICES, CHANGE_DELETE, key);
+    printf("\nSuccess! Notice #%d has been retracted.\n", id);
+}
+
+// Lists every notice including the expired archive, ordered by publish date
+void viewFullCalendar() {
+    int today = todayDate();
+    TableView table;
+    tvInit(&table, 7, "ID", "Publish", "Expiry", "Audience", "Category", "Text", "Status");
+    tvAlignRight(&table, 0);
+    for (int pos = 0; pos < noticeCount; pos++) {
+        const Notice *n = &notices[noticesByPublish[pos]];
+        char id[16], publish[16], expiry[16];
+        snprintf(id, sizeof(id), "%d", n->id);
+        formatDate(n->publishDate, publish, sizeof(publish));
+        formatDate(n->expiryDate, expiry, sizeof(expiry));
+        tvAddRow(&table, id, publish, expiry, audienceToString(n->audience), n->category, n->text,
+                 n->expiryDate < today ? "archived" : "");
+    }
+    tvRender(&table, stdout);
+    printf("\nTotal notices: %d\n", noticeCount);
+}
+
+void editNotices() {
+    ensureTableLoaded(TABLE_NOTICES);
+    int choice;
+    do {
+        clearScreen();
+        printf("======================================================\n");
+        printf("           Edit Academic Calendar & Notices\n");
+        printf("======================================================\n");
+        printf("Instruction: Post dated notices or retract existing ones.\n");
+        printf("Changes are appended to 'notices.dat'; nothing is overwritten.\n\n");
+
+        printf("[1] Post a New Notice\n");
+        printf("[2] Retract a Notice\n");
+        printf("[3] View Full Calendar (including archive)\n");
+        printf("[4] Return to Admin Menu\n");
+        printf("------------------------------------------------------\n");
+
+        choice = getMenuChoice(4);
+
+        switch (choice) {
+            case 1: postNotice(); break;
+            case 2: retractNotice(); break;
+            case 3: viewFullCalendar(); break;
+            case 4: printf("Returning to Admin Menu...\n"); break;
+        }
+        if (choice != 4) pressEnterToContinue();
+
+    } while (choice != 4);
+}
+
+// --- ADMIN MODULE: RECORD INDEX TOOLS (B+TREE) ---
+
+void recordIndexMenu() {
+    int choice;
+    TableID indexed[RECORD_TABLE_COUNT]; // Tables whose keys fit the index
+    int indexedCount = 0;
+    for (int t = 0; t < RECORD_TABLE_COUNT; t++) {
+        if (recordIndexable(recordSchemas[t].table)) indexed[indexedCount++] = recordSchemas[t].table;
+    }
+    int returnChoice = indexedCount * 3 + 1;
+    do {
+        clearScreen();
+        printf("======================================================\n");
+        printf("            RECORD INDEX TOOLS (B+TREE)\n");
+        printf("======================================================\n");
+        printf("Instruction: Query records straight from disk through the page index.\n");
+        printf("Only the index pages on the search path are read, so this works on\n");
+        printf("archives far larger than the in-memory tables.\n\n");
+
+        // Three tools per indexed table: rebuild, look up, list a range
+        for (int t = 0; t < indexedCount; t++) {
+            const RecordSchema *schema = recordSchema(indexed[t]);
+            const char *name = tableNames[schema->table];
+            const char *key = schema->fields[0].header;
+            printf("[%d] Rebuild %s Index\n", t * 3 + 1, name);
+            printf("[%d] Look Up %s by %s\n", t * 3 + 2, name, key);
+            printf("[%d] List %s Records in a %s Range\n", t * 3 + 3, name, key);
+        }
+        printf("[%d] Return to Admin Menu\n", returnChoice);
+        printf("------------------------------------------------------\n");
+
+        choice = getMenuChoice(returnChoice);
+
+        if (choice == returnChoice) {
+            printf("Returning to Admin Menu...\n");
+            break;
+        }
+        TableID table = indexed[(choice - 1) / 3];
+        switch ((choice - 1) % 3) {
+            case 0: rebuildIndexTool(table); break;
+            case 1: indexLookupTool(table); break;
+            case 2: indexRangeTool(table); break;
+        }
+        pressEnterToContinue();
+
+    } while (1);
+}
+
+static void printIndexStats(BPlusTree *tree, unsigned long readsBefore) {
+    printf("\n[Index: %llu keys, height %u, %u pages | pages read from disk for this query: %lu]\n",
+           (unsigned long long)tree->meta.keyCount, tree->meta.height, tree->meta.pageCount,
+           tree->pageReads - readsBefore);
+}
+
+void rebuildIndexTool(TableID table) {
+    clock_t start = clock();
+    int keys = buildRecordIndex(table);
+    if (keys < 0) {
+        printf("\nError: Could not build the index for %s.\n", tableFiles[table]);
+        return;
+    }
+    BPlusTree *tree = recordIndexes[table];
+    printf("\nSuccess! Indexed %d %s records in %.2f s (height %u, %u pages).\n",
+           keys, tableNames[table], (double)(clock() - start) / CLOCKS_PER_SEC,
+           tree->meta.height, tree->meta.pageCount);
+}
+
+void indexLookupTool(TableID table) {
+    const RecordSchema *schema = recordSchema(table);
+    char prompt[MAX_LINE_LENGTH];
+    char key[MAX_ID_LENGTH];
+    snprintf(prompt, MAX_LINE_LENGTH, "Enter %s: ", schema->fields[0].header);
+    strncpy(key, getInput(prompt), MAX_ID_LENGTH - 1);
+    key[MAX_ID_LENGTH - 1] = '\0';
+
+    BPlusTree *tree = openRecordIndex(table);
+    if (tree == NULL) {
+        printf("\nError: The %s index is not available.\n", tableNames[table]);
+        return;
+    }
+    unsigned long readsBefore = tree->pageReads;
+
+    AnyRecord record;
+    if (indexLookupRecord(table, key, &record)) {
+        printf("\n");
+        for (int f = 0; f < schema->fieldCount; f++) {
+            char number[16];
+            printf("%-12s %s\n", schema->fields[f].header,
+                   formatRecordCell(&schema->fields[f], &record, number, sizeof(number)));
+        }
+    } else {
+        printf("\n%s '%s' not found.\n", schema->fields[0].header, key);
+    }
+    printIndexStats(tree, readsBefore);
+}
+
+typedef struct RangePrintContext {
+    const RecordSchema *schema;
+    TableView view;
+    int shown;
+} RangePrintContext;
+
+static int printRangeRow(const char *key, int64_t offset, void *ctx) {
+    RangePrintContext *range = (RangePrintContext *)ctx;
+    const RecordSchema *schema = range->schema;
+    char line[MAX_LINE_LENGTH];
+    AnyRecord record;
+    if (!readRecordLineAt(schema->table, offset, key, line, MAX_LINE_LENGTH)) return 1;
+    if (schema->parseLine(line, &record)) {
+        const char *cells[MAX_TABLE_COLUMNS];
+        char numbers[MAX_TABLE_COLUMNS][16];
+        for (int f = 0; f < schema->fieldCount; f++) {
+            cells[f] = formatRecordCell(&schema->fields[f], &record, numbers[f], sizeof(numbers[f]));
+        }
+        tvAddRowCells(&range->view, cells);
+    }
+    return ++range->shown < INDEX_RANGE_PAGE_LIMIT;
+}
+
+void indexRangeTool(TableID table) {
+    char low[MAX_ID_LENGTH], high[MAX_ID_LENGTH];
+    strncpy(low, getInput("Enter range start (inclusive): "), MAX_ID_LENGTH - 1);
+    low[MAX_ID_LENGTH - 1] = '\0';
+    strncpy(high, getInput("Enter range end (inclusive): "), MAX_ID_LENGTH - 1);
+    high[MAX_ID_LENGTH - 1] = '\0';
+
+    BPlusTree *tree = openRecordIndex(table);
+    if (tree == NULL) {
+        printf("\nError: The %s index is not available.\n", tableNames[table]);
         return;
     }
-    
-    printf("+-----------+--------------------------+-----------------------+--------------------------+\n");
-    printf("| Student ID| Name                     | Program               | Email                    |\n");
-    printf("+-----------+--------------------------+-----------------------+--------------------------+\n");
-    for (int i = 0; i < studentCount; i++) {
-        printf("| %-9s | %-24s | %-21s | %-24s |\n", 
-               students[i].id, 
-               students[i].name, 
-               students[i].program, 
-               students[i].email);
+    unsigned long readsBefore = tree->pageReads;
+    RangePrintContext range;
+    const char *headers[MAX_TABLE_COLUMNS];
+    range.schema = recordSchema(table);
+    range.shown = 0;
+    for (int f = 0; f < range.schema->fieldCount; f++) headers[f] = range.schema->fields[f].header;
+    tvInitColumns(&range.view, range.schema->fieldCount, headers);
+    for (int f = 0; f < range.schema->fieldCount; f++) {
+        if (range.schema->fields[f].type == FIELD_INT || range.schema->fields[f].type == FIELD_GPA) tvAlignRight(&range.view, f);
     }
-    printf("+-----------+--------------------------+-----------------------+--------------------------+\n");
+
+    printf("\n");
+    bptRangeScan(tree, low, high, printRangeRow, &range);
+    if (range.shown == 0) printf("No records in that range.\n");
+    else tvRender(&range.view, stdout);
+    if (range.shown >= INDEX_RANGE_PAGE_LIMIT) printf("(Showing the first %d matches.)\n", INDEX_RANGE_PAGE_LIMIT);
+    printIndexStats(tree, readsBefore);
 }
 
-void addStudentRecord() {
+// --- ADMIN MODULE: RECORD QUERIES ---
+
+void queryRecordsTool() {
     clearScreen();
     printf("======================================================\n");
-    printf("               Add New Student Record\n");
+    printf("                  Query Records\n");
     printf("======================================================\n");
-    
-    if (studentCount >= MAX_RECORDS) {
-        printf("Error: Database capacity reached (%d records).\n", MAX_RECORDS);
+    printf("Instruction: Enter '<table> where <filter>'. Tables and fields:\n");
+    for (int s = 0; s < QUERY_SOURCE_COUNT; s++) {
+        printf("  %-10s", querySources[s].name);
+        for (int f = 0; f < querySources[s].fieldCount; f++) printf(" %s", querySources[s].fields[f].name);
+        printf("\n");
+    }
+    printf("Operators: = != < <= > >= contains startswith endswith, joined with and/or/not.\n");
+    printf("Example:   students where program = \"BSc CS\" and email endswith @uni.edu\n\n");
+
+    QueryProgram program;
+    QueryResult result;
+    char *text = getInput("Query: ");
+    if (!compileQuery(text, &program)) {
+        printf("\nQuery error: %s\n", program.error);
         return;
     }
-    
-    char newID[MAX_ID_LENGTH];
-    char *inputID;
-    int index = studentCount;
-
-    // Check for unique ID
-    do {
-        inputID = getInput("Enter new Student ID: ");
-        int exists = 0;
-        for (int i = 0; i < studentCount; i++) {
-            if (strcmp(students[i].id, inputID) == 0) {
-                exists = 1;
-                break;
-            }
-        }
-        if (exists) {
-            printf("Error: Student ID already exists. Try again.\n");
-        } else {
-            strcpy(newID, inputID);
-            break;
-        }
-    } while(1);
 
-    strcpy(students[index].id, newID);
-    strcpy(students[index].name, getInput("Enter Student Name: "));
-    strcpy(students[index].program, getInput("Enter Student Program: "));
-    strcpy(students[index].email, getInput("Enter Student Email: "));
-    
-    studentCount++;
-    saveStudentRecords();
-    
-    // Also add a default entry to users.dat for login (password = student ID)
-    FILE *fp = fopen("db/users.dat", "a");
-    if (fp) {
-        fprintf(fp, "%s,%s,student\n", students[index].id, students[index].id);
-        fclose(fp);
-    }
+    double start = monotonicMillis();
+    runQuery(&program, &result);
+    double elapsed = monotonicMillis() - start;
 
-    printf("\nSuccess! Student record (ID: %s) added and user login created (Password = ID).\n", newID);
-}
+    printf("\n");
+    if (result.count > 0) printQueryTable(program.source, &result);
+    printf("\n%d matching %s (%s, %.2f ms).\n", result.count, program.source->name, result.plan, elapsed);
 
-void deleteStudentRecord() {
-    clearScreen();
-    printf("======================================================\n");
-    printf("              Delete Student Record\n");
-    printf("======================================================\n");
-    
-    char *idToDelete = getInput("Enter Student ID to delete: ");
-    int foundIndex = -1;
-    
-    for (int i = 0; i < studentCount; i++) {
-        if (strcmp(students[i].id, idToDelete) == 0) {
-            foundIndex = i;
-            break;
+    if (result.count > 0) {
+        char *path = getInput("\nSave as CSV (file name, blank to skip): ");
+        if (path[0] != '\0') {
+            FILE *out = fopen(path, "w");
+            if (out == NULL) {
+                printf("Error: Could not create %s.\n", path);
+            } else {
+                writeQueryCsv(program.source, &result, out);
+                fclose(out);
+                printf("Saved %d rows to %s.\n", result.count, path);
+            }
         }
     }
+    freeQueryResult(&result);
+}
 
-    if (foundIndex != -1) {
-        // Shift remaining elements to fill the gap
-        for (int i = foundIndex; i < studentCount - 1; i++) {
-            students[i] = students[i+1];
-        }
-        studentCount--;
-        saveStudentRecords();
-        printf("\nSuccess! Student record (ID: %s) deleted.\n", idToDelete);
-        
-        // NOTE: Deleting the entry from users.dat is complex file manipulation for a miniproject.
-        // For simplicity, we skip deleting the user login entry, meaning the user can no longer log in 
-        // as their ID is no longer valid in students.dat, but the login record remains.
-    } else {
-        printf("\nError: Student ID '%s' not found.\n", idToDelete);
+// Non-interactive form for scripts: prints the matching rows as CSV
+int runQueryToCsv(const char *text) {
+    QueryProgram program;
+    QueryResult result;
+    if (!compileQuery(text, &program)) {
+        printf("Query error: %s\n", program.error);
+        return 0;
     }
+    runQuery(&program, &result);
+    writeQueryCsv(program.source, &result, stdout);
+    freeQueryResult(&result);
+    return 1;
 }
 
-void updateStudentRecord() {
+// --- ADMIN MODULE: STATISTICS DASHBOARD ---
+
+void statisticsDashboard() {
     clearScreen();
+    loadAllRecords(); // Counters are kept from each table's first load on
     printf("======================================================\n");
-    printf("              Update Student Record\n");
+    printf("               Statistics Dashboard\n");
     printf("======================================================\n");
-    
-    char *idToUpdate = getInput("Enter Student ID to update: ");
-    int foundIndex = -1;
-    
-    for (int i = 0; i < studentCount; i++) {
-        if (strcmp(students[i].id, idToUpdate) == 0) {
-            foundIndex = i;
-            break;
+    printf("Instruction: Live counts, kept current as records are edited.\n\n");
+
+    for (int t = 0; t < TABLE_COUNT; t++) {
+        printf("%s%s: %d", t ? "   " : "", tableNames[t], tableTotal((TableID)t));
+    }
+    printf("\n");
+
+    for (int i = 0; i < STATS_BREAKDOWN_COUNT; i++) {
+        const StatsBreakdown *breakdown = &statsBreakdowns[i];
+        const Histogram *histogram = &tableStats[breakdown->table];
+        const HistogramBucket **buckets;
+        int count = sortedBuckets(breakdown, &buckets);
+
+        printf("\n%s\n", breakdown->title);
+        if (count == 0) {
+            printf("  (no records)\n");
+            free(buckets);
+            continue;
+        }
+        TableView table;
+        tvInit(&table, 3, breakdown->field.header, "Records", "Share");
+        tvAlignRight(&table, 1);
+        tvAlignRight(&table, 2);
+        long weighted = 0;
+        for (int b = 0; b < count; b++) {
+            char records[16], share[16];
+            snprintf(records, sizeof(records), "%d", buckets[b]->count);
+            snprintf(share, sizeof(share), "%.1f%%", 100.0 * buckets[b]->count / histogram->total);
+            tvAddRow(&table, buckets[b]->value, records, share);
+            weighted += (long)atoi(buckets[b]->value) * buckets[b]->count;
         }
+        tvRender(&table, stdout);
+        if (breakdown->field.type == FIELD_INT) {
+            printf("Total %s: %ld (mean %.2f)\n", breakdown->field.name, weighted, (double)weighted / histogram->total);
+        }
+        free(buckets);
     }
 
-    if (foundIndex != -1) {
-        printf("\nUpdating Record for Student ID: %s (Name: %s)\n", students[foundIndex].id, students[foundIndex].name);
-        printf("--- Enter new values (or press Enter to keep current value) ---\n");
-        
-        // FIX: Create a formatted prompt string before calling getInput
-        char promptBuffer[MAX_LINE_LENGTH];
-
-        snprintf(promptBuffer, MAX_LINE_LENGTH, "Enter New Name (Current: %s): ", students[foundIndex].name);
-        char *input = getInput(promptBuffer);
-        if (input[0] != '\0') strcpy(students[foundIndex].name, input);
-
-        snprintf(promptBuffer, MAX_LINE_LENGTH, "Enter New Program (Current: %s): ", students[foundIndex].program);
-        input = getInput(promptBuffer);
-        if (input[0] != '\0') strcpy(students[foundIndex].program, input);
-
-        snprintf(promptBuffer, MAX_LINE_LENGTH, "Enter New Email (Current: %s): ", students[foundIndex].email);
-        input = getInput(promptBuffer);
-        if (input[0] != '\0') strcpy(students[foundIndex].email, input);
-        
-        saveStudentRecords();
-        printf("\nSuccess! Student record (ID: %s) updated.\n", idToUpdate);
-    } else {
-        printf("\nError: Student ID '%s' not found.\n", idToUpdate);
+    char *path = getInput("\nExport as JSON (file name, blank to skip): ");
+    if (path[0] != '\0') {
+        FILE *out = fopen(path, "w");
+        if (out == NULL) {
+            printf("Error: Could not create %s.\n", path);
+        } else {
+            writeStatsJson(out);
+            fclose(out);
+            printf("Saved the dashboard to %s.\n", path);
+        }
     }
 }
 
-// --- ADMIN MODULE CRUD UTILITIES (COURSE, FACULTY) ---
+// --- ADMIN MODULE: DEGREE AUDIT ---
 
-// COURSE CRUD Menu
-void courseCRUDMenu() {
-    // CRUD menu structure similar to studentCRUDMenu... (1: View, 2: Add, 3: Update, 4: Delete)
+void degreeAuditMenu() {
     int choice;
     do {
         clearScreen();
         printf("======================================================\n");
-        printf("            MANAGE COURSE INFO (CRUD)\n");
+        printf("                    DEGREE AUDIT\n");
         printf("======================================================\n");
-        printf("[1] View All Courses\n");
-        printf("[2] Add New Course\n");
-        printf("[3] Update Existing Course\n");
-        printf("[4] Delete Course\n");
-        printf("[5] Return to Admin Menu\n");
+        printf("Instruction: Define program requirements and check students against them.\n\n");
+
+        printf("[1] Manage Program Requirements\n");
+        printf("[2] Audit One Student\n");
+        printf("[3] Audit All Students\n");
+        printf("[4] Return to Admin Menu\n");
         printf("------------------------------------------------------\n");
-        
-        choice = getMenuChoice(5);
+
+        choice = getMenuChoice(4);
 
         switch (choice) {
-            case 1: viewCourseCatalog(); break; // Reuse view function
-            case 2: addCourseRecord(); break;
-            case 3: updateCourseRecord(); break;
-            case 4: deleteCourseRecord(); break;
-            case 5: printf("Returning to Admin Menu...\n"); break;
+            case 1: recordCRUDMenu(TABLE_PROGRAMS); break;
+            case 2: auditOneStudentTool(); break;
+            case 3: auditAllStudentsTool(); break;
+            case 4: printf("Returning to Admin Menu...\n"); break;
         }
-        if (choice != 5) pressEnterToContinue();
+        if (choice != 4) pressEnterToContinue();
 
-    } while (choice != 5);
+    } while (choice != 4);
+}
+
+void auditOneStudentTool() {
+    ensureTableLoaded(TABLE_STUDENTS);
+    ensureTableLoaded(TABLE_COURSES);
+    ensureTableLoaded(TABLE_PROGRAMS);
+    char *key = getInput("Enter Student ID to audit: ");
+    int row = findRowByKey(students, sizeof(Student), studentCount, key);
+    if (row < 0) {
+        printf("\nError: Student ID '%s' not found.\n", key);
+        return;
+    }
+    printf("\n");
+    printAuditReport(&students[row]);
 }
 
-void addCourseRecord() {
+// Audits every student on all processors, then lists those who need attention
+void auditAllStudentsTool() {
     clearScreen();
+    ensureTableLoaded(TABLE_STUDENTS);
+    ensureTableLoaded(TABLE_COURSES);
+    ensureTableLoaded(TABLE_PROGRAMS);
     printf("======================================================\n");
-    printf("               Add New Course Record\n");
+    printf("                Audit All Students\n");
     printf("======================================================\n");
-    
-    if (courseCount >= MAX_RECORDS) {
-        printf("Error: Database capacity reached (%d records).\n", MAX_RECORDS);
+
+    if (studentCount == 0) {
+        printf("No Student records found.\n");
         return;
     }
-    
-    char newCode[MAX_ID_LENGTH];
-    char *inputCode;
-    int index = courseCount;
-
-    // Check for unique Code
-    do {
-        inputCode = getInput("Enter Course Code (e.g., CS101): ");
-        int exists = 0;
-        for (int i = 0; i < courseCount; i++) {
-            if (strcmp(courses[i].code, inputCode) == 0) {
-                exists = 1;
-                break;
-            }
-        }
-        if (exists) {
-            printf("Error: Course Code already exists. Try again.\n");
-        } else {
-            strcpy(newCode, inputCode);
-            break;
-        }
-    } while(1);
-
-    strcpy(courses[index].code, newCode);
-    strcpy(courses[index].name, getInput("Enter Course Name: "));
-    
-    int credits;
-    printf("Enter Course Credits (e.g., 3): ");
-    if (scanf("%d", &credits) != 1 || credits <= 0) {
-        printf("Invalid credit input. Record creation failed.\n");
-        while (getchar() != '\n');
+    AuditResult *results = (AuditResult *)malloc(sizeof(AuditResult) * (size_t)studentCount);
+    if (results == NULL) {
+        printf("Error: Not enough memory to audit %d students.\n", studentCount);
         return;
     }
-    while (getchar() != '\n'); // Clear buffer
-    courses[index].credits = credits;
-    
-    courseCount++;
-    saveCourseRecords();
-    
-    printf("\nSuccess! Course record (Code: %s) added.\n", newCode);
+    double start = monotonicMillis();
+    int threads = auditStudents(students, studentCount, results);
+    double elapsed = monotonicMillis() - start;
+
+    int tally[AUDIT_STATUS_COUNT] = {0};
+    for (int i = 0; i < studentCount; i++) tally[results[i].status]++;
+    printf("Audited %d students on %d thread(s) in %.2f ms.\n", studentCount, threads, elapsed);
+    for (int s = 0; s < AUDIT_STATUS_COUNT; s++) printf("%s%s: %d", s ? "   " : "", auditStatusNames[s], tally[s]);
+    printf("\n\n");
+
+    if (tally[AUDIT_AT_RISK] + tally[AUDIT_NO_PROGRAM] == 0) {
+        printf("Every student is on track.\n");
+        free(results);
+        return;
+    }
+    TableView table;
+    tvInit(&table, 6, "Student ID", "Name", "Program", "Status", "Credits", "Expected");
+    tvAlignRight(&table, 4);
+    tvAlignRight(&table, 5);
+    for (int i = 0; i < studentCount; i++) {
+        if (results[i].status != AUDIT_AT_RISK && results[i].status != AUDIT_NO_PROGRAM) continue;
+        char credits[16], expected[16];
+        snprintf(credits, sizeof(credits), "%d", results[i].credits);
+        snprintf(expected, sizeof(expected), "%d", results[i].expectedCredits);
+        tvAddRow(&table, students[i].id, students[i].name, students[i].program,
+                 auditStatusNames[results[i].status], credits, expected);
+    }
+    tvRender(&table, stdout);
+    free(results);
 }
 
-void deleteCourseRecord() {
+// --- ADMIN MODULE: CLASS RANKINGS ---
+
+void classRankingsTool() {
     clearScreen();
+    ensureTableLoaded(TABLE_STUDENTS);
     printf("======================================================\n");
-    printf("              Delete Course Record\n");
+    printf("             Class Rankings (Honours Lists)\n");
     printf("======================================================\n");
-    
-    char *codeToDelete = getInput("Enter Course Code to delete: ");
-    int foundIndex = -1;
-    
-    for (int i = 0; i < courseCount; i++) {
-        if (strcmp(courses[i].code, codeToDelete) == 0) {
-            foundIndex = i;
-            break;
+    printf("Instruction: Top %d students of each program by GPA. Students with no\n", HONOURS_LIST_SIZE);
+    printf("GPA recorded are not ranked.\n\n");
+
+    const char *names[MAX_RANKED_PROGRAMS];
+    int programCountRanked = rankedPrograms(names, MAX_RANKED_PROGRAMS);
+    if (programCountRanked == 0) {
+        printf("No student has a GPA recorded yet.\n");
+        return;
+    }
+    for (int p = 0; p < programCountRanked; p++) {
+        HonoursEntry top[HONOURS_LIST_SIZE];
+        int count = honoursList(names[p], top, HONOURS_LIST_SIZE);
+        TableView table;
+        tvInit(&table, 4, "Rank", "Student ID", "Name", "GPA");
+        tvAlignRight(&table, 0);
+        tvAlignRight(&table, 3);
+        int cohort = 0;
+        for (int k = 0; k < count; k++) {
+            int index = findRowByKey(students, sizeof(Student), studentCount, top[k].id);
+            if (index < 0) continue;
+            ClassRank standing;
+            char rank[16], gpa[16];
+            if (!classRankOf(&students[index], &standing)) continue;
+            cohort = standing.cohort;
+            snprintf(rank, sizeof(rank), "%d", standing.rank);
+            formatGpa(top[k].gpa, gpa, sizeof(gpa));
+            tvAddRow(&table, rank, students[index].id, students[index].name, gpa);
         }
+        printf("%s (%d ranked)\n", names[p], cohort);
+        tvRender(&table, stdout);
+        printf("\n");
     }
 
-    if (foundIndex != -1) {
-        for (int i = foundIndex; i < courseCount - 1; i++) {
-            courses[i] = courses[i+1];
-        }
-        courseCount--;
-        saveCourseRecords();
-        printf("\nSuccess! Course record (Code: %s) deleted.\n", codeToDelete);
-    } else {
-        printf("\nError: Course Code '%s' not found.\n", codeToDelete);
+    char *path = getInput("Save full class ranks as CSV (file name, blank to skip): ");
+    if (path[0] == '\0') return;
+    ClassRank *ranks = (ClassRank *)malloc(sizeof(ClassRank) * (size_t)(studentCount + 1));
+    FILE *out = ranks ? fopen(path, "w") : NULL;
+    if (out == NULL) {
+        printf("Error: Could not create %s.\n", path);
+        free(ranks);
+        return;
     }
+    double start = monotonicMillis();
+    int threads = rankStudents(students, studentCount, ranks);
+    double elapsed = monotonicMillis() - start;
+    writeRankCsv(out, students, ranks, studentCount);
+    fclose(out);
+    free(ranks);
+    printf("Ranked %d students on %d thread(s) in %.2f ms; saved to %s.\n", studentCount, threads, elapsed, path);
+}
+
+// --- ADMIN MODULE: CHANGE LOG ---
+
+#define CHANGE_LOG_SHOWN 100
+
+// Seconds since the epoch at local midnight starting a YYYYMMDD date
+static int64_t dateToSeconds(int date) {
+    struct tm t = {0};
+    t.tm_year = date / 10000 - 1900;
+    t.tm_mon = (date / 100) % 100 - 1;
+    t.tm_mday = date % 100;
+    t.tm_isdst = -1;
+    return (int64_t)mktime(&t);
+}
+
+// Reads an optional date bound; returns 0 if the answer is not a date
+static int readDateBound(const char *prompt, int endOfDay, int64_t *bound) {
+    char *input = getInput(prompt);
+    *bound = 0;
+    if (input[0] == '\0') return 1;
+    int date = parseDate(input);
+    if (date == 0) return 0;
+    *bound = endOfDay ? dateToSeconds(addDaysToDate(date, 1)) - 1 : dateToSeconds(date);
+    return 1;
 }
 
-void updateCourseRecord() {
+void changeLogTool() {
     clearScreen();
     printf("======================================================\n");
-    printf("              Update Course Record\n");
+    printf("                    Change Log\n");
     printf("======================================================\n");
-    
-    char *codeToUpdate = getInput("Enter Course Code to update: ");
-    int foundIndex = -1;
-    
-    for (int i = 0; i < courseCount; i++) {
-        if (strcmp(courses[i].code, codeToUpdate) == 0) {
-            foundIndex = i;
-            break;
-        }
+    printf("Instruction: Who added, updated, deleted or archived what, and when.\n");
+    printf("Leave any filter blank to match everything.\n\n");
+
+    ChangeFilter filter;
+    memset(&filter, 0, sizeof(filter));
+    filter.table = -1;
+    copyChangeField(filter.actor, getInput("Changed by (user ID): "));
+
+    char *input = getInput("Table (Student/Course/Faculty/Location/Notice/Program): ");
+    for (int t = 0; input[0] && t < TABLE_COUNT; t++) {
+        const char *a = input, *b = tableNames[t];
+        while (*a && tolower((unsigned char)*a) == tolower((unsigned char)*b)) { a++; b++; }
+        if (*a == '\0' && *b == '\0') filter.table = t;
+    }
+    if (input[0] && filter.table < 0) {
+        printf("Error: '%s' is not a table.\n", input);
+        return;
+    }
+    copyChangeField(filter.key, getInput("Record key, Task Key or notice number: "));
+    if (!readDateBound("From date YYYY-MM-DD: ", 0, &filter.from) ||
+        !readDateBound("To date YYYY-MM-DD: ", 1, &filter.to)) {
+        printf("Error: Dates must be YYYY-MM-DD.\n");
+        return;
     }
 
-    if (foundIndex != -1) {
-        printf("\nUpdating Record for Course Code: %s (Name: %s)\n", courses[foundIndex].code, courses[foundIndex].name);
-        printf("--- Enter new values (or press Enter to keep current value) ---\n");
-        
-        // FIX: Create a formatted prompt string before calling getInput
-        char promptBuffer[MAX_LINE_LENGTH];
-        
-        snprintf(promptBuffer, MAX_LINE_LENGTH, "Enter New Name (Current: %s): ", courses[foundIndex].name);
-        char *input = getInput(promptBuffer);
-        if (input[0] != '\0') strcpy(courses[foundIndex].name, input);
-
-        int newCredits;
-        printf("Enter New Credits (Current: %d, Enter -1 to skip): ", courses[foundIndex].credits);
-        if (scanf("%d", &newCredits) == 1) {
-            if (newCredits != -1 && newCredits > 0) {
-                courses[foundIndex].credits = newCredits;
-            }
-        }
-        while (getchar() != '\n'); // Clear buffer
-        
-        saveCourseRecords();
-        printf("\nSuccess! Course record (Code: %s) updated.\n", codeToUpdate);
-    } else {
-        printf("\nError: Course Code '%s' not found.\n", codeToUpdate);
+    int count = 0, skipped = 0;
+    double started = monotonicMillis();
+    ChangeRecord *changes = queryChanges(&filter, &count, &skipped);
+    double elapsed = monotonicMillis() - started;
+    if (count == 0) {
+        printf("\nNo changes match.\n");
+        free(changes);
+        return;
+    }
+
+    TableView table;
+    tvInit(&table, 5, "When", "Changed By", "Action", "Table", "Key");
+    int first = count > CHANGE_LOG_SHOWN ? count - CHANGE_LOG_SHOWN : 0;
+    for (int i = first; i < count; i++) {
+        char when[32];
+        time_t at = (time_t)changes[i].at;
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&at));
+        tvAddRow(&table, when, changes[i].actor, changeActionName(changes[i].action),
+                 changes[i].table < TABLE_COUNT ? tableNames[changes[i].table] : "?", changes[i].key);
     }
+    printf("\n");
+    tvRender(&table, stdout);
+    if (first > 0) printf("\nShowing the latest %d of %d changes.\n", CHANGE_LOG_SHOWN, count);
+    else printf("\n%d change(s).\n", count);
+    printf("Searched in %.1f ms (%d sealed segment(s) skipped by their headers).\n", elapsed, skipped);
+    free(changes);
 }
 
-// FACULTY CRUD Menu
-void facultyCRUDMenu() {
-    // CRUD menu structure similar to studentCRUDMenu... (1: View, 2: Add, 3: Update, 4: Delete)
+// --- ADMIN MODULE: SEMESTER ARCHIVE ---
+
+void archiveMenu() {
     int choice;
     do {
         clearScreen();
         printf("======================================================\n");
-        printf("          MANAGE FACULTY INFO (CRUD)\n");
+        printf("                 SEMESTER ARCHIVE\n");
         printf("======================================================\n");
-        printf("[1] View All Faculty\n");
-        printf("[2] Add New Faculty\n");
-        printf("[3] Update Existing Faculty\n");
-        printf("[4] Delete Faculty\n");
+        printf("Instruction: Move past semesters out of the live tables into\n");
+        printf("compressed read-only segments that can still be searched by ID.\n\n");
+
+        printf("[1] Archive Records Older Than a Semester\n");
+        printf("[2] Look Up Archived Student\n");
+        printf("[3] Look Up Archived Course\n");
+        printf("[4] List Archive Segments\n");
         printf("[5] Return to Admin Menu\n");
         printf("------------------------------------------------------\n");
-        
+
         choice = getMenuChoice(5);
 
         switch (choice) {
-            case 1: displayFacultyRecords(); break; // Reuse display function
-            case 2: addFacultyRecord(); break;
-            case 3: updateFacultyRecord(); break;
-            case 4: deleteFacultyRecord(); break;
+            case 1: archiveRecordsTool(); break;
+            case 2: archiveLookupTool(TABLE_STUDENTS); break;
+            case 3: archiveLookupTool(TABLE_COURSES); break;
+            case 4: listArchiveSegments(); break;
             case 5: printf("Returning to Admin Menu...\n"); break;
         }
         if (choice != 5) pressEnterToContinue();
@@ -1346,190 +10595,268 @@ void facultyCRUDMenu() {
     } while (choice != 5);
 }
 
-void displayFacultyRecords() {
-    // This is the same as viewFacultyDirectory, used for consistency in CRUD menu
-    clearScreen();
-    printf("======================================================\n");
-    printf("                All Faculty Records\n");
-    printf("======================================================\n");
-    
-    if (facultyCount == 0) {
-        printf("No faculty records found.\n");
+void archiveRecordsTool() {
+    char cutoff[MAX_ID_LENGTH] = "";
+    readSemesterInput("Archive records from semesters before (YYYY-T): ", cutoff);
+    if (cutoff[0] == '\0') {
+        printf("No semester entered. Nothing was archived.\n");
         return;
     }
 
-    printf("+-----------+--------------------------+-----------------------+\n");
-    printf("| Faculty ID| Name                     | Department            |\n");
-    printf("+-----------+--------------------------+-----------------------+\n");
-    for (int i = 0; i < facultyCount; i++) {
-        printf("| %-9s | %-24s | %-21s |\n", 
-               faculty[i].id, 
-               faculty[i].name, 
-               faculty[i].department);
+    int archivedStudents = 0, archivedCourses = 0;
+    if (archiveBeforeSemester(cutoff, &archivedStudents, &archivedCourses)) {
+        printf("\nSuccess! Archived %d student and %d course records from before %s.\n",
+               archivedStudents, archivedCourses, cutoff);
     }
-    printf("+-----------+--------------------------+-----------------------+\n");
 }
 
-void addFacultyRecord() {
-    clearScreen();
-    printf("======================================================\n");
-    printf("              Add New Faculty Record\n");
-    printf("======================================================\n");
-    
-    if (facultyCount >= MAX_RECORDS) {
-        printf("Error: Database capacity reached (%d records).\n", MAX_RECORDS);
-        return;
-    }
-    
-    char newID[MAX_ID_LENGTH];
-    char *inputID;
-    int index = facultyCount;
-
-    // Check for unique ID
-    do {
-        inputID = getInput("Enter new Faculty ID (e.g., F009): ");
-        int exists = 0;
-        for (int i = 0; i < facultyCount; i++) {
-            if (strcmp(faculty[i].id, inputID) == 0) {
-                exists = 1;
-                break;
-            }
+void archiveLookupTool(TableID table) {
+    char *key = getInput(table == TABLE_STUDENTS ? "Enter archived Student ID: " : "Enter archived Course Code: ");
+    if (table == TABLE_STUDENTS) {
+        Student s;
+        if (archiveLookup(TABLE_STUDENTS, key, &s)) {
+            printf("\nStudent ID: %s\nName:       %s\nProgram:    %s\nEmail:      %s\nSemester:   %s\n",
+                   s.id, s.name, s.program, s.email, s.semester);
+            if (s.completed[0]) printf("Completed:  %s\n", s.completed);
+        } else {
+            printf("\nStudent ID '%s' is not in the archive.\n", key);
         }
-        if (exists) {
-            printf("Error: Faculty ID already exists. Try again.\n");
+    } else {
+        Course c;
+        if (archiveLookup(TABLE_COURSES, key, &c)) {
+            printf("\nCourse Code: %s\nName:        %s\nCredits:     %d\nSemester:    %s\n",
+                   c.code, c.name, c.credits, c.semester);
+            if (c.prerequisites[0]) printf("Requires:    %s\n", c.prerequisites);
+            if (c.corequisites[0]) printf("Taken with:  %s\n", c.corequisites);
         } else {
-            strcpy(newID, inputID);
-            break;
+            printf("\nCourse Code '%s' is not in the archive.\n", key);
         }
-    } while(1);
-
-    strcpy(faculty[index].id, newID);
-    strcpy(faculty[index].name, getInput("Enter Faculty Name: "));
-    strcpy(faculty[index].department, getInput("Enter Faculty Department: "));
-    
-    facultyCount++;
-    saveFacultyRecords();
-    
-    printf("\nSuccess! Faculty record (ID: %s) added.\n", newID);
+    }
 }
 
-void deleteFacultyRecord() {
-    clearScreen();
-    printf("======================================================\n");
-    printf("              Delete Faculty Record\n");
-    printf("======================================================\n");
-    
-    char *idToDelete = getInput("Enter Faculty ID to delete: ");
-    int foundIndex = -1;
-    
-    for (int i = 0; i < facultyCount; i++) {
-        if (strcmp(faculty[i].id, idToDelete) == 0) {
-            foundIndex = i;
-            break;
+void listArchiveSegments() {
+    TableID tables[2] = { TABLE_STUDENTS, TABLE_COURSES };
+    int total = 0;
+    TableView view;
+    tvInit(&view, 7, "Table", "No.", "Before", "Records", "Raw bytes", "Stored", "Ratio");
+    for (int c = 1; c < 7; c++) if (c != 2) tvAlignRight(&view, c);
+    for (int t = 0; t < 2; t++) {
+        for (int number = 1; number <= MAX_ARCHIVE_SEGMENTS; number++) {
+            ArchiveSegment *seg = openArchiveSegment(tables[t], number);
+            if (seg == NULL) break;
+            uint32_t stored = seg->header.restartOffset + seg->header.restartCount * (uint32_t)sizeof(uint32_t);
+            char no[16], records[16], raw[16], storedText[16], ratio[16];
+            snprintf(no, sizeof(no), "%d", number);
+            snprintf(records, sizeof(records), "%u", seg->header.recordCount);
+            snprintf(raw, sizeof(raw), "%u", seg->header.rawBytes);
+            snprintf(storedText, sizeof(storedText), "%u", stored);
+            snprintf(ratio, sizeof(ratio), "%.1fx", stored ? (double)seg->header.rawBytes / stored : 0.0);
+            tvAddRow(&view, tableNames[tables[t]], no, seg->header.cutoff, records, raw, storedText, ratio);
+            closeArchiveSegment(seg);
+            total++;
         }
     }
+    tvRender(&view, stdout);
+    printf("\nTotal segments: %d\n", total);
+}
 
-    if (foundIndex != -1) {
-        for (int i = foundIndex; i < facultyCount - 1; i++) {
-            faculty[i] = faculty[i+1];
+// --- APPLICATION LOOP ---
+
+// The loginMenu is responsible for checking credentials and setting the role.
+// The loop continues until the user logs in or input runs out.
+void runApplication() {
+    while (1) {
+        loginMenu();
+        if (currentUserRole != ROLE_UNKNOWN) {
+            // If login successful, enter the main menu
+            mainMenu();
         }
-        facultyCount--;
-        saveFacultyRecords();
-        printf("\nSuccess! Faculty record (ID: %s) deleted.\n", idToDelete);
-    } else {
-        printf("\nError: Faculty ID '%s' not found.\n", idToDelete);
     }
 }
 
-void updateFacultyRecord() {
-    clearScreen();
-    printf("======================================================\n");
-    printf("              Update Faculty Record\n");
-    printf("======================================================\n");
-    
-    char *idToUpdate = getInput("Enter Faculty ID to update: ");
-    int foundIndex = -1;
-    
-    for (int i = 0; i < facultyCount; i++) {
-        if (strcmp(faculty[i].id, idToUpdate) == 0) {
-            foundIndex = i;
-            break;
+// --- MAIN FUNCTION ---
+
+int main(int argc, char *argv[]) {
+    initRenderer();
+    initPersistence();
+    initSnapshots();
+    useDataDirectory(DB_DIRECTORY);
+    // Options for every mode come first
+    int allCampuses = 0;
+    const char *shipTo = NULL;
+    while (argc > 2 && (strcmp(argv[1], "--durability") == 0 || strcmp(argv[1], "--campus") == 0 ||
+                        strcmp(argv[1], "--ship") == 0)) {
+        if (strcmp(argv[1], "--ship") == 0) {
+            shipTo = argv[2];
+        } else if (strcmp(argv[1], "--durability") == 0) {
+            if (!setDurabilityPolicy(argv[2])) {
+                printf("Usage: %s --durability none|barrier|always [mode...]\n", argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[2], "all") == 0) {
+            allCampuses = 1;
+        } else if (!selectCampus(argv[2])) {
+            return 1;
         }
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
     }
-
-    if (foundIndex != -1) {
-        printf("\nUpdating Record for Faculty ID: %s (Name: %s)\n", faculty[foundIndex].id, faculty[foundIndex].name);
-        printf("--- Enter new values (or press Enter to keep current value) ---\n");
-        
-        // FIX: Create a formatted prompt string before calling getInput
-        char promptBuffer[MAX_LINE_LENGTH];
-
-        snprintf(promptBuffer, MAX_LINE_LENGTH, "Enter New Name (Current: %s): ", faculty[foundIndex].name);
-        char *input = getInput(promptBuffer);
-        if (input[0] != '\0') strcpy(faculty[foundIndex].name, input);
-
-        snprintf(promptBuffer, MAX_LINE_LENGTH, "Enter New Department (Current: %s): ", faculty[foundIndex].department);
-        input = getInput(promptBuffer);
-        if (input[0] != '\0') strcpy(faculty[foundIndex].department, input);
-        
-        saveFacultyRecords();
-        printf("\nSuccess! Faculty record (ID: %s) updated.\n", idToUpdate);
-    } else {
-        printf("\nError: Faculty ID '%s' not found.\n", idToUpdate);
+    if (allCampuses) {
+        if (argc > 2 && strcmp(argv[1], "--query") == 0) return runCampusQuery(argv[2]) ? 0 : 1;
+        printf("Usage: %s --campus all --query \"<table> where <filter>\"\n", argv[0]);
+        return 1;
     }
-}
-
-void editNotices() {
-    clearScreen();
-    printf("======================================================\n");
-    printf("           Edit Academic Calendar & Notices\n");
-    printf("======================================================\n");
-    printf("Instruction: You can directly edit the 'notices.txt' file.\n");
-    printf("Note: For this console application, we will overwrite the file content.\n\n");
-
-    FILE *fp = fopen("db/notices.txt", "w");
-    if (fp == NULL) {
-        printf("Error: Could not open notices.txt for writing.\n");
-        return;
+    if (argc > 2 && strcmp(argv[1], "--add-campus") == 0) {
+        return addCampus(argv[2]) ? 0 : 1;
     }
-
-    printf("Enter the new content line by line. Type 'END' on a new line to finish.\n");
-    char line[MAX_LINE_LENGTH];
-
-    // Consume any leftover newline characters from previous input
-    int c;
-    while ((c = getchar()) != '\n' && c != EOF);
-
-    while (1) {
-        printf("-> ");
-        if (fgets(line, MAX_LINE_LENGTH, stdin) == NULL) break; // Use stdin here
-        
-        normalizeString(line);
-        if (strcmp(line, "END") == 0) break;
-        
-        fprintf(fp, "%s\n", line); // Write line back with a newline
+    // Replication: the primary ships from whichever data directory was chosen above
+    if (shipTo && !startShipping(shipTo)) return 1;
+    if (argc > 2 && strcmp(argv[1], "--replica") == 0) {
+        int seconds = (argc > 3) ? atoi(argv[3]) : -1;
+        return runReplica(argv[2], seconds) ? 0 : 1;
+    }
+    // Offline maintenance: build the page indexes without starting the menus
+    if (argc > 1 && strcmp(argv[1], "--build-index") == 0) {
+        int failed = 0;
+        for (int t = 0; t < RECORD_TABLE_COUNT; t++) {
+            TableID table = recordSchemas[t].table;
+            if (!recordIndexable(table)) continue; // Queried by scan
+            int keys = buildRecordIndex(table);
+            if (keys < 0) {
+                printf("Error: Could not build the index for %s.\n", tableFiles[table]);
+                failed = 1;
+                continue;
+            }
+            printf("Indexed %d %s.\n", keys, recordSchemas[t].rowsName);
+            bptClose(recordIndexes[table]);
+        }
+        return failed;
+    }
+    if (argc > 2 && strcmp(argv[1], "--archive") == 0) {
+        if (!isValidSemester(argv[2])) {
+            printf("Usage: %s --archive YYYY-T\n", argv[0]);
+            return 1;
+        }
+        initLazyLoading();
+        int archivedStudents = 0, archivedCourses = 0;
+        int archived = archiveBeforeSemester(argv[2], &archivedStudents, &archivedCourses);
+        flushPersistence();
+        if (!archived) return 1;
+        printf("Archived %d students and %d courses from before %s.\n", archivedStudents, archivedCourses, argv[2]);
+        return 0;
     }
 
-    fclose(fp);
-    printf("\nSuccess! Notices have been updated.\n");
-}
-
-// --- MAIN FUNCTION ---
-
-int main() {
-    // 1. Load data from files into memory structures
-    loadAllRecords();
+    if (argc > 1 && strcmp(argv[1], "--bench-query") == 0) {
+        int rows = (argc > 2) ? atoi(argv[2]) : 1000000;
+        const char *query = (argc > 3) ? argv[3] : "students where program = \"BSc CS\" and email endswith @uni.edu";
+        return (rows > 0 && benchmarkQuery(query, rows)) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-filter") == 0) {
+        int keys = (argc > 2) ? atoi(argv[2]) : 100000;
+        return (keys > 0 && benchmarkKeyFilter(keys)) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-changelog") == 0) {
+        int events = (argc > 2) ? atoi(argv[2]) : 1000000;
+        return (events > 0 && benchmarkChangeLog(events)) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-occupancy") == 0) {
+        int samples = (argc > 2) ? atoi(argv[2]) : 1000000;
+        return (samples > 0 && benchmarkOccupancy(samples)) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-nearest") == 0) {
+        int points = (argc > 2) ? atoi(argv[2]) : 50000;
+        return (points > 0 && benchmarkNearest(points)) ? 0 : 1;
+    }
+    if (argc > 2 && strcmp(argv[1], "--query") == 0) {
+        initLazyLoading();
+        return runQueryToCsv(argv[2]) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-rank") == 0) {
+        int rows = (argc > 2) ? atoi(argv[2]) : 1000000;
+        return (rows > 0 && benchmarkRanking(rows)) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-audit") == 0) {
+        int rows = (argc > 2) ? atoi(argv[2]) : 40000;
+        return (rows > 0 && benchmarkAudit(rows)) ? 0 : 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--stress-registration") == 0) {
+        int requests = (argc > 2) ? atoi(argv[2]) : 200000;
+        int threads = (argc > 3) ? atoi(argv[3]) : 16;
+        return (requests > 0 && threads > 0 && stressRegistration(requests, threads)) ? 0 : 1;
+    }
+    // Audits all of students.dat (not only the rows the menus hold); CSV to a file or stdout
+    if (argc > 1 && strcmp(argv[1], "--audit") == 0) {
+        initLazyLoading();
+        ensureTableLoaded(TABLE_COURSES);
+        ensureTableLoaded(TABLE_PROGRAMS);
+        int count = 0;
+        Student *rows = readStudentBody(&count);
+        AuditResult *results = rows ? (AuditResult *)malloc(sizeof(AuditResult) * (size_t)(count + 1)) : NULL;
+        FILE *out = (argc > 2) ? fopen(argv[2], "w") : stdout;
+        if (rows == NULL || results == NULL || out == NULL) {
+            printf("Error: Could not audit %s.\n", tableFiles[TABLE_STUDENTS]);
+            if (out && out != stdout) fclose(out);
+            free(rows);
+            free(results);
+            return 1;
+        }
+        auditStudents(rows, count, results);
+        writeAuditCsv(out, rows, results, count);
+        if (out != stdout) fclose(out);
+        free(rows);
+        free(results);
+        return 0;
+    }
+    // Ranks all of students.dat within each program; CSV to a file or stdout
+    if (argc > 1 && strcmp(argv[1], "--ranks") == 0) {
+        int count = 0;
+        Student *rows = readStudentBody(&count);
+        ClassRank *ranks = rows ? (ClassRank *)malloc(sizeof(ClassRank) * (size_t)(count + 1)) : NULL;
+        FILE *out = (argc > 2) ? fopen(argv[2], "w") : stdout;
+        if (rows == NULL || ranks == NULL || out == NULL || !rankStudents(rows, count, ranks)) {
+            printf("Error: Could not rank %s.\n", tableFiles[TABLE_STUDENTS]);
+            if (out && out != stdout) fclose(out);
+            free(rows);
+            free(ranks);
+            return 1;
+        }
+        writeRankCsv(out, rows, ranks, count);
+        if (out != stdout) fclose(out);
+        free(rows);
+        free(ranks);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--stats-json") == 0) {
+        initLazyLoading();
+        loadAllRecords();
+        writeStatsJson(stdout);
+        return 0;
+    }
 
-    // 2. Start the application loop with the Login Menu
-    // The loginMenu is responsible for checking credentials and setting the role
-    // The loop continues until the user successfully logs in or exits.
-    while (currentUserRole == ROLE_UNKNOWN) {
-        loginMenu();
-        if (currentUserRole != ROLE_UNKNOWN) {
-            // If login successful, enter the main menu
-            mainMenu();
+    // 1. Tables are loaded lazily on first use, so startup does no data I/O
+    initLazyLoading();
+    startFileWatcher(); // Picks up edits made by other instances while we run
+    startPersistenceThread(); // Admin saves are written behind the menus
+
+    // 2. Session tooling: capture keystrokes, or drive the menus from recordings
+    if (argc > 2 && strcmp(argv[1], "--record") == 0) {
+        if (!startRecording(argv[2])) return 1;
+    } else if (argc > 1 && strcmp(argv[1], "--replay") == 0) {
+        int first = 2;
+        double speed = 1.0;
+        if (argc > 3 && strcmp(argv[2], "--speed") == 0) {
+            speed = atof(argv[3]);
+            first = 4;
+        }
+        if (first >= argc) {
+            printf("Usage: %s --replay [--speed N] session.rec...\n", argv[0]);
+            return 1;
         }
+        return replaySessions(argv + first, argc - first, speed) ? 0 : 1;
     }
-    
+
+    // 3. Start the application loop with the Login Menu
+    runApplication();
     return 0;
 }